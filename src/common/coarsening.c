@@ -0,0 +1,100 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Source file for the coarsening of multigrid levels, used by the sequential,
+ * shared memory and distributed memory versions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "coarsening.h"
+
+
+/*
+ * Returns the dimension of the level coarser than a level of dimension
+ * fine_dim.
+ */
+int coarse_dimension(int fine_dim) {
+	return fine_dim / 2 + 1;
+}
+
+
+/*
+ * Computes the coarse value at or before each value of a level of dimension
+ * fine_dim, the weight of the next coarse value in its interpolation, and the
+ * band of fine values restricted to each coarse value.
+ */
+struct coarsening* initialise_coarsening(int fine_dim) {
+	struct coarsening *c = malloc(sizeof(struct coarsening));
+	int fine_cells = fine_dim - 1;
+	int coarse_cells, i, coarse;
+
+	if (c == NULL) {
+		fprintf(stderr, "Failed to allocate space for the array.\n");
+		exit(EXIT_FAILURE);
+	}
+	c->fine_dim = fine_dim;
+	c->coarse_dim = coarse_dimension(fine_dim);
+	coarse_cells = c->coarse_dim - 1;
+	c->cell = malloc((size_t)fine_dim * sizeof(int));
+	c->weight = malloc((size_t)fine_dim * sizeof(double));
+	c->first = malloc((size_t)c->coarse_dim * sizeof(int));
+	c->last = malloc((size_t)c->coarse_dim * sizeof(int));
+	if (c->cell == NULL || c->weight == NULL || c->first == NULL || c->last == NULL) {
+		fprintf(stderr, "Failed to allocate space for the array.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// fine value i sits i * coarse_cells / fine_cells coarse cells from the boundary
+	for (i = 0; i < fine_dim; i++) {
+		c->cell[i] = i * coarse_cells / fine_cells;
+		c->weight[i] = (double)(i * coarse_cells % fine_cells) / fine_cells;
+	}
+
+	// fine values with a non zero weight towards each coarse value, a contiguous band
+	for (coarse = 0; coarse < c->coarse_dim; coarse++) {
+		c->first[coarse] = fine_dim;
+		c->last[coarse] = -1;
+	}
+	for (i = 0; i < fine_dim; i++) {
+		coarse = c->cell[i];
+		if (i < c->first[coarse]) {
+			c->first[coarse] = i;
+		}
+		c->last[coarse] = i;
+		if (c->weight[i] > 0 && coarse + 1 < c->coarse_dim) {
+			if (i < c->first[coarse + 1]) {
+				c->first[coarse + 1] = i;
+			}
+			c->last[coarse + 1] = i;
+		}
+	}
+	return c;
+}
+
+
+/*
+ * Returns the weight of fine value fine in the restriction to coarse value
+ * coarse, which is also the weight of coarse in the interpolation of fine.
+ */
+double restriction_weight(const struct coarsening* c, int fine, int coarse) {
+	if (c->cell[fine] == coarse) {
+		return 1.0 - c->weight[fine];
+	}
+	if (c->cell[fine] + 1 == coarse) {
+		return c->weight[fine];
+	}
+	return 0.0;
+}
+
+
+/*
+ * Frees the tables and the structure of the coarsening.
+ */
+void free_coarsening(struct coarsening* c) {
+	free(c->cell);
+	free(c->weight);
+	free(c->first);
+	free(c->last);
+	free(c);
+}
@@ -0,0 +1,29 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Header file for the coarsening of multigrid levels, used by the sequential,
+ * shared memory and distributed memory versions.
+ */
+
+
+struct coarsening {
+	// structure mapping the values of a level to the values of its coarser level, along one dimension
+	int fine_dim;		// dimension of the level
+	int coarse_dim;		// dimension of the coarser level
+	int *cell;			// coarse value at or before each fine value
+	double *weight;		// weight of the coarse value after it when interpolating (0 if they line up)
+	int *first;			// first fine value restricted to each coarse value
+	int *last;			// last fine value restricted to each coarse value
+};
+
+
+int coarse_dimension(int fine_dim);
+
+
+struct coarsening* initialise_coarsening(int fine_dim);
+
+
+double restriction_weight(const struct coarsening* c, int fine, int coarse);
+
+
+void free_coarsening(struct coarsening* c);
@@ -0,0 +1,146 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Source file for the grid holding the rows of a square array (or of the part
+ * of it held by a process), used by the sequential, shared memory and
+ * distributed memory versions.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "real.h"
+#include "grid.h"
+
+#define CACHE_LINE 64
+#define VALUES_PER_LINE ((int)(CACHE_LINE / sizeof(real)))
+
+
+/*
+ * Returns the number of values from the start of a row of num_cols values to
+ * the start of the next one: enough cache lines for the row, and an odd
+ * number of them so that neighbouring rows never map to the same cache sets.
+ */
+int grid_pitch(int num_cols) {
+	int lines = (num_cols + VALUES_PER_LINE - 1) / VALUES_PER_LINE;
+
+	if (lines % 2 == 0) {
+		lines++;
+	}
+	return lines * VALUES_PER_LINE;
+}
+
+
+/*
+ * Points each row of a buffer at its first value.
+ */
+static real** allocate_grid_rows(real* values, int num_rows, int pitch) {
+	real **rows = malloc((size_t)num_rows * sizeof(real*));
+	int i;
+
+	if (rows == NULL) {
+		fprintf(stderr, "Failed to allocate space for the array.\n");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < num_rows; i++) {
+		rows[i] = &values[(size_t)i * (size_t)pitch];
+	}
+	return rows;
+}
+
+
+/*
+ * Allocates a grid of num_rows rows of num_cols values, with halo_rows more
+ * rows above and below them (row 0 of the grid being the first halo row), and
+ * a second buffer if num_buffers is 2. The values are not initialised, so
+ * that they are placed in memory by the first thread writing them.
+ */
+struct grid* allocate_grid(int num_rows, int num_cols, int halo_rows,
+	int num_buffers) {
+	struct grid *g = malloc(sizeof(struct grid));
+	size_t buffer_size;
+	void *memory;
+
+	if (g == NULL) {
+		fprintf(stderr, "Failed to allocate space for the array.\n");
+		exit(EXIT_FAILURE);
+	}
+	g->num_rows = num_rows + 2 * halo_rows;
+	g->num_cols = num_cols;
+	g->pitch = grid_pitch(num_cols);
+	g->halo_rows = halo_rows;
+	g->num_buffers = num_buffers;
+
+	// one more cache line per buffer for the shift of the rows
+	buffer_size = (size_t)g->num_rows * (size_t)g->pitch + VALUES_PER_LINE;
+	if (posix_memalign(&memory, CACHE_LINE, (size_t)num_buffers * buffer_size * sizeof(real)) != 0) {
+		fprintf(stderr, "Failed to allocate space for the array.\n");
+		exit(EXIT_FAILURE);
+	}
+	g->memory = memory;
+
+	g->values = &g->memory[VALUES_PER_LINE - 1];
+	g->rows = allocate_grid_rows(g->values, g->num_rows, g->pitch);
+	g->next_values = NULL;
+	g->next_rows = NULL;
+	if (num_buffers == 2) {
+		g->next_values = &g->memory[buffer_size + VALUES_PER_LINE - 1];
+		g->next_rows = allocate_grid_rows(g->next_values, g->num_rows, g->pitch);
+	}
+	return g;
+}
+
+
+/*
+ * Sets the values of rows first_row to end_row (excluded) of every buffer to
+ * 0, padding included.
+ */
+void clear_grid_rows(struct grid* g, int first_row, int end_row) {
+	size_t length = (size_t)(end_row - first_row) * (size_t)g->pitch * sizeof(real);
+
+	if (end_row <= first_row) {
+		return;
+	}
+	memset(g->rows[first_row], 0, length);
+	if (g->next_rows != NULL) {
+		memset(g->next_rows[first_row], 0, length);
+	}
+}
+
+
+/*
+ * Copies every value of the buffer into the second buffer, so that both hold
+ * the boundary values, which are never relaxed.
+ */
+void copy_grid_buffer(struct grid* g) {
+	memcpy(g->next_values, g->values,
+		(size_t)g->num_rows * (size_t)g->pitch * sizeof(real));
+}
+
+
+/*
+ * Swaps the buffer and the second buffer, once the values relaxed into the
+ * second buffer become the current values.
+ */
+void swap_grid_buffers(struct grid* g) {
+	real *temp_values = g->values;
+	real **temp_rows = g->rows;
+
+	g->values = g->next_values;
+	g->next_values = temp_values;
+	g->rows = g->next_rows;
+	g->next_rows = temp_rows;
+}
+
+
+/*
+ * Frees the buffers, their rows and the structure of the grid.
+ */
+void free_grid(struct grid* g) {
+	free(g->rows);
+	free(g->next_rows);
+	free(g->memory);
+	free(g);
+}
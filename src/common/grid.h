@@ -0,0 +1,43 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Header file for the grid holding the rows of a square array (or of the part
+ * of it held by a process), used by the sequential, shared memory and
+ * distributed memory versions.
+ */
+
+
+struct grid {
+	// structure used to keep track of the rows of a grid and its buffers
+	int num_rows;			// number of rows, halo rows included
+	int num_cols;			// number of values of each row
+	int pitch;				// values from the start of a row to the next one
+	int halo_rows;			// rows of halo above and below the rows held
+	int num_buffers;		// 1, or 2 for a second buffer to relax into
+	real *values;			// first value of the first row of the buffer
+	real *next_values;		// same for the second buffer (NULL if none)
+	real **rows;			// first value of each row of the buffer
+	real **next_rows;		// same for the second buffer (NULL if none)
+	real *memory;			// aligned allocation holding every buffer
+};
+
+
+int grid_pitch(int num_cols);
+
+
+struct grid* allocate_grid(int num_rows,
+						   int num_cols,
+						   int halo_rows,
+						   int num_buffers);
+
+
+void clear_grid_rows(struct grid* g, int first_row, int end_row);
+
+
+void copy_grid_buffer(struct grid* g);
+
+
+void swap_grid_buffers(struct grid* g);
+
+
+void free_grid(struct grid* g);
@@ -0,0 +1,92 @@
+/**
+ * CM30225 Parallel Computing
+ * 
+ * Source file for the generator of the initial values of the square array, 
+ * used by the sequential and distributed memory versions so that any part of
+ * the array can be generated on its own.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "real.h"
+#include "initial_grid.h"
+
+#define SEED 1000
+
+
+/*
+ * Returns a random integer from 0 to 9 stored as a double, given by the hash
+ * of the row, the column and the seed.
+ */
+static double hashed_value(int row, int col, uint64_t seed) {
+	uint64_t x = ((uint64_t)(uint32_t)row << 32 | (uint32_t)col) + 
+		seed * 0x9e3779b97f4a7c15ULL;
+
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	x = x ^ (x >> 31);
+
+	return (double)(x % 10);
+}
+
+
+/*
+ * Returns the initial value at the given row and column of the square array,
+ * a random integer from 0 to 9 stored as a double.
+ */
+double initial_grid_value(int row, int col) {
+	return hashed_value(row, col, SEED);
+}
+
+
+/*
+ * Returns the initial value at the given plane, row and column of the cube, 
+ * a random integer from 0 to 9 stored as a double.
+ */
+double initial_volume_value(int plane, int row, int col) {
+	return hashed_value(row, col, SEED + 1 + (uint64_t)(uint32_t)plane);
+}
+
+
+/*
+ * Fills values, a num_rows x num_cols part of the square array stored row by
+ * row (rows being pitch values apart), with the initial values of the square
+ * array starting at row first_row and column first_col.
+ */
+void initialise_grid_values(real* values, int pitch, int first_row, 
+	int first_col, int num_rows, int num_cols) {
+	int i, j;
+
+	for (i = 0; i < num_rows; i++) {
+		for (j = 0; j < num_cols; j++) {
+			values[(size_t)i * (size_t)pitch + (size_t)j] = 
+				(real)initial_grid_value(first_row + i, first_col + j);
+		}
+	}
+}
+
+
+/*
+ * Fills values, a num_planes x num_rows x num_cols part of the cube stored 
+ * plane by plane and row by row (planes being plane_pitch values apart and 
+ * rows pitch values apart), with the initial values of the cube starting at 
+ * plane first_plane, row first_row and column first_col.
+ */
+void initialise_volume_values(real* values, int pitch, int plane_pitch, 
+	int first_plane, int first_row, int first_col, int num_planes, 
+	int num_rows, int num_cols) {
+	int k;
+
+	for (k = 0; k < num_planes; k++) {
+		real *plane = &values[(size_t)k * (size_t)plane_pitch];
+		int i, j;
+
+		for (i = 0; i < num_rows; i++) {
+			for (j = 0; j < num_cols; j++) {
+				plane[(size_t)i * (size_t)pitch + (size_t)j] = 
+					(real)initial_volume_value(first_plane + k, first_row + i, 
+					first_col + j);
+			}
+		}
+	}
+}
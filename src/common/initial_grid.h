@@ -0,0 +1,32 @@
+/**
+ * CM30225 Parallel Computing
+ * 
+ * Header file for the generator of the initial values of the square array, 
+ * used by the sequential and distributed memory versions so that any part of
+ * the array can be generated on its own.
+ */
+
+
+double initial_grid_value(int row, int col);
+
+
+void initialise_grid_values(real* values, 
+							int pitch, 
+							int first_row, 
+							int first_col, 
+							int num_rows, 
+							int num_cols);
+
+
+double initial_volume_value(int plane, int row, int col);
+
+
+void initialise_volume_values(real* values, 
+							  int pitch, 
+							  int plane_pitch, 
+							  int first_plane, 
+							  int first_row, 
+							  int first_col, 
+							  int num_planes, 
+							  int num_rows, 
+							  int num_cols);
@@ -0,0 +1,153 @@
+/**
+ * CM30225 Parallel Computing
+ * 
+ * Source file for the index of the live cells of a masked array, the cells
+ * that are relaxed when a mask holds some cells of the array fixed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "real.h"
+#include "live_segments.h"
+#include "stencil_kernel.h"
+
+
+/*
+ * Indexes the live cells of num_rows rows of num_cols values, given the mask
+ * of these rows (rows being pitch values apart), in which fixed cells are not
+ * 0. The first and last values of every row are boundaries of the array,
+ * which are always fixed, as are the first and last rows if they are
+ * boundaries (the caller then gives a mask whose first or last row is all
+ * fixed).
+ */
+struct live_segments* build_live_segments(const real* mask, int pitch,
+	int num_rows, int num_cols) {
+	struct live_segments *ls = malloc(sizeof(struct live_segments));
+	int num_segments = 0;
+	int i, j, start;
+
+	if (ls == NULL) {
+		fprintf(stderr, "Error: live segments memory could not be "
+			"allocated.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// count the segments first, to allocate the index at once
+	for (i = 0; i < num_rows; i++) {
+		for (j = 1; j < num_cols - 1; j++) {
+			if (mask[(size_t)i * (size_t)pitch + (size_t)j] == 0 &&
+				(j == 1 || mask[(size_t)i * (size_t)pitch + (size_t)j - 1] != 0)) {
+				num_segments++;
+			}
+		}
+	}
+	ls->num_rows = num_rows;
+	ls->num_live_cells = 0;
+	ls->first_segment = malloc((size_t)(num_rows + 1) * sizeof(int));
+	ls->start_cols = malloc((size_t)(num_segments > 0 ? num_segments : 1) *
+		sizeof(int));
+	ls->end_cols = malloc((size_t)(num_segments > 0 ? num_segments : 1) *
+		sizeof(int));
+	if (ls->first_segment == NULL || ls->start_cols == NULL ||
+		ls->end_cols == NULL) {
+		fprintf(stderr, "Error: live segments memory could not be "
+			"allocated.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	num_segments = 0;
+	for (i = 0; i < num_rows; i++) {
+		ls->first_segment[i] = num_segments;
+		for (j = 1; j < num_cols - 1; j++) {
+			if (mask[(size_t)i * (size_t)pitch + (size_t)j] != 0) {
+				continue;
+			}
+
+			// the segment goes on until the next fixed cell
+			start = j;
+			while (j < num_cols - 1 &&
+				mask[(size_t)i * (size_t)pitch + (size_t)j] == 0) {
+				j++;
+			}
+			ls->start_cols[num_segments] = start;
+			ls->end_cols[num_segments] = j;
+			ls->num_live_cells += j - start;
+			num_segments++;
+		}
+	}
+	ls->first_segment[num_rows] = num_segments;
+	return ls;
+}
+
+
+/*
+ * Relaxes the live cells of the rows first_row to end_row (excluded) with the
+ * Jacobi method, reading rows and writing new_rows (which point to each row
+ * of the values and of the new values), one segment at a time by the stencil
+ * kernel. Fixed cells are never written, so the new values must hold them
+ * already.
+ * Returns the largest difference between an old and a new value.
+ */
+double jacobi_live_rows(const struct live_segments* ls, real* const* rows,
+	real* const* new_rows, int first_row, int end_row) {
+	double max_diff = 0.0;
+	double difference;
+	int i, s, offset;
+
+	for (i = first_row; i < end_row; i++) {
+		for (s = ls->first_segment[i]; s < ls->first_segment[i+1]; s++) {
+			// the segment and the fixed cells on either side of it
+			offset = ls->start_cols[s] - 1;
+			difference = stencil_row(&rows[i-1][offset], &rows[i][offset],
+				&rows[i+1][offset], &new_rows[i][offset],
+				ls->end_cols[s] - ls->start_cols[s] + 2);
+			if (difference > max_diff) {
+				max_diff = difference;
+			}
+		}
+	}
+	return max_diff;
+}
+
+
+/*
+ * Relaxes the live cells of the given colour of the rows first_row to end_row
+ * (excluded) in place, moving them towards the average of their neighbours by
+ * the relaxation factor omega, one segment at a time by the stencil kernel.
+ * Cells are coloured like a chess board using their position in the full
+ * square array, start_row being the index of the first row in it (red cells,
+ * colour 0, have an even row + column index).
+ * Returns the largest difference between an old and a new value.
+ */
+double red_black_live_rows(const struct live_segments* ls, real* const* rows,
+	int first_row, int end_row, int start_row, int colour, double omega) {
+	double max_diff = 0.0;
+	double difference;
+	int i, s, offset;
+
+	for (i = first_row; i < end_row; i++) {
+		for (s = ls->first_segment[i]; s < ls->first_segment[i+1]; s++) {
+			// the first cell of the segment is the second value handed over
+			offset = ls->start_cols[s] - 1;
+			difference = stencil_row_colour(&rows[i-1][offset],
+				&rows[i][offset], &rows[i+1][offset], NULL,
+				ls->end_cols[s] - ls->start_cols[s] + 2,
+				1 + (start_row + i + colour + ls->start_cols[s]) % 2, omega);
+			if (difference > max_diff) {
+				max_diff = difference;
+			}
+		}
+	}
+	return max_diff;
+}
+
+
+/*
+ * Frees the index of the live cells.
+ */
+void free_live_segments(struct live_segments* ls) {
+	free(ls->first_segment);
+	free(ls->start_cols);
+	free(ls->end_cols);
+	free(ls);
+}
@@ -0,0 +1,41 @@
+/**
+ * CM30225 Parallel Computing
+ * 
+ * Header file for the index of the live cells of a masked array, the cells
+ * that are relaxed when a mask holds some cells of the array fixed.
+ */
+
+
+struct live_segments {
+	// structure used to find the runs of live cells of each row
+	int num_rows;			// number of rows indexed
+	int *first_segment;		// first segment of each row (and the end)
+	int *start_cols;		// first column of each segment
+	int *end_cols;			// column after the last column of each segment
+	long num_live_cells;	// number of live cells of all rows
+};
+
+
+struct live_segments* build_live_segments(const real* mask,
+										  int pitch,
+										  int num_rows,
+										  int num_cols);
+
+
+double jacobi_live_rows(const struct live_segments* ls,
+						real* const* rows,
+						real* const* new_rows,
+						int first_row,
+						int end_row);
+
+
+double red_black_live_rows(const struct live_segments* ls,
+						   real* const* rows,
+						   int first_row,
+						   int end_row,
+						   int start_row,
+						   int colour,
+						   double omega);
+
+
+void free_live_segments(struct live_segments* ls);
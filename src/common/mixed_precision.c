@@ -0,0 +1,173 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Source file for the single precision copy of the square array relaxed by 
+ * the mixed precision mode of the sequential, shared memory and distributed 
+ * memory versions.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "real.h"
+#include "mixed_precision.h"
+#include "single_stencil_kernel.h"
+
+#define CACHE_LINE 64
+#define FLOATS_PER_LINE ((int)(CACHE_LINE / sizeof(float)))
+
+
+/*
+ * Points each row of a buffer at its first value.
+ */
+static float** allocate_single_rows(float* values, int num_rows, int pitch) {
+	float **rows = malloc((size_t)num_rows * sizeof(float*));
+	int i;
+
+	if (rows == NULL) {
+		fprintf(stderr, "Failed to allocate space for the array.\n");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < num_rows; i++) {
+		rows[i] = &values[(size_t)i * (size_t)pitch];
+	}
+	return rows;
+}
+
+
+/*
+ * Allocates a single precision grid of num_rows rows of num_cols values, with
+ * a second buffer if num_buffers is 2, rows being an odd number of cache 
+ * lines apart and shifted so that their second value starts a cache line (as
+ * in grid.c). Also picks the single precision kernels, so it must be called 
+ * before any thread relaxes rows. The values are not initialised.
+ */
+struct single_grid* allocate_single_grid(int num_rows, int num_cols, 
+	int num_buffers) {
+	struct single_grid *s = malloc(sizeof(struct single_grid));
+	int lines = (num_cols + FLOATS_PER_LINE - 1) / FLOATS_PER_LINE;
+	size_t buffer_size;
+	void *memory;
+
+	if (s == NULL) {
+		fprintf(stderr, "Failed to allocate space for the array.\n");
+		exit(EXIT_FAILURE);
+	}
+	s->num_rows = num_rows;
+	s->num_cols = num_cols;
+	s->pitch = (lines % 2 == 0 ? lines + 1 : lines) * FLOATS_PER_LINE;
+
+	// one more cache line per buffer for the shift of the rows
+	buffer_size = (size_t)num_rows * (size_t)s->pitch + FLOATS_PER_LINE;
+	if (posix_memalign(&memory, CACHE_LINE, (size_t)num_buffers * buffer_size * sizeof(float)) != 0) {
+		fprintf(stderr, "Failed to allocate space for the array.\n");
+		exit(EXIT_FAILURE);
+	}
+	s->memory = memory;
+	s->rows = allocate_single_rows(&s->memory[FLOATS_PER_LINE - 1], num_rows, s->pitch);
+	s->next_rows = NULL;
+	if (num_buffers == 2) {
+		s->next_rows = allocate_single_rows(&s->memory[buffer_size + FLOATS_PER_LINE - 1], num_rows, s->pitch);
+	}
+
+	initialise_single_stencil_kernel();
+	return s;
+}
+
+
+/*
+ * Copies rows first_row to end_row (excluded) of a square array, length 
+ * values each, into the same rows of a single precision buffer.
+ */
+void to_single_rows(real* const* rows, float* const* single_rows, 
+	int first_row, int end_row, int length) {
+	int i, j;
+
+	for (i = first_row; i < end_row; i++) {
+		for (j = 0; j < length; j++) {
+			single_rows[i][j] = (float)rows[i][j];
+		}
+	}
+}
+
+
+/*
+ * Copies rows first_row to end_row (excluded) of a single precision buffer, 
+ * length values each, back into the same rows of a square array.
+ */
+void to_double_rows(float* const* single_rows, real* const* rows, 
+	int first_row, int end_row, int length) {
+	int i, j;
+
+	for (i = first_row; i < end_row; i++) {
+		for (j = 0; j < length; j++) {
+			rows[i][j] = (real)single_rows[i][j];
+		}
+	}
+}
+
+
+/*
+ * Relaxes rows first_row to end_row (excluded) of a single precision buffer 
+ * with the Jacobi method, writing the new values to new_rows.
+ * Returns the largest difference between an old and a new value.
+ */
+double single_jacobi_rows(float* const* rows, float* const* new_rows, 
+	int first_row, int end_row, int length) {
+	double max_diff = 0.0;
+	double difference;
+	int i;
+
+	for (i = first_row; i < end_row; i++) {
+		difference = single_stencil_row(rows[i-1], rows[i], rows[i+1], 
+			new_rows[i], length);
+		max_diff = difference > max_diff ? difference : max_diff;
+	}
+	return max_diff;
+}
+
+
+/*
+ * Relaxes the cells of the given colour (0: red, 1: black) of rows first_row
+ * to end_row (excluded) of a single precision buffer in place, over-relaxed 
+ * by w. Row 0 of the buffer is row start_row of the square array, which 
+ * decides the colour of its cells.
+ * Returns the largest difference between an old and a new value.
+ */
+double single_colour_rows(float* const* rows, int first_row, int end_row, 
+	int length, int start_row, int colour, double w) {
+	double max_diff = 0.0;
+	double difference;
+	int i;
+
+	for (i = first_row; i < end_row; i++) {
+		difference = single_stencil_row_colour(rows[i-1], rows[i], rows[i+1], 
+			NULL, length, 1 + (start_row + i + 1 + colour) % 2, w);
+		max_diff = difference > max_diff ? difference : max_diff;
+	}
+	return max_diff;
+}
+
+
+/*
+ * Swaps the buffer and the second buffer, once the values relaxed into the
+ * second buffer become the current values.
+ */
+void swap_single_buffers(struct single_grid* s) {
+	float **temp_rows = s->rows;
+
+	s->rows = s->next_rows;
+	s->next_rows = temp_rows;
+}
+
+
+/*
+ * Frees the buffers, their rows and the structure of the grid.
+ */
+void free_single_grid(struct single_grid* s) {
+	free(s->rows);
+	free(s->next_rows);
+	free(s->memory);
+	free(s);
+}
@@ -0,0 +1,59 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Header file for the single precision copy of the square array relaxed by 
+ * the mixed precision mode of the sequential, shared memory and distributed 
+ * memory versions.
+ */
+
+
+struct single_grid {
+	// structure used to keep track of the rows of a single precision copy of a grid
+	int num_rows;			// number of rows, halo rows included
+	int num_cols;			// number of values of each row
+	int pitch;				// values from the start of a row to the next one
+	float **rows;			// first value of each row of the buffer
+	float **next_rows;		// same for the second buffer (NULL if none)
+	float *memory;			// aligned allocation holding every buffer
+};
+
+
+struct single_grid* allocate_single_grid(int num_rows, 
+										 int num_cols, 
+										 int num_buffers);
+
+
+void to_single_rows(real* const* rows, 
+					float* const* single_rows, 
+					int first_row, 
+					int end_row, 
+					int length);
+
+
+void to_double_rows(float* const* single_rows, 
+					real* const* rows, 
+					int first_row, 
+					int end_row, 
+					int length);
+
+
+double single_jacobi_rows(float* const* rows, 
+						  float* const* new_rows, 
+						  int first_row, 
+						  int end_row, 
+						  int length);
+
+
+double single_colour_rows(float* const* rows, 
+						  int first_row, 
+						  int end_row, 
+						  int length, 
+						  int start_row, 
+						  int colour, 
+						  double w);
+
+
+void swap_single_buffers(struct single_grid* s);
+
+
+void free_single_grid(struct single_grid* s);
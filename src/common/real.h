@@ -0,0 +1,16 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Header file for the type of the values of the square array, used by the
+ * sequential, shared memory and distributed memory versions.
+ */
+
+#ifdef SINGLE_PRECISION
+typedef float real;
+#define REAL_MPI_TYPE MPI_FLOAT
+#define REAL_NAME "single"
+#else
+typedef double real;
+#define REAL_MPI_TYPE MPI_DOUBLE
+#define REAL_NAME "double"
+#endif
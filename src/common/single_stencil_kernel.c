@@ -0,0 +1,27 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Source file for the single precision stencil kernels used by the mixed 
+ * precision mode of double precision builds (see mixed_precision.c).
+ */
+
+#ifndef SINGLE_PRECISION
+#define SINGLE_PRECISION
+#endif
+
+#define scalar_stencil_row single_scalar_stencil_row
+#define scalar_stencil_row_colour single_scalar_stencil_row_colour
+#define aligned_start single_aligned_start
+#define avx2_stencil_row single_avx2_stencil_row
+#define avx2_stencil_row_colour single_avx2_stencil_row_colour
+#define avx512_stencil_row single_avx512_stencil_row
+#define avx512_stencil_row_colour single_avx512_stencil_row_colour
+#define selected_kernel_name single_selected_kernel_name
+#define selected_row_kernel single_selected_row_kernel
+#define selected_row_colour_kernel single_selected_row_colour_kernel
+#define initialise_stencil_kernel initialise_single_stencil_kernel
+#define stencil_kernel_name single_stencil_kernel_name
+#define stencil_row single_stencil_row
+#define stencil_row_colour single_stencil_row_colour
+
+#include "stencil_kernel.c"
@@ -0,0 +1,25 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Header file for the single precision stencil kernels used by the mixed 
+ * precision mode of double precision builds.
+ */
+
+
+void initialise_single_stencil_kernel(void);
+
+
+double single_stencil_row(const float* up, 
+						  const float* row, 
+						  const float* down, 
+						  float* new_row, 
+						  int length);
+
+
+double single_stencil_row_colour(const float* up, 
+								 float* row, 
+								 const float* down, 
+								 const float* rhs, 
+								 int length, 
+								 int first, 
+								 double w);
@@ -0,0 +1,66 @@
+/**
+ * CM30225 Parallel Computing
+ * 
+ * Source file for the detection of relaxations that stopped converging, used 
+ * by the sequential, shared memory and distributed memory versions.
+ */
+
+#include <stdio.h>
+#include "real.h"
+#include "stall.h"
+
+#define STALL_ITERATIONS 1000
+
+
+/*
+ * Starts keeping track of the convergence of a relaxation.
+ */
+void initialise_stall(struct stall* s) {
+	s->smallest_diff = -1.0;
+	s->iterations = 0;
+}
+
+
+/*
+ * Records the largest difference of an iteration of a relaxation of single 
+ * precision values, whatever the type of the values of the array (see 
+ * mixed_precision.c).
+ * Returns 1 if the relaxation has stalled, 0 otherwise.
+ */
+int has_float_stalled(struct stall* s, double max_diff) {
+	if (s->smallest_diff < 0.0 || max_diff < s->smallest_diff) {
+		s->smallest_diff = max_diff;
+		s->iterations = 0;
+		return 0;
+	}
+	s->iterations++;
+	return s->iterations >= STALL_ITERATIONS;
+}
+
+
+/*
+ * Records the largest difference of an iteration of the relaxation.
+ * Returns 1 if the relaxation has stalled, 0 otherwise (always in double 
+ * precision).
+ */
+int has_stalled(struct stall* s, double max_diff) {
+#ifdef SINGLE_PRECISION
+	return has_float_stalled(s, max_diff);
+#else
+	has_float_stalled(s, max_diff);
+	return 0;
+#endif
+}
+
+
+/*
+ * Prints a warning if a relaxation stopped before reaching the precision, 
+ * having stalled with the given largest difference.
+ */
+void warn_if_stalled(double max_diff, double precision) {
+	if (max_diff >= precision) {
+		fprintf(stderr, "WARNING: Relaxation stalled with a largest difference "
+			"of %f, %s precision values can't reach precision %f.\n", max_diff, 
+			REAL_NAME, precision);
+	}
+}
@@ -0,0 +1,25 @@
+/**
+ * CM30225 Parallel Computing
+ * 
+ * Header file for the detection of relaxations that stopped converging, used 
+ * by the sequential, shared memory and distributed memory versions.
+ */
+
+
+struct stall {
+	// structure used to keep track of the convergence of a relaxation
+	double smallest_diff;	// smallest largest difference of an iteration
+	int iterations;			// iterations since it was reached
+};
+
+
+void initialise_stall(struct stall* s);
+
+
+int has_float_stalled(struct stall* s, double max_diff);
+
+
+int has_stalled(struct stall* s, double max_diff);
+
+
+void warn_if_stalled(double max_diff, double precision);
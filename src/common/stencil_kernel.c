@@ -0,0 +1,470 @@
+/**
+ * CM30225 Parallel Computing
+ * 
+ * Source file for the stencil kernels used by the sequential, shared memory 
+ * and distributed memory versions to relax rows of the square array.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "real.h"
+#include "stencil_kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_KERNELS
+
+// AVX-512 comes with fused multiply-adds, which round differently than the 
+// scalar kernels: don't let the compiler use them
+#pragma GCC optimize ("fp-contract=off")
+
+// vectors of 4 and 8 doubles, or 8 and 16 floats in single precision, and the
+// intrinsics working on them
+#ifdef SINGLE_PRECISION
+#define LANES256 8
+#define LANES512 16
+typedef __m256 vector256;
+typedef __m512 vector512;
+typedef __mmask16 mask512;
+#define EVEN_LANES256 _mm256_set_epi32(0, -1, 0, -1, 0, -1, 0, -1)
+#define ODD_LANES256 _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0)
+#define EVEN_LANES512 0x5555
+#define ODD_LANES512 0xAAAA
+#define set1_256 _mm256_set1_ps
+#define setzero256 _mm256_setzero_ps
+#define load256 _mm256_load_ps
+#define loadu256 _mm256_loadu_ps
+#define store256 _mm256_store_ps
+#define storeu256 _mm256_storeu_ps
+#define maskstore256 _mm256_maskstore_ps
+#define add256 _mm256_add_ps
+#define sub256 _mm256_sub_ps
+#define mul256 _mm256_mul_ps
+#define max256 _mm256_max_ps
+#define and256 _mm256_and_ps
+#define andnot256 _mm256_andnot_ps
+#define castmask256 _mm256_castsi256_ps
+#define set1_512 _mm512_set1_ps
+#define setzero512 _mm512_setzero_ps
+#define load512 _mm512_load_ps
+#define loadu512 _mm512_loadu_ps
+#define store512 _mm512_store_ps
+#define mask_store512 _mm512_mask_store_ps
+#define add512 _mm512_add_ps
+#define sub512 _mm512_sub_ps
+#define mul512 _mm512_mul_ps
+#define max512 _mm512_max_ps
+#define mask_max512 _mm512_mask_max_ps
+#define abs512 _mm512_abs_ps
+#define reduce_max512 _mm512_reduce_max_ps
+#else
+#define LANES256 4
+#define LANES512 8
+typedef __m256d vector256;
+typedef __m512d vector512;
+typedef __mmask8 mask512;
+#define EVEN_LANES256 _mm256_set_epi64x(0, -1, 0, -1)
+#define ODD_LANES256 _mm256_set_epi64x(-1, 0, -1, 0)
+#define EVEN_LANES512 0x55
+#define ODD_LANES512 0xAA
+#define set1_256 _mm256_set1_pd
+#define setzero256 _mm256_setzero_pd
+#define load256 _mm256_load_pd
+#define loadu256 _mm256_loadu_pd
+#define store256 _mm256_store_pd
+#define storeu256 _mm256_storeu_pd
+#define maskstore256 _mm256_maskstore_pd
+#define add256 _mm256_add_pd
+#define sub256 _mm256_sub_pd
+#define mul256 _mm256_mul_pd
+#define max256 _mm256_max_pd
+#define and256 _mm256_and_pd
+#define andnot256 _mm256_andnot_pd
+#define castmask256 _mm256_castsi256_pd
+#define set1_512 _mm512_set1_pd
+#define setzero512 _mm512_setzero_pd
+#define load512 _mm512_load_pd
+#define loadu512 _mm512_loadu_pd
+#define store512 _mm512_store_pd
+#define mask_store512 _mm512_mask_store_pd
+#define add512 _mm512_add_pd
+#define sub512 _mm512_sub_pd
+#define mul512 _mm512_mul_pd
+#define max512 _mm512_max_pd
+#define mask_max512 _mm512_mask_max_pd
+#define abs512 _mm512_abs_pd
+#define reduce_max512 _mm512_reduce_max_pd
+#endif
+#endif
+
+
+/*
+ * Relaxes values 1 to length - 2 of a row with the Jacobi method: new values 
+ * are the average of the 4 neighbours read from up, row and down, and are 
+ * written to new_row.
+ * Returns the largest difference between an old and a new value.
+ */
+double scalar_stencil_row(const real* up, const real* row, 
+	const real* down, real* new_row, int length) {
+	real max_diff = 0.0;
+	real new_value, difference;
+	int j;
+
+	for (j = 1; j < length - 1; j++) {
+		new_value = (row[j-1] + row[j+1] + up[j] + down[j]) / 4;
+		new_row[j] = new_value;
+		difference = (real)fabs(row[j] - new_value);
+		max_diff = difference > max_diff ? difference : max_diff;
+	}
+	return max_diff;
+}
+
+
+/*
+ * Relaxes values first, first + 2, ... (up to length - 2) of a row in place, 
+ * over-relaxed by w. The 4 neighbours of these values are never updated by 
+ * the same call, which is what red-black ordering relies on. If rhs is not 
+ * NULL, its values are added to the 4 neighbours.
+ * Returns the largest difference between an old and a new value.
+ */
+double scalar_stencil_row_colour(const real* up, real* row, 
+	const real* down, const real* rhs, int length, int first, double w) {
+	const real omega = (real)w;
+	const real keep = (real)(1 - w);
+	real max_diff = 0.0;
+	real sum, new_value, difference;
+	int j;
+
+	for (j = first; j < length - 1; j += 2) {
+		sum = row[j-1] + row[j+1] + up[j] + down[j];
+		if (rhs != NULL) {
+			sum += rhs[j];
+		}
+		new_value = keep * row[j] + omega * sum / 4;
+		difference = (real)fabs(row[j] - new_value);
+		max_diff = difference > max_diff ? difference : max_diff;
+		row[j] = new_value;
+	}
+	return max_diff;
+}
+
+
+#ifdef HAVE_X86_KERNELS
+
+/*
+ * Returns the first index from 1 at which the row is aligned to the given 
+ * number of bytes (at most length - 1). Vector stores that straddle 2 cache
+ * lines are much slower, so the kernels relax the values before it one by 
+ * one.
+ */
+int aligned_start(const real* row, int length, int alignment) {
+	int j = 1;
+	while (j < length - 1 && (uintptr_t) &row[j] % (uintptr_t) alignment != 0) {
+		j++;
+	}
+	return j;
+}
+
+
+/*
+ * Returns the largest of the given lanes of a vector.
+ */
+static inline real max_of_lanes(const real* lanes, int num_lanes) {
+	real max_lane = lanes[0];
+	int i;
+
+	for (i = 1; i < num_lanes; i++) {
+		max_lane = lanes[i] > max_lane ? lanes[i] : max_lane;
+	}
+	return max_lane;
+}
+
+
+/*
+ * AVX2 version of scalar_stencil_row, 4 values (8 in single precision) at a 
+ * time.
+ */
+__attribute__((target("avx2")))
+double avx2_stencil_row(const real* up, const real* row, 
+	const real* down, real* new_row, int length) {
+	const vector256 quarter = set1_256(0.25);
+	const vector256 sign = set1_256(-0.0);
+	vector256 sum, new_values, max_diffs = setzero256();
+	real lanes[LANES256];
+	double max_diff;
+	int j = aligned_start(new_row, length, 32);
+
+	// first values, up to an aligned one
+	max_diff = scalar_stencil_row(up, row, down, new_row, j + 1);
+
+	for (; j + LANES256 < length; j += LANES256) {
+		sum = add256(loadu256(&row[j-1]), loadu256(&row[j+1]));
+		sum = add256(sum, loadu256(&up[j]));
+		sum = add256(sum, loadu256(&down[j]));
+		new_values = mul256(sum, quarter);
+		store256(&new_row[j], new_values);
+		max_diffs = max256(max_diffs, andnot256(sign, 
+			sub256(loadu256(&row[j]), new_values)));
+	}
+	storeu256(lanes, max_diffs);
+	max_diff = fmax(max_diff, max_of_lanes(lanes, LANES256));
+
+	// last values that don't fill a vector
+	return fmax(max_diff, scalar_stencil_row(&up[j-1], &row[j-1], &down[j-1], 
+		&new_row[j-1], length - j + 1));
+}
+
+
+/*
+ * Returns the sums of the 4 neighbours (and right hand sides) of the values 
+ * of a vector starting at row[j].
+ */
+__attribute__((target("avx2")))
+static inline vector256 avx2_neighbour_sum(const real* up, const real* row, 
+	const real* down, const real* rhs, int j) {
+	vector256 sum = add256(loadu256(&row[j-1]), loadu256(&row[j+1]));
+	sum = add256(sum, loadu256(&up[j]));
+	sum = add256(sum, loadu256(&down[j]));
+	if (rhs != NULL) {
+		sum = add256(sum, loadu256(&rhs[j]));
+	}
+	return sum;
+}
+
+
+/*
+ * AVX2 version of scalar_stencil_row_colour: averages a vector of consecutive
+ * values and only stores the half of them of the right colour. The next 
+ * values are loaded before storing, as loading values right after a masked 
+ * store that overlaps them stalls until the store is done.
+ */
+__attribute__((target("avx2")))
+double avx2_stencil_row_colour(const real* up, real* row, 
+	const real* down, const real* rhs, int length, int first, double w) {
+	const vector256 quarter = set1_256(0.25);
+	const vector256 sign = set1_256(-0.0);
+	const vector256 omega = set1_256((real)w);
+	const vector256 keep = set1_256((real)(1 - w));
+	vector256 old_values, sum, new_values, max_diffs = setzero256();
+	vector256 next_old_values = setzero256();
+	vector256 next_sum = setzero256();
+	__m256i colour_mask;
+	real lanes[LANES256];
+	double max_diff;
+	int start = aligned_start(row, length, 32);
+	int j = start;
+
+	// values of the right colour are the even or the odd lanes
+	colour_mask = (j + first) % 2 == 0 ? EVEN_LANES256 : ODD_LANES256;
+	if (j + LANES256 < length) {
+		next_old_values = load256(&row[j]);
+		next_sum = avx2_neighbour_sum(up, row, down, rhs, j);
+	}
+	for (; j + LANES256 < length; j += LANES256) {
+		old_values = next_old_values;
+		sum = next_sum;
+		new_values = add256(mul256(keep, old_values), 
+			mul256(mul256(omega, sum), quarter));
+		if (j + 2 * LANES256 < length) {
+			next_old_values = load256(&row[j+LANES256]);
+			next_sum = avx2_neighbour_sum(up, row, down, rhs, j + LANES256);
+		}
+		maskstore256(&row[j], colour_mask, new_values);
+		max_diffs = max256(max_diffs, and256(castmask256(colour_mask), 
+			andnot256(sign, sub256(old_values, new_values))));
+	}
+	storeu256(lanes, max_diffs);
+	max_diff = max_of_lanes(lanes, LANES256);
+
+	// first values, up to an aligned one, and last values that don't fill a 
+	// vector (relaxing the first values before the vectors would store values
+	// right before loading them again, which stalls)
+	max_diff = fmax(max_diff, scalar_stencil_row_colour(up, row, down, rhs, 
+		start + 1, first, w));
+	return fmax(max_diff, scalar_stencil_row_colour(&up[j-1], &row[j-1], 
+		&down[j-1], rhs != NULL ? &rhs[j-1] : NULL, length - j + 1, 
+		1 + (j + first) % 2, w));
+}
+
+
+/*
+ * AVX-512 version of scalar_stencil_row, 8 values (16 in single precision) at
+ * a time. The upper halves of the vector registers are cleared before calling
+ * the scalar kernel, as the compiler doesn't always do it and scalar 
+ * instructions are much slower until it is done.
+ */
+__attribute__((target("avx512f")))
+double avx512_stencil_row(const real* up, const real* row, 
+	const real* down, real* new_row, int length) {
+	const vector512 quarter = set1_512(0.25);
+	vector512 sum, new_values, max_diffs = setzero512();
+	double max_diff;
+	int j = aligned_start(new_row, length, 64);
+
+	// first values, up to an aligned one
+	max_diff = scalar_stencil_row(up, row, down, new_row, j + 1);
+
+	for (; j + LANES512 < length; j += LANES512) {
+		sum = add512(loadu512(&row[j-1]), loadu512(&row[j+1]));
+		sum = add512(sum, loadu512(&up[j]));
+		sum = add512(sum, loadu512(&down[j]));
+		new_values = mul512(sum, quarter);
+		store512(&new_row[j], new_values);
+		max_diffs = max512(max_diffs, 
+			abs512(sub512(loadu512(&row[j]), new_values)));
+	}
+	max_diff = fmax(max_diff, reduce_max512(max_diffs));
+	_mm256_zeroupper();
+
+	// last values that don't fill a vector
+	return fmax(max_diff, scalar_stencil_row(&up[j-1], &row[j-1], &down[j-1], 
+		&new_row[j-1], length - j + 1));
+}
+
+
+/*
+ * Returns the sums of the 4 neighbours (and right hand sides) of the values 
+ * of a vector starting at row[j].
+ */
+__attribute__((target("avx512f")))
+static inline vector512 avx512_neighbour_sum(const real* up, const real* row,
+	const real* down, const real* rhs, int j) {
+	vector512 sum = add512(loadu512(&row[j-1]), loadu512(&row[j+1]));
+	sum = add512(sum, loadu512(&up[j]));
+	sum = add512(sum, loadu512(&down[j]));
+	if (rhs != NULL) {
+		sum = add512(sum, loadu512(&rhs[j]));
+	}
+	return sum;
+}
+
+
+/*
+ * AVX-512 version of scalar_stencil_row_colour: averages a vector of 
+ * consecutive values and only stores the half of them of the right colour, 
+ * loading the next values before storing (see avx2_stencil_row_colour).
+ */
+__attribute__((target("avx512f")))
+double avx512_stencil_row_colour(const real* up, real* row, 
+	const real* down, const real* rhs, int length, int first, double w) {
+	const vector512 quarter = set1_512(0.25);
+	const vector512 omega = set1_512((real)w);
+	const vector512 keep = set1_512((real)(1 - w));
+	vector512 old_values, sum, new_values, max_diffs = setzero512();
+	vector512 next_old_values = setzero512();
+	vector512 next_sum = setzero512();
+	mask512 colour_mask;
+	double max_diff;
+	int start = aligned_start(row, length, 64);
+	int j = start;
+
+	// values of the right colour are the even or the odd lanes
+	colour_mask = (j + first) % 2 == 0 ? EVEN_LANES512 : ODD_LANES512;
+	if (j + LANES512 < length) {
+		next_old_values = load512(&row[j]);
+		next_sum = avx512_neighbour_sum(up, row, down, rhs, j);
+	}
+	for (; j + LANES512 < length; j += LANES512) {
+		old_values = next_old_values;
+		sum = next_sum;
+		new_values = add512(mul512(keep, old_values), 
+			mul512(mul512(omega, sum), quarter));
+		if (j + 2 * LANES512 < length) {
+			next_old_values = load512(&row[j+LANES512]);
+			next_sum = avx512_neighbour_sum(up, row, down, rhs, j + LANES512);
+		}
+		mask_store512(&row[j], colour_mask, new_values);
+		max_diffs = mask_max512(max_diffs, colour_mask, max_diffs, 
+			abs512(sub512(old_values, new_values)));
+	}
+	max_diff = reduce_max512(max_diffs);
+	_mm256_zeroupper();
+
+	// first values, up to an aligned one, and last values that don't fill a 
+	// vector (see avx2_stencil_row_colour)
+	max_diff = fmax(max_diff, scalar_stencil_row_colour(up, row, down, rhs, 
+		start + 1, first, w));
+	return fmax(max_diff, scalar_stencil_row_colour(&up[j-1], &row[j-1], 
+		&down[j-1], rhs != NULL ? &rhs[j-1] : NULL, length - j + 1, 
+		1 + (j + first) % 2, w));
+}
+
+#endif
+
+
+/* Kernels used by stencil_row and stencil_row_colour, scalar until picked */
+const char *selected_kernel_name = "scalar";
+double (*selected_row_kernel)(const real*, const real*, const real*, real*, 
+	int) = scalar_stencil_row;
+double (*selected_row_colour_kernel)(const real*, real*, const real*, 
+	const real*, int, int, double) = scalar_stencil_row_colour;
+
+
+/*
+ * Picks the widest kernels the CPU supports, unless the RELAXATION_KERNEL 
+ * environment variable asks for narrower ones. Must be called once before any
+ * thread relaxes rows.
+ */
+void initialise_stencil_kernel(void) {
+	const char *requested = getenv("RELAXATION_KERNEL");
+	if (requested != NULL && strcmp(requested, "scalar") != 0 && 
+		strcmp(requested, "avx2") != 0 && strcmp(requested, "avx512") != 0) {
+		fprintf(stderr, "WARNING: Invalid RELAXATION_KERNEL. Must be scalar, "
+			"avx2 or avx512. Using the widest kernel the CPU supports.\n");
+		requested = NULL;
+	}
+
+#ifdef HAVE_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") && 
+		(requested == NULL || strcmp(requested, "avx512") == 0)) {
+		selected_kernel_name = "avx512";
+		selected_row_kernel = avx512_stencil_row;
+		selected_row_colour_kernel = avx512_stencil_row_colour;
+		return;
+	}
+	if (__builtin_cpu_supports("avx2") && 
+		(requested == NULL || strcmp(requested, "scalar") != 0)) {
+		selected_kernel_name = "avx2";
+		selected_row_kernel = avx2_stencil_row;
+		selected_row_colour_kernel = avx2_stencil_row_colour;
+		return;
+	}
+#endif
+	selected_kernel_name = "scalar";
+	selected_row_kernel = scalar_stencil_row;
+	selected_row_colour_kernel = scalar_stencil_row_colour;
+}
+
+
+/*
+ * Returns the name of the kernels in use (scalar, avx2 or avx512).
+ */
+const char* stencil_kernel_name(void) {
+	return selected_kernel_name;
+}
+
+
+/*
+ * Relaxes values 1 to length - 2 of a row with the Jacobi method, writing the
+ * new values to new_row (see scalar_stencil_row).
+ * Returns the largest difference between an old and a new value.
+ */
+double stencil_row(const real* up, const real* row, const real* down, 
+	real* new_row, int length) {
+	return selected_row_kernel(up, row, down, new_row, length);
+}
+
+
+/*
+ * Relaxes values first, first + 2, ... of a row in place, over-relaxed by w 
+ * (see scalar_stencil_row_colour).
+ * Returns the largest difference between an old and a new value.
+ */
+double stencil_row_colour(const real* up, real* row, const real* down, 
+	const real* rhs, int length, int first, double w) {
+	return selected_row_colour_kernel(up, row, down, rhs, length, first, w);
+}
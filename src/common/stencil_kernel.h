@@ -0,0 +1,28 @@
+/**
+ * CM30225 Parallel Computing
+ * 
+ * Header file for the stencil kernels used by the sequential, shared memory 
+ * and distributed memory versions to relax rows of the square array.
+ */
+
+
+void initialise_stencil_kernel(void);
+
+
+const char* stencil_kernel_name(void);
+
+
+double stencil_row(const real* up, 
+				   const real* row, 
+				   const real* down, 
+				   real* new_row, 
+				   int length);
+
+
+double stencil_row_colour(const real* up, 
+						  real* row, 
+						  const real* down, 
+						  const real* rhs, 
+						  int length, 
+						  int first, 
+						  double w);
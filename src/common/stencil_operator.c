@@ -0,0 +1,303 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Source file for the stencil operators relaxed by the sequential, shared
+ * memory and distributed memory versions: 5 and 9-point Laplacians, per cell
+ * coefficients and source terms.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "real.h"
+#include "stencil_operator.h"
+#include "stencil_kernel.h"
+
+// let the compiler vectorise the loops of the kernels, largest differences
+// included (they are never NaN nor -0), without fused multiply-adds (see
+// stencil_kernel.c)
+#pragma GCC optimize ("tree-vectorize", "fp-contract=off", "finite-math-only", \
+	"no-signed-zeros")
+
+
+/*
+ * Returns the harmonic mean of the coefficients of 2 neighbours.
+ */
+static inline real harmonic_mean(real a, real b) {
+	return 2 * a * b / (a + b);
+}
+
+
+/*
+ * Returns the value at row[j] given by an operator of the given points, with
+ * or without coefficients (rows of coefficients around the row, above it and
+ * below it), b being the source term added to the neighbours. points and
+ * coefficients are constants in every kernel.
+ */
+static inline __attribute__((always_inline)) real operator_value(
+	const real* up, const real* row, const real* down,
+	real* const* coefficients, real b, int j, const int points,
+	const int with_coefficients) {
+	real k, north, south, west, east;
+
+	if (with_coefficients) {
+		k = coefficients[1][j];
+		north = harmonic_mean(k, coefficients[0][j]);
+		south = harmonic_mean(k, coefficients[2][j]);
+		west = harmonic_mean(k, coefficients[1][j-1]);
+		east = harmonic_mean(k, coefficients[1][j+1]);
+		return (north * up[j] + south * down[j] + west * row[j-1] +
+			east * row[j+1] + b) / (north + south + west + east);
+	}
+	if (points == 9) {
+		return (4 * (row[j-1] + row[j+1] + up[j] + down[j]) + up[j-1] +
+			up[j+1] + down[j-1] + down[j+1] + b) / 20;
+	}
+	return (row[j-1] + row[j+1] + up[j] + down[j] + b) / 4;
+}
+
+
+/*
+ * Relaxes values 1 to length - 2 of a row with the Jacobi method and the
+ * given operator, writing the new values to new_row (see stencil_row).
+ * Returns the largest difference between an old and a new value.
+ */
+static inline __attribute__((always_inline)) double operator_row_body(
+	const struct stencil_operator* op, const real* up, const real* row,
+	const real* down, real* const* coefficients, real* new_row, int length,
+	const int points, const int with_coefficients) {
+	const real b = op->scaled_source;
+	real max_diff = 0.0;
+	real new_value, difference;
+	int j;
+
+	// rows never overlap the new row
+#pragma GCC ivdep
+	for (j = 1; j < length - 1; j++) {
+		new_value = operator_value(up, row, down, coefficients, b, j, points,
+			with_coefficients);
+		new_row[j] = new_value;
+		difference = (real)fabs(row[j] - new_value);
+		max_diff = difference > max_diff ? difference : max_diff;
+	}
+	return max_diff;
+}
+
+
+/*
+ * Relaxes values first, first + 2, ... of a row in place with the given
+ * operator, over-relaxed by w (see stencil_row_colour).
+ * Returns the largest difference between an old and a new value.
+ */
+static inline __attribute__((always_inline)) double operator_row_colour_body(
+	const struct stencil_operator* op, const real* up, real* row,
+	const real* down, real* const* coefficients, int length, int first,
+	double w, const int points, const int with_coefficients) {
+	const real b = op->scaled_source;
+	const real omega = (real)w;
+	const real keep = (real)(1 - w);
+	real max_diff = 0.0;
+	real new_value, difference;
+	int j;
+
+	for (j = first; j < length - 1; j += 2) {
+		new_value = keep * row[j] + omega * operator_value(up, row, down,
+			coefficients, b, j, points, with_coefficients);
+		difference = (real)fabs(row[j] - new_value);
+		max_diff = difference > max_diff ? difference : max_diff;
+		row[j] = new_value;
+	}
+	return max_diff;
+}
+
+
+/*
+ * Kernels of each operator. The plain Laplace equation goes to the stencil
+ * kernels, and the 9-point Laplacian has no red-black kernel, as the corners
+ * of a value are of its own colour.
+ */
+static double laplace_row(const struct stencil_operator* op, const real* up,
+	const real* row, const real* down, real* const* coefficients,
+	real* new_row, int length) {
+	(void)op;
+	(void)coefficients;
+	return stencil_row(up, row, down, new_row, length);
+}
+
+
+static double laplace_row_colour(const struct stencil_operator* op,
+	const real* up, real* row, const real* down, real* const* coefficients,
+	int length, int first, double w) {
+	(void)op;
+	(void)coefficients;
+	return stencil_row_colour(up, row, down, NULL, length, first, w);
+}
+
+
+static double source_row(const struct stencil_operator* op, const real* up,
+	const real* row, const real* down, real* const* coefficients,
+	real* new_row, int length) {
+	return operator_row_body(op, up, row, down, coefficients, new_row, length,
+		5, 0);
+}
+
+
+static double source_row_colour(const struct stencil_operator* op,
+	const real* up, real* row, const real* down, real* const* coefficients,
+	int length, int first, double w) {
+	return operator_row_colour_body(op, up, row, down, coefficients, length,
+		first, w, 5, 0);
+}
+
+
+static double nine_point_row(const struct stencil_operator* op,
+	const real* up, const real* row, const real* down,
+	real* const* coefficients, real* new_row, int length) {
+	return operator_row_body(op, up, row, down, coefficients, new_row, length,
+		9, 0);
+}
+
+
+static double coefficient_row(const struct stencil_operator* op,
+	const real* up, const real* row, const real* down,
+	real* const* coefficients, real* new_row, int length) {
+	return operator_row_body(op, up, row, down, coefficients, new_row, length,
+		5, 1);
+}
+
+
+static double coefficient_row_colour(const struct stencil_operator* op,
+	const real* up, real* row, const real* down, real* const* coefficients,
+	int length, int first, double w) {
+	return operator_row_colour_body(op, up, row, down, coefficients, length,
+		first, w, 5, 1);
+}
+
+
+/*
+ * Describes the operator of the given points (5 or 9), coefficient of the
+ * inclusion (1 for uniform coefficients) and source term, relaxing a square
+ * array of the given dimension, and picks its kernels. Coefficients only
+ * come with 5 points.
+ */
+void initialise_stencil_operator(struct stencil_operator* op, int points,
+	double contrast, double source, int dimension) {
+	double h = 1.0 / (double)(dimension - 1);
+
+	if (points == 9 && contrast != 1.0) {
+		fprintf(stderr, "WARNING: -coef only supports the 5-point stencil. "
+			"Using -stencil 5 as default value.\n");
+		points = 5;
+	}
+	op->points = points;
+	op->coefficients = contrast != 1.0;
+	op->contrast = contrast;
+	op->source = source;
+	op->scaled_source = (real)((points == 9 ? 6 : 1) * h * h * source);
+	op->dimension = dimension;
+
+	if (op->coefficients) {
+		op->row_kernel = coefficient_row;
+		op->row_colour_kernel = coefficient_row_colour;
+		snprintf(op->name, sizeof(op->name), "5-point, coefficients 1 and %g, "
+			"source %g", contrast, source);
+	} else if (points == 9) {
+		op->row_kernel = nine_point_row;
+		op->row_colour_kernel = NULL;
+		snprintf(op->name, sizeof(op->name), "9-point, source %g", source);
+	} else if (source != 0.0) {
+		op->row_kernel = source_row;
+		op->row_colour_kernel = source_row_colour;
+		snprintf(op->name, sizeof(op->name), "5-point, source %g", source);
+	} else {
+		op->row_kernel = laplace_row;
+		op->row_colour_kernel = laplace_row_colour;
+		snprintf(op->name, sizeof(op->name), "5-point");
+	}
+}
+
+
+/*
+ * Returns 1 if the operator is the plain Laplace equation relaxed by the
+ * stencil kernels (and by every mode), 0 otherwise.
+ */
+int is_plain_laplacian(const struct stencil_operator* op) {
+	return op->row_kernel == laplace_row;
+}
+
+
+/*
+ * Fills values, a num_rows x num_cols part of the coefficients of the square
+ * array stored row by row (rows being pitch values apart), with the
+ * coefficients starting at row first_row and column first_col.
+ */
+void initialise_coefficients(const struct stencil_operator* op, real* values,
+	int pitch, int first_row, int first_col, int num_rows, int num_cols) {
+	int low = op->dimension / 4;
+	int high = op->dimension - op->dimension / 4;
+	int i, j, row, col;
+
+	for (i = 0; i < num_rows; i++) {
+		for (j = 0; j < num_cols; j++) {
+			row = first_row + i;
+			col = first_col + j;
+			values[(size_t)i * (size_t)pitch + (size_t)j] = (real)(
+				row >= low && row < high && col >= low && col < high ?
+				op->contrast : 1.0);
+		}
+	}
+}
+
+
+/*
+ * Relaxes the rows first_row to end_row (excluded) of length values with the
+ * Jacobi method and the operator, reading rows and writing new_rows (which
+ * point to each row of the values and of the new values). coefficients
+ * points to each row of the coefficients (NULL without coefficients).
+ * Returns the largest difference between an old and a new value.
+ */
+double operator_rows(const struct stencil_operator* op, real* const* rows,
+	real* const* new_rows, real* const* coefficients, int first_row,
+	int end_row, int length) {
+	double max_diff = 0.0;
+	double difference;
+	int i;
+
+	for (i = first_row; i < end_row; i++) {
+		difference = op->row_kernel(op, rows[i-1], rows[i], rows[i+1],
+			coefficients != NULL ? &coefficients[i-1] : NULL, new_rows[i],
+			length);
+		if (difference > max_diff) {
+			max_diff = difference;
+		}
+	}
+	return max_diff;
+}
+
+
+/*
+ * Relaxes the values of the given colour of the rows first_row to end_row
+ * (excluded) of length values in place with the operator, over-relaxed by w
+ * (not with 9 points). Cells are coloured like a chess board using their
+ * position in the full square array, start_row being the index of the first
+ * row in it (red cells, colour 0, have an even row + column index).
+ * coefficients is the same as for operator_rows.
+ * Returns the largest difference between an old and a new value.
+ */
+double operator_rows_colour(const struct stencil_operator* op,
+	real* const* rows, real* const* coefficients, int first_row, int end_row,
+	int length, int start_row, int colour, double w) {
+	double max_diff = 0.0;
+	double difference;
+	int i;
+
+	for (i = first_row; i < end_row; i++) {
+		difference = op->row_colour_kernel(op, rows[i-1], rows[i], rows[i+1],
+			coefficients != NULL ? &coefficients[i-1] : NULL, length,
+			1 + (start_row + i + 1 + colour) % 2, w);
+		if (difference > max_diff) {
+			max_diff = difference;
+		}
+	}
+	return max_diff;
+}
+
@@ -0,0 +1,62 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Header file for the stencil operators relaxed by the sequential, shared
+ * memory and distributed memory versions: 5 and 9-point Laplacians, per cell
+ * coefficients and source terms.
+ */
+
+
+struct stencil_operator {
+	// structure used to describe the equation relaxed and its kernels
+	int points;				// 5 or 9-point Laplacian
+	int coefficients;		// coefficients vary from cell to cell
+	double contrast;		// coefficient of the inclusion (1 if uniform)
+	double source;			// source term f of the Poisson equation
+	real scaled_source;		// source term as added to the neighbours
+	int dimension;			// dimension of the square array
+	char name[80];			// description printed with the results
+	double (*row_kernel)(const struct stencil_operator*, const real*,
+		const real*, const real*, real* const*, real*, int);
+	double (*row_colour_kernel)(const struct stencil_operator*, const real*,
+		real*, const real*, real* const*, int, int, double);
+};
+
+
+void initialise_stencil_operator(struct stencil_operator* op,
+								 int points,
+								 double contrast,
+								 double source,
+								 int dimension);
+
+
+int is_plain_laplacian(const struct stencil_operator* op);
+
+
+void initialise_coefficients(const struct stencil_operator* op,
+							 real* values,
+							 int pitch,
+							 int first_row,
+							 int first_col,
+							 int num_rows,
+							 int num_cols);
+
+
+double operator_rows(const struct stencil_operator* op,
+					 real* const* rows,
+					 real* const* new_rows,
+					 real* const* coefficients,
+					 int first_row,
+					 int end_row,
+					 int length);
+
+
+double operator_rows_colour(const struct stencil_operator* op,
+							real* const* rows,
+							real* const* coefficients,
+							int first_row,
+							int end_row,
+							int length,
+							int start_row,
+							int colour,
+							double w);
@@ -0,0 +1,124 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Source file for the volume holding the planes of a cube (or of the part of
+ * it held by a process), used by the shared memory and distributed memory
+ * versions.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "real.h"
+#include "volume.h"
+#include "grid.h"
+
+#define CACHE_LINE 64
+#define VALUES_PER_LINE ((int)(CACHE_LINE / sizeof(real)))
+
+
+/*
+ * Returns the number of values from the start of a plane of num_rows rows a
+ * pitch apart to the start of the next one: enough cache lines for the rows,
+ * and an odd number of them so that neighbouring planes never map to the same
+ * cache sets.
+ */
+int volume_plane_pitch(int num_rows, int pitch) {
+	int lines = num_rows * (pitch / VALUES_PER_LINE);
+
+	if (lines % 2 == 0) {
+		lines++;
+	}
+	return lines * VALUES_PER_LINE;
+}
+
+
+/*
+ * Allocates a volume of num_planes planes of num_rows rows of num_cols values,
+ * boundary or halo values included, and a second buffer if num_buffers is 2.
+ * The values are not initialised, so that they are placed in memory by the
+ * first thread writing them.
+ */
+struct volume* allocate_volume(int num_planes, int num_rows, int num_cols,
+	int num_buffers) {
+	struct volume *v = malloc(sizeof(struct volume));
+	size_t buffer_size;
+	void *memory;
+
+	if (v == NULL) {
+		fprintf(stderr, "Failed to allocate space for the array.\n");
+		exit(EXIT_FAILURE);
+	}
+	v->num_planes = num_planes;
+	v->num_rows = num_rows;
+	v->num_cols = num_cols;
+	v->pitch = grid_pitch(num_cols);
+	v->plane_pitch = volume_plane_pitch(num_rows, v->pitch);
+	v->num_buffers = num_buffers;
+
+	// one more cache line per buffer for the shift of the rows
+	buffer_size = (size_t)num_planes * (size_t)v->plane_pitch + VALUES_PER_LINE;
+	if (posix_memalign(&memory, CACHE_LINE, (size_t)num_buffers * buffer_size * sizeof(real)) != 0) {
+		fprintf(stderr, "Failed to allocate space for the array.\n");
+		exit(EXIT_FAILURE);
+	}
+	v->memory = memory;
+
+	v->values = &v->memory[VALUES_PER_LINE - 1];
+	v->next_values = NULL;
+	if (num_buffers == 2) {
+		v->next_values = &v->memory[buffer_size + VALUES_PER_LINE - 1];
+	}
+	return v;
+}
+
+
+/*
+ * Sets the values of planes first_plane to end_plane (excluded) of every
+ * buffer to 0, padding included.
+ */
+void clear_volume_planes(struct volume* v, int first_plane, int end_plane) {
+	size_t start = (size_t)first_plane * (size_t)v->plane_pitch;
+	size_t length = (size_t)(end_plane - first_plane) * (size_t)v->plane_pitch * sizeof(real);
+
+	if (end_plane <= first_plane) {
+		return;
+	}
+	memset(&v->values[start], 0, length);
+	if (v->next_values != NULL) {
+		memset(&v->next_values[start], 0, length);
+	}
+}
+
+
+/*
+ * Copies every value of the buffer into the second buffer, so that both hold
+ * the boundary values, which are never relaxed.
+ */
+void copy_volume_buffer(struct volume* v) {
+	memcpy(v->next_values, v->values,
+		(size_t)v->num_planes * (size_t)v->plane_pitch * sizeof(real));
+}
+
+
+/*
+ * Swaps the buffer and the second buffer, once the values relaxed into the
+ * second buffer become the current values.
+ */
+void swap_volume_buffers(struct volume* v) {
+	real *temp_values = v->values;
+
+	v->values = v->next_values;
+	v->next_values = temp_values;
+}
+
+
+/*
+ * Frees the buffers and the structure of the volume.
+ */
+void free_volume(struct volume* v) {
+	free(v->memory);
+	free(v);
+}
@@ -0,0 +1,42 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Header file for the volume holding the planes of a cube (or of the part of
+ * it held by a process), used by the shared memory and distributed memory
+ * versions.
+ */
+
+
+struct volume {
+	// structure used to keep track of the planes of a volume and its buffers
+	int num_planes;			// number of planes, boundary or halo planes included
+	int num_rows;			// number of rows of each plane, same for the rows
+	int num_cols;			// number of values of each row, same for the values
+	int pitch;				// values from the start of a row to the next one
+	int plane_pitch;		// values from the start of a plane to the next one
+	int num_buffers;		// 1, or 2 for a second buffer to relax into
+	real *values;			// first value of the first plane of the buffer
+	real *next_values;		// same for the second buffer (NULL if none)
+	real *memory;			// aligned allocation holding every buffer
+};
+
+
+int volume_plane_pitch(int num_rows, int pitch);
+
+
+struct volume* allocate_volume(int num_planes,
+							   int num_rows,
+							   int num_cols,
+							   int num_buffers);
+
+
+void clear_volume_planes(struct volume* v, int first_plane, int end_plane);
+
+
+void copy_volume_buffer(struct volume* v);
+
+
+void swap_volume_buffers(struct volume* v);
+
+
+void free_volume(struct volume* v);
@@ -0,0 +1,156 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Source file for the 7-point sweeps used by the shared memory and
+ * distributed memory versions to relax planes of a cube.
+ */
+
+#include <stddef.h>
+#include <math.h>
+#include "real.h"
+#include "volume.h"
+#include "volume_sweep.h"
+
+// let the compiler vectorise the loops of the row kernels, largest
+// differences included (they are never NaN nor -0), without fused
+// multiply-adds (see stencil_kernel.c)
+#pragma GCC optimize ("tree-vectorize", "fp-contract=off", "finite-math-only", \
+	"no-signed-zeros")
+
+#define TILE_CACHE (256 * 1024)	// bytes of the planes of a tile kept in cache
+
+
+/*
+ * Returns the number of rows of the tiles relaxed by a sweep of a volume,
+ * given the number of planes of a tile in cache at once (3 read by red-black
+ * sweeps, and 1 more written by jacobi sweeps), the rows above and below the
+ * tile being read too.
+ */
+int volume_tile_rows(const struct volume* v, int planes) {
+	int rows = TILE_CACHE / (planes * v->pitch * (int)sizeof(real)) - 2;
+
+	return rows > 1 ? rows : 1;
+}
+
+
+/*
+ * Relaxes values 1 to length - 2 of a row with the Jacobi method, from the
+ * rows around it in its plane (north and south) and in the planes before and
+ * after it (above and below), writing the new values to new_row.
+ * Returns the largest difference between an old and a new value.
+ */
+static double jacobi_row(const real* north, const real* row,
+	const real* south, const real* above, const real* below, real* new_row,
+	int length) {
+	real max_diff = 0.0;
+	real new_value, difference;
+	int j;
+
+	// rows never overlap the new row
+#pragma GCC ivdep
+	for (j = 1; j < length - 1; j++) {
+		new_value = (row[j-1] + row[j+1] + north[j] + south[j] + above[j] +
+			below[j]) / 6;
+		new_row[j] = new_value;
+		difference = (real)fabs(row[j] - new_value);
+		max_diff = difference > max_diff ? difference : max_diff;
+	}
+	return max_diff;
+}
+
+
+/*
+ * Relaxes values first, first + 2, ... of a row in place, over-relaxed by w,
+ * from the same rows as jacobi_row.
+ * Returns the largest difference between an old and a new value.
+ */
+static double colour_row(const real* north, real* row, const real* south,
+	const real* above, const real* below, int length, int first, double w) {
+	const real omega = (real)w;
+	const real keep = (real)(1 - w);
+	real max_diff = 0.0;
+	real new_value, difference;
+	int j;
+
+	for (j = first; j < length - 1; j += 2) {
+		new_value = keep * row[j] + omega * ((row[j-1] + row[j+1] + north[j] +
+			south[j] + above[j] + below[j]) / 6);
+		difference = (real)fabs(row[j] - new_value);
+		max_diff = difference > max_diff ? difference : max_diff;
+		row[j] = new_value;
+	}
+	return max_diff;
+}
+
+
+/*
+ * Relaxes the planes first_plane to end_plane (excluded) of a volume with the
+ * Jacobi method, reading values (a buffer of the volume) and writing
+ * new_values (the other buffer), by tiles of rows (every row of a plane but
+ * its first and last, which are boundary or halo rows).
+ * Returns the largest difference between an old and a new value.
+ */
+double volume_jacobi_sweep(const struct volume* v, const real* values,
+	real* new_values, int first_plane, int end_plane) {
+	const size_t pitch = (size_t)v->pitch;
+	const size_t plane_pitch = (size_t)v->plane_pitch;
+	int tile_rows = volume_tile_rows(v, 4);
+	double max_diff = 0.0;
+	double difference;
+	int tile, end_row, k, i;
+
+	for (tile = 1; tile < v->num_rows - 1; tile += tile_rows) {
+		end_row = tile + tile_rows < v->num_rows - 1 ? tile + tile_rows :
+			v->num_rows - 1;
+		for (k = first_plane; k < end_plane; k++) {
+			for (i = tile; i < end_row; i++) {
+				const real *row = &values[(size_t)k * plane_pitch + (size_t)i * pitch];
+
+				difference = jacobi_row(row - pitch, row, row + pitch,
+					row - plane_pitch, row + plane_pitch,
+					&new_values[(size_t)k * plane_pitch + (size_t)i * pitch],
+					v->num_cols);
+				if (difference > max_diff) {
+					max_diff = difference;
+				}
+			}
+		}
+	}
+	return max_diff;
+}
+
+
+/*
+ * Relaxes the values of the given colour of the planes first_plane to
+ * end_plane (excluded) of a volume in place, over-relaxed by w, by tiles of
+ * rows. start_index is the plane + row + column index in the cube of the
+ * first value of the volume, whose parity decides the colour of the values.
+ * Returns the largest difference between an old and a new value.
+ */
+double volume_colour_sweep(const struct volume* v, real* values,
+	int first_plane, int end_plane, int start_index, int colour, double w) {
+	const size_t pitch = (size_t)v->pitch;
+	const size_t plane_pitch = (size_t)v->plane_pitch;
+	int tile_rows = volume_tile_rows(v, 3);
+	double max_diff = 0.0;
+	double difference;
+	int tile, end_row, k, i;
+
+	for (tile = 1; tile < v->num_rows - 1; tile += tile_rows) {
+		end_row = tile + tile_rows < v->num_rows - 1 ? tile + tile_rows :
+			v->num_rows - 1;
+		for (k = first_plane; k < end_plane; k++) {
+			for (i = tile; i < end_row; i++) {
+				real *row = &values[(size_t)k * plane_pitch + (size_t)i * pitch];
+
+				difference = colour_row(row - pitch, row, row + pitch,
+					row - plane_pitch, row + plane_pitch, v->num_cols,
+					1 + (start_index + k + i + 1 + colour) % 2, w);
+				if (difference > max_diff) {
+					max_diff = difference;
+				}
+			}
+		}
+	}
+	return max_diff;
+}
@@ -0,0 +1,25 @@
+/**
+ * CM30225 Parallel Computing
+ *
+ * Header file for the 7-point sweeps used by the shared memory and
+ * distributed memory versions to relax planes of a cube.
+ */
+
+
+int volume_tile_rows(const struct volume* v, int planes);
+
+
+double volume_jacobi_sweep(const struct volume* v,
+						   const real* values,
+						   real* new_values,
+						   int first_plane,
+						   int end_plane);
+
+
+double volume_colour_sweep(const struct volume* v,
+						   real* values,
+						   int first_plane,
+						   int end_plane,
+						   int start_index,
+						   int colour,
+						   double w);
@@ -0,0 +1,121 @@
+/**
+ * CM30225 Parallel Computing
+ * 
+ * Source file for the wavefront used by the shared memory and distributed 
+ * memory versions to run several Jacobi sweeps over rows while they are in 
+ * cache.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "real.h"
+#include "wavefront.h"
+#include "stencil_kernel.h"
+
+
+/*
+ * Allocates the scratch buffer holding the rows of the intermediate sweeps of
+ * a wavefront of the given number of sweeps, over rows of the given length.
+ */
+real* initialise_wavefront_scratch(int length, int sweeps) {
+	size_t num_rows = sweeps > 1 ? 3 * (size_t)(sweeps - 1) : 1;
+	real *scratch = malloc(num_rows * (size_t)length * sizeof(real));
+	if (scratch == NULL) {
+		fprintf(stderr, "Error: wavefront scratch memory could not be "
+			"allocated.\n");
+		exit(EXIT_FAILURE);
+	}
+	return scratch;
+}
+
+
+/*
+ * Returns row i of the array after the given sweep. Values before the first 
+ * sweep, and the values of the lowest and highest rows (which are never 
+ * relaxed) are read from the array, intermediate sweeps from the scratch 
+ * buffer.
+ */
+static real* sweep_row(real* const* rows, real* scratch, int length, 
+	int sweep, int i, int lowest_row, int highest_row) {
+	if (sweep == 0 || i == lowest_row || i == highest_row) {
+		return rows[i];
+	}
+	return &scratch[((size_t)(sweep - 1) * 3 + (size_t)(i % 3)) * 
+		(size_t)length];
+}
+
+
+/*
+ * Runs the given number of Jacobi sweeps over rows, writing the values of the
+ * rows first_row to end_row (excluded) after the last sweep to new_rows.
+ * rows holds the values before the first sweep of the rows lowest_row to 
+ * highest_row, which are only read from. The lowest and highest rows are never
+ * relaxed: they are either boundaries of the array, or rows deep enough 
+ * around first_row and end_row to compute the last sweep without anything 
+ * else (as many rows as there are sweeps on each side), the values of the 
+ * rows in between after each sweep being computed again from them. This lets 
+ * threads and processes relax their own rows for several sweeps without 
+ * waiting for each other between sweeps.
+ * Each row is relaxed by the stencil kernel, so the values are the same as 
+ * the ones of the same number of jacobi sweeps.
+ * Returns the largest difference between the values before and after the last
+ * sweep, in the rows first_row to end_row (excluded).
+ */
+double wavefront_sweeps(real* const* rows, real* const* new_rows, 
+	int first_row, int end_row, int lowest_row, int highest_row, int length, 
+	int sweeps, real* scratch) {
+	double max_diff = 0.0;
+	double difference;
+	real *new_row;
+	int front, sweep, i, first_sweep_row, last_sweep_row;
+
+	// the first sweep relaxes every row but the lowest and highest ones, the 
+	// front then moves down until the last sweep reaches the last row
+	for (front = lowest_row + 1; front < highest_row + sweeps - 1; front++) {
+		for (sweep = 1; sweep <= sweeps; sweep++) {
+			// row relaxed by this sweep, one row behind the previous sweep
+			i = front - (sweep - 1);
+
+			// every sweep relaxes one row less on each side than the previous
+			first_sweep_row = first_row - (sweeps - sweep);
+			if (first_sweep_row <= lowest_row) {
+				first_sweep_row = lowest_row + 1;
+			}
+			last_sweep_row = end_row - 1 + (sweeps - sweep);
+			if (last_sweep_row >= highest_row) {
+				last_sweep_row = highest_row - 1;
+			}
+			if (i < first_sweep_row || i > last_sweep_row) {
+				continue;
+			}
+
+			// the last sweep writes to the new rows, the others to the scratch
+			// buffer, which is given the boundary values of the row
+			if (sweep == sweeps) {
+				new_row = new_rows[i];
+			} else {
+				new_row = sweep_row(rows, scratch, length, sweep, i, 
+					lowest_row, highest_row);
+				new_row[0] = rows[i][0];
+				new_row[length - 1] = rows[i][length - 1];
+			}
+
+			// average the 4 surrounding values of the whole row at once
+			difference = stencil_row(
+				sweep_row(rows, scratch, length, sweep - 1, i - 1, lowest_row, 
+					highest_row), 
+				sweep_row(rows, scratch, length, sweep - 1, i, lowest_row, 
+					highest_row), 
+				sweep_row(rows, scratch, length, sweep - 1, i + 1, lowest_row, 
+					highest_row), 
+				new_row, length);
+			
+			// only the last sweep decides convergence
+			if (sweep == sweeps && difference > max_diff) {
+				max_diff = difference;
+			}
+		}
+	}
+
+	return max_diff;
+}
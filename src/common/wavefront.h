@@ -0,0 +1,21 @@
+/**
+ * CM30225 Parallel Computing
+ * 
+ * Header file for the wavefront used by the shared memory and distributed 
+ * memory versions to run several Jacobi sweeps over rows while they are in 
+ * cache.
+ */
+
+
+real* initialise_wavefront_scratch(int length, int sweeps);
+
+
+double wavefront_sweeps(real* const* rows, 
+						real* const* new_rows, 
+						int first_row, 
+						int end_row, 
+						int lowest_row, 
+						int highest_row, 
+						int length, 
+						int sweeps, 
+						real* scratch);
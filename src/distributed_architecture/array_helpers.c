@@ -10,32 +10,26 @@
  
 #include <stdio.h>
 #include <stdlib.h>
+#include "real.h"
 #include "array_helpers.h"
-
-#define SEED 1000
+#include "initial_grid.h"
 
 
 /*
  * Initialises a square array by creating an 1D array of doubles while keeping 
  * track of rows.
- * Populates it with random doubles ranging from 1.0 to 100.0.
+ * Populates it with the random initial values of the square array.
  */
-double* initialise_square_array(int dim) {
-	srand(SEED);
+real* initialise_square_array(int dim) {
 	long unsigned int dimension = (long unsigned int) dim;
-	double *sq_array;
-	int i, j;
+	real *sq_array;
 
 	// allocate space for a 1D array of double pointers.
-	sq_array = malloc(dimension * dimension * sizeof(double));
+	sq_array = malloc(dimension * dimension * sizeof(real));
 	check_double_malloc(sq_array);
 
 	// populate the array with random doubles
-	for (i = 0; i < dim; i++) {
-		for (j = 0; j < dim; j++) {
-			sq_array[i * dim + j] = (double)(rand() % 10);
-		}
-	}
+	initialise_grid_values(sq_array, dim, 0, 0, dim, dim);
 
 	return sq_array;
 }
@@ -45,12 +39,25 @@ double* initialise_square_array(int dim) {
  * Initialises (doesn't populate) an non-square array of dimensions X times Y = 
  * num_elements, by creating an 1D array of doubles while keeping track of rows.
  */
-double* create_new_array(int num_elements) {
+real* create_new_array(int num_elements) {
 	long unsigned int elemenents = (long unsigned int) num_elements;
-	double *array;
+	real *array;
  
 	// allocate space for a 1D array of double pointers.
-	array = malloc(elemenents * sizeof(double));
+	array = malloc(elemenents * sizeof(real));
+	check_double_malloc(array);
+	
+	return array;
+}
+
+
+/*
+ * Creates a 1D array of doubles of size num_elements filled with zeros.
+ */
+real* create_zero_array(int num_elements) {
+	real *array;
+ 
+	array = calloc((long unsigned int) num_elements, sizeof(real));
 	check_double_malloc(array);
 	
 	return array;
@@ -60,14 +67,15 @@ double* create_new_array(int num_elements) {
 
 /*
  * Updates the appropriate values in the square array's rows given the updates 
- * chunk.
+ * chunk, whose rows are chunk_pitch values apart.
  */
-double* stitch_array(double* sq_array, double* chunk_array, int start_row, int end_row, int dim){
+real* stitch_array(real* sq_array, real* chunk_array, int start_row, int end_row, int dim, 
+	int chunk_pitch){
 	int i, j;
 	
 	for (i = start_row + 1; i < end_row; i++) {
 		for (j = 1; j < dim - 1; j++) {
-			sq_array[i*dim+j] = chunk_array[(i-start_row) * dim + j];
+			sq_array[i*dim+j] = chunk_array[(i-start_row) * chunk_pitch + j];
 		}
 	}
 	
@@ -80,7 +88,7 @@ double* stitch_array(double* sq_array, double* chunk_array, int start_row, int e
  * square array of doubles.
  * If not, exit the program with a failure.
  */
-void check_double_malloc(double* square_array) {
+void check_double_malloc(real* square_array) {
 	if (square_array == NULL) {
 		fprintf(stderr, "Failed to allocate space for the array.\n");
 		exit(EXIT_FAILURE);
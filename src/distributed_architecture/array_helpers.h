@@ -9,13 +9,17 @@
  */
  
  
- void check_double_malloc(double* square_array);
+ void check_double_malloc(real* square_array);
  
  
- double* initialise_square_array(int dim);
+ real* initialise_square_array(int dim);
  
  
- double* create_new_array(int num_elements);
+ real* create_new_array(int num_elements);
+ 
+ 
+ real* create_zero_array(int num_elements);
   
  
- double* stitch_array(double* sq_array, double* chunk_array, int start, int end, int dimension);
\ No newline at end of file
+ real* stitch_array(real* sq_array, real* chunk_array, int start, int end, int dimension, 
+ 					 int chunk_pitch);
\ No newline at end of file
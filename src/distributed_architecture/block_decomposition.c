@@ -0,0 +1,187 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ *
+ * Source file for the decomposition of the square array into a 2D grid of
+ * blocks relaxed by children processes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+#include "real.h"
+#include "block_decomposition.h"
+#include "grid.h"
+
+#define SEND_TAG 1001
+#define RECV_TAG 1002
+#define ROOT_PROCESS_ID 0
+
+
+/*
+ * Finds how many blocks down and across the array to split it into for the
+ * given number of children processes, as close to square as possible.
+ * Returns 0 if the blocks don't fit in the array (more blocks down or across
+ * than there are rows or columns to relax), 1 otherwise.
+ */
+int block_grid_dims(int num_children, int dimension, int dims[2]) {
+	dims[0] = 0;
+	dims[1] = 0;
+	MPI_Dims_create(num_children, 2, dims);
+	return dims[0] <= dimension - 2 && dims[1] <= dimension - 2;
+}
+
+
+/*
+ * Finds the band of values (rows or columns) that are not boundaries of the
+ * array held by the part number index of num_parts: they are split into
+ * contiguous bands, the first parts getting one extra value each if they
+ * can't be split evenly. The band goes from start to end (excluded).
+ */
+static void band_of_values(int dimension, int index, int num_parts,
+	int* start, int* end) {
+	int height = (dimension - 2) / num_parts;
+	int extra = (dimension - 2) % num_parts;
+	*start = 1 + index * height + (index < extra ? index : extra);
+	*end = *start + height + (index < extra ? 1 : 0);
+}
+
+
+/*
+ * Finds the rows and columns of the square array (ends excluded) relaxed by
+ * the child process number child_index (0-based) in a grid of dims blocks.
+ */
+void block_of_child(int dimension, const int dims[2], int child_index,
+	int* start_row, int* end_row, int* start_col, int* end_col) {
+	band_of_values(dimension, child_index / dims[1], dims[0], start_row, end_row);
+	band_of_values(dimension, child_index % dims[1], dims[1], start_col, end_col);
+}
+
+
+/*
+ * Creates the cartesian communicator of the children processes (without
+ * reordering them, so that their rank matches the block the root process
+ * gathers from them) and finds the block and neighbours of this child process.
+ */
+struct block_decomposition* initialise_block_decomposition(int dimension,
+	const int dims[2], MPI_Comm comm) {
+	struct block_decomposition *bd = malloc(sizeof(struct block_decomposition));
+	int periods[2] = {0, 0};
+	int cart_rank;
+
+	bd->dims[0] = dims[0];
+	bd->dims[1] = dims[1];
+	MPI_Cart_create(comm, 2, bd->dims, periods, 0, &bd->cart_comm);
+	MPI_Comm_rank(bd->cart_comm, &cart_rank);
+	MPI_Cart_coords(bd->cart_comm, cart_rank, 2, bd->coords);
+	MPI_Cart_shift(bd->cart_comm, 0, 1, &bd->north, &bd->south);
+	MPI_Cart_shift(bd->cart_comm, 1, 1, &bd->west, &bd->east);
+
+	block_of_child(dimension, dims, cart_rank, &bd->start_row, &bd->end_row,
+		&bd->start_col, &bd->end_col);
+	bd->num_rows = bd->end_row - bd->start_row + 2;
+	bd->num_cols = bd->end_col - bd->start_col + 2;
+	bd->pitch = grid_pitch(bd->num_cols);
+
+	// a column and the relaxed values of the block, skipping the halo values
+	MPI_Type_vector(bd->num_rows - 2, 1, bd->pitch, REAL_MPI_TYPE, &bd->column_type);
+	MPI_Type_commit(&bd->column_type);
+	MPI_Type_vector(bd->num_rows - 2, bd->num_cols - 2, bd->pitch, REAL_MPI_TYPE, &bd->interior_type);
+	MPI_Type_commit(&bd->interior_type);
+
+	return bd;
+}
+
+
+/*
+ * Sends the first and last rows and columns a child process relaxes to the
+ * children processes north, south, west and east of it, and receives theirs in
+ * the halo values around the block (which are only read from when relaxing).
+ * Children holding blocks at the boundaries of the array have no neighbour on
+ * that side (MPI_PROC_NULL), in which case nothing is sent or received.
+ */
+void exchange_block_halos(struct block_decomposition* bd, real* sub_arr) {
+	MPI_Request requests[4];
+	int rows = bd->num_rows;
+	int cols = bd->num_cols;
+	int pitch = bd->pitch;
+
+	// send first and last rows north and south, first and last columns west and east
+	MPI_Isend(&sub_arr[pitch + 1], cols - 2, REAL_MPI_TYPE, bd->north, SEND_TAG, bd->cart_comm, &requests[0]);
+	MPI_Isend(&sub_arr[(rows - 2) * pitch + 1], cols - 2, REAL_MPI_TYPE, bd->south, SEND_TAG, bd->cart_comm,
+		&requests[1]);
+	MPI_Isend(&sub_arr[pitch + 1], 1, bd->column_type, bd->west, SEND_TAG, bd->cart_comm, &requests[2]);
+	MPI_Isend(&sub_arr[pitch + cols - 2], 1, bd->column_type, bd->east, SEND_TAG, bd->cart_comm, &requests[3]);
+
+	// receive the neighbours' rows and columns in the halo values
+	MPI_Recv(&sub_arr[1], cols - 2, REAL_MPI_TYPE, bd->north, SEND_TAG, bd->cart_comm, MPI_STATUS_IGNORE);
+	MPI_Recv(&sub_arr[(rows - 1) * pitch + 1], cols - 2, REAL_MPI_TYPE, bd->south, SEND_TAG, bd->cart_comm,
+		MPI_STATUS_IGNORE);
+	MPI_Recv(&sub_arr[pitch], 1, bd->column_type, bd->west, SEND_TAG, bd->cart_comm, MPI_STATUS_IGNORE);
+	MPI_Recv(&sub_arr[pitch + cols - 1], 1, bd->column_type, bd->east, SEND_TAG, bd->cart_comm,
+		MPI_STATUS_IGNORE);
+
+	// the values that were sent will be overwritten by the next sweep
+	MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+}
+
+
+/*
+ * Sends the relaxed values of the block of this child process back to the
+ * root process, without the halo values, which other children relaxed.
+ */
+void send_block_back(struct block_decomposition* bd, real* sub_arr) {
+	MPI_Send(&sub_arr[bd->pitch + 1], 1, bd->interior_type, ROOT_PROCESS_ID, RECV_TAG, MPI_COMM_WORLD);
+}
+
+
+/*
+ * Copies the relaxed values of the block of the root process back into the
+ * square array, when the root process relaxes its share too.
+ */
+void store_block(struct block_decomposition* bd, const real* sub_arr,
+	real* square_array, int dimension) {
+	int i;
+
+	for (i = 1; i < bd->num_rows - 1; i++) {
+		memcpy(&square_array[(bd->start_row - 1 + i) * dimension + bd->start_col],
+			&sub_arr[i * bd->pitch + 1], (size_t)(bd->num_cols - 2) * sizeof(real));
+	}
+}
+
+
+/*
+ * Receives the relaxed values of the block of every child process (of world
+ * rank child + first_child_id) straight into the square array, except the
+ * root process' own block. Called by the root process.
+ */
+void gather_blocks(real* square_array, int dimension, const int dims[2],
+	int first_child_id) {
+	MPI_Datatype block_type;
+	int child, start_row, end_row, start_col, end_col;
+
+	for (child = 0; child < dims[0] * dims[1]; child++) {
+		if (child + first_child_id == ROOT_PROCESS_ID) {
+			continue;
+		}
+		block_of_child(dimension, dims, child, &start_row, &end_row, &start_col, &end_col);
+		MPI_Type_vector(end_row - start_row, end_col - start_col, dimension, REAL_MPI_TYPE, &block_type);
+		MPI_Type_commit(&block_type);
+		MPI_Recv(&square_array[start_row * dimension + start_col], 1, block_type, child + first_child_id,
+			RECV_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+		MPI_Type_free(&block_type);
+	}
+}
+
+
+/*
+ * Frees the cartesian communicator, datatypes and structure of the
+ * decomposition.
+ */
+void free_block_decomposition(struct block_decomposition* bd) {
+	MPI_Type_free(&bd->column_type);
+	MPI_Type_free(&bd->interior_type);
+	MPI_Comm_free(&bd->cart_comm);
+	free(bd);
+}
@@ -0,0 +1,53 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ * 
+ * Header file for the decomposition of the square array into a 2D grid of 
+ * blocks relaxed by children processes.
+ */
+
+
+struct block_decomposition {
+	// structure used by a child process to keep track of its block and neighbours
+	MPI_Comm cart_comm;			// cartesian communicator of the children processes
+	int dims[2];				// number of blocks down and across the array
+	int coords[2];				// row and column of this process' block
+	int north, south;			// processes holding the blocks above and below
+	int west, east;				// processes holding the blocks left and right
+								// (MPI_PROC_NULL at the boundaries)
+	int start_row, end_row;		// rows of the square array relaxed (end excluded)
+	int start_col, end_col;		// columns of the square array relaxed (end excluded)
+	int num_rows, num_cols;		// size of the block, including 1 halo value on each side
+	int pitch;					// values from the start of a row of the block to the next one
+	MPI_Datatype column_type;	// column of the block, without its halo values
+	MPI_Datatype interior_type;	// values of the block, without its halo values
+};
+
+
+int block_grid_dims(int num_children, int dimension, int dims[2]);
+
+
+void block_of_child(int dimension, const int dims[2], int child_index, 
+					int* start_row, int* end_row, int* start_col, int* end_col);
+
+
+struct block_decomposition* initialise_block_decomposition(int dimension, 
+														   const int dims[2], 
+														   MPI_Comm comm);
+
+
+void exchange_block_halos(struct block_decomposition* bd, real* sub_arr);
+
+
+void send_block_back(struct block_decomposition* bd, real* sub_arr);
+
+
+void store_block(struct block_decomposition* bd, const real* sub_arr, 
+				 real* square_array, int dimension);
+
+
+void gather_blocks(real* square_array, int dimension, const int dims[2], 
+				   int first_child_id);
+
+
+void free_block_decomposition(struct block_decomposition* bd);
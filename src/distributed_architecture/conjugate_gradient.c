@@ -0,0 +1,188 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ * 
+ * Source file for the preconditioned conjugate gradient solver run by children
+ * processes on their sub arrays.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <mpi.h>
+#include "real.h"
+#include "array_helpers.h"
+#include "relaxation_helpers.h"
+#include "conjugate_gradient.h"
+
+
+/*
+ * Relaxes the preconditioned values of the cells of the given colour (0: red,
+ * 1: black) of the process's own rows towards A z = r, from the preconditioned
+ * values of the other colour around them, or from 0 if from_zero is set. Row
+ * 0 of the sub array is row start_row of the square array.
+ */
+static void precondition_colour(struct conjugate_gradient* cg, int colour, int from_zero) {
+	real *z = cg->preconditioned;
+	real *r = cg->residuals;
+	int n = cg->dimension;
+	int pitch = cg->pitch;
+	int i, j;
+
+	for (i = 1; i < cg->num_rows - 1; i++) {
+		for (j = 1 + (cg->start_row + i + 1 + colour) % 2; j < n - 1; j += 2) {
+			if (from_zero) {
+				z[i * pitch + j] = r[i * pitch + j] / 4;
+			} else {
+				z[i * pitch + j] = (r[i * pitch + j] + z[i * pitch + j - 1] + z[i * pitch + j + 1] + 
+					z[(i - 1) * pitch + j] + z[(i + 1) * pitch + j]) / 4;
+			}
+		}
+	}
+}
+
+
+/*
+ * Applies the preconditioner to the residuals of the process's own rows and 
+ * sums r.z over all children processes.
+ * Returns the largest residual of the process's own rows divided by 4, which 
+ * is the largest change a Jacobi sweep would still make to a value, so that 
+ * the solver stops at the same precision as the relaxation modes.
+ */
+double precondition(struct conjugate_gradient* cg) {
+	int n = cg->dimension;
+	int pitch = cg->pitch;
+	double product = 0.0;
+	double max_residual = 0.0;
+	int i, j;
+
+	precondition_colour(cg, 0, 1);
+	exchange_boundary_rows(cg->preconditioned, cg->num_rows, pitch, cg->prev_child_id, cg->next_child_id);
+	precondition_colour(cg, 1, 0);
+	exchange_boundary_rows(cg->preconditioned, cg->num_rows, pitch, cg->prev_child_id, cg->next_child_id);
+	precondition_colour(cg, 0, 0);
+
+	for (i = 1; i < cg->num_rows - 1; i++) {
+		for (j = 1; j < n - 1; j++) {
+			product += cg->residuals[i * pitch + j] * cg->preconditioned[i * pitch + j];
+			if (fabs(cg->residuals[i * pitch + j]) > max_residual) {
+				max_residual = fabs(cg->residuals[i * pitch + j]);
+			}
+		}
+	}
+	MPI_Allreduce(&product, &cg->residual_product, 1, MPI_DOUBLE, MPI_SUM, cg->comm);
+	return max_residual / 4;
+}
+
+
+/*
+ * Initialises the arrays of the conjugate gradient solver, which solves the 
+ * sub array in place (its rows being pitch values apart, like the rows of the
+ * solver's arrays, and its first row being row start_row of the square 
+ * array), and computes the residuals r = b - A u and the first 
+ * search directions p = z. The sub array's boundary rows must be up to date.
+ * Must be called by all children processes at once.
+ */
+struct conjugate_gradient* initialise_conjugate_gradient(real* sub_arr, 
+	int num_rows, int dimension, int pitch, int start_row, int prev_child_id, 
+	int next_child_id, MPI_Comm comm) {
+	struct conjugate_gradient *cg;
+	int n = dimension;
+	int i, j;
+
+	cg = malloc(sizeof(struct conjugate_gradient));
+	if (cg == NULL) {
+		fprintf(stderr, "Failed to allocate space for the conjugate gradient solver.\n");
+		exit(EXIT_FAILURE);
+	}
+	cg->dimension = dimension;
+	cg->pitch = pitch;
+	cg->num_rows = num_rows;
+	cg->start_row = start_row;
+	cg->prev_child_id = prev_child_id;
+	cg->next_child_id = next_child_id;
+	cg->comm = comm;
+	cg->values = sub_arr;
+	cg->residuals = create_zero_array(num_rows * pitch);
+	cg->preconditioned = create_zero_array(num_rows * pitch);
+	cg->directions = create_zero_array(num_rows * pitch);
+	cg->products = create_zero_array(num_rows * pitch);
+
+	for (i = 1; i < num_rows - 1; i++) {
+		for (j = 1; j < n - 1; j++) {
+			cg->residuals[i * pitch + j] = sub_arr[i * pitch + j - 1] + sub_arr[i * pitch + j + 1] + 
+				sub_arr[(i - 1) * pitch + j] + sub_arr[(i + 1) * pitch + j] - 4 * sub_arr[i * pitch + j];
+		}
+	}
+	precondition(cg);
+	for (i = 1; i < num_rows - 1; i++) {
+		for (j = 1; j < n - 1; j++) {
+			cg->directions[i * pitch + j] = cg->preconditioned[i * pitch + j];
+		}
+	}
+
+	return cg;
+}
+
+
+/*
+ * Runs one conjugate gradient iteration on the process's own rows: moves the 
+ * values along the search directions by the step that minimises the error, 
+ * updates the residuals and picks the next search directions.
+ * Must be called by all children processes at once.
+ * Returns the largest change a Jacobi sweep would still make to a value of 
+ * the process's own rows.
+ */
+double conjugate_gradient_iteration(struct conjugate_gradient* cg) {
+	real *p = cg->directions;
+	real *ap = cg->products;
+	int n = cg->dimension;
+	int pitch = cg->pitch;
+	double product = 0.0;
+	double alpha, beta, previous_residual_product, max_change;
+	int i, j;
+
+	// products A p, the directions are 0 on the boundary of the square array
+	exchange_boundary_rows(p, cg->num_rows, pitch, cg->prev_child_id, cg->next_child_id);
+	for (i = 1; i < cg->num_rows - 1; i++) {
+		for (j = 1; j < n - 1; j++) {
+			ap[i * pitch + j] = 4 * p[i * pitch + j] - 
+				(p[i * pitch + j - 1] + p[i * pitch + j + 1] + p[(i - 1) * pitch + j] + p[(i + 1) * pitch + j]);
+			product += p[i * pitch + j] * ap[i * pitch + j];
+		}
+	}
+	MPI_Allreduce(MPI_IN_PLACE, &product, 1, MPI_DOUBLE, MPI_SUM, cg->comm);
+
+	// move along the directions (which are 0 once the values are exact)
+	alpha = product > 0.0 ? cg->residual_product / product : 0.0;
+	for (i = 1; i < cg->num_rows - 1; i++) {
+		for (j = 1; j < n - 1; j++) {
+			cg->values[i * pitch + j] += (real)(alpha * p[i * pitch + j]);
+			cg->residuals[i * pitch + j] -= (real)(alpha * ap[i * pitch + j]);
+		}
+	}
+	previous_residual_product = cg->residual_product;
+	max_change = precondition(cg);
+
+	// next directions, conjugate to the previous ones
+	beta = previous_residual_product > 0.0 ? cg->residual_product / previous_residual_product : 0.0;
+	for (i = 1; i < cg->num_rows - 1; i++) {
+		for (j = 1; j < n - 1; j++) {
+			p[i * pitch + j] = (real)(cg->preconditioned[i * pitch + j] + beta * p[i * pitch + j]);
+		}
+	}
+	return max_change;
+}
+
+
+/*
+ * Frees the arrays of the solver (the values are the sub array, which is 
+ * freed separately).
+ */
+void free_conjugate_gradient(struct conjugate_gradient* cg) {
+	free(cg->residuals);
+	free(cg->preconditioned);
+	free(cg->directions);
+	free(cg->products);
+	free(cg);
+}
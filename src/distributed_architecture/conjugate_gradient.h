@@ -0,0 +1,41 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ * 
+ * Header file for the preconditioned conjugate gradient solver run by children
+ * processes on their sub arrays.
+ */
+
+
+struct conjugate_gradient {
+	// structure used to keep track of the rows of the solver held by a process
+	int dimension;			// dimension of the square array
+	int pitch;				// values from the start of a row to the next one
+	int num_rows;			// number of rows held, including the 2 boundary rows
+	int start_row;			// row of the square array held first (decides the colour of cells)
+	int prev_child_id;		// previous child process (MPI_PROC_NULL if none)
+	int next_child_id;		// next child process (MPI_PROC_NULL if none)
+	MPI_Comm comm;			// communicator of the children processes
+	double residual_product;	// r.z of all children processes
+	real *values;			// sub array being solved in place
+	real *residuals;		// r = b - A u
+	real *preconditioned;	// z = M^-1 r
+	real *directions;		// search directions p
+	real *products;			// A p
+};
+
+
+struct conjugate_gradient* initialise_conjugate_gradient(real* sub_arr, 
+														 int num_rows, 
+														 int dimension, 
+														 int pitch, 
+														 int start_row, 
+														 int prev_child_id, 
+														 int next_child_id, 
+														 MPI_Comm comm);
+
+
+double conjugate_gradient_iteration(struct conjugate_gradient* cg);
+
+
+void free_conjugate_gradient(struct conjugate_gradient* cg);
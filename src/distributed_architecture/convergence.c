@@ -0,0 +1,100 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ * 
+ * Source file for the reductions used by processes to decide together when 
+ * the array is relaxed to the precision.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+#include "real.h"
+#include "relaxation_helpers.h"
+#include "stall.h"
+#include "convergence.h"
+
+
+/*
+ * Starts checking convergence over the given communicator, the interval and 
+ * non-blocking fields being set from the command line.
+ */
+void initialise_convergence_check(struct convergence_check* check, 
+	MPI_Comm comm) {
+	check->comm = comm;
+	check->pending = 0;
+	check->checked_iteration = 0;
+	check->local_diff = 0.0;
+	check->global_diff = 0.0;
+	check->request = MPI_REQUEST_NULL;
+	check->coarse_precision = 0.0;
+	check->single_iterations = 0;
+	initialise_stall(&check->stall);
+}
+
+
+/*
+ * Returns 1 if the largest change of all processes is within the precision 
+ * (or the relaxation stalled), 0 otherwise. Single precision sweeps within 
+ * the coarse precision give way to double precision sweeps instead, from the
+ * given iteration on.
+ */
+static int is_relaxed(struct convergence_check* check, double precision, 
+	int iteration) {
+	int is_under_precision;
+
+	if (check->coarse_precision > 0.0) {
+		is_under_precision = check->global_diff <= check->coarse_precision || 
+			has_float_stalled(&check->stall, check->global_diff);
+		if (is_under_precision) {
+			check->coarse_precision = 0.0;
+			check->single_iterations = iteration;
+			initialise_stall(&check->stall);
+		}
+		return 0;
+	}
+	return check->global_diff <= precision || has_stalled(&check->stall, check->global_diff);
+}
+
+
+/*
+ * Called by every process after each iteration (numbered from 1) with the 
+ * largest change of this process during the iteration. Reduces the largest 
+ * change of all processes every interval iterations, and after the iterations
+ * omega is estimated after, in which case omega is adapted to it.
+ * A non-blocking reduction started after the previous iteration is finished 
+ * first, and the next one is started after it.
+ * Returns 1 if the processes must stop after this iteration (the array being
+ * relaxed, or the relaxation having stalled), 0 otherwise. All processes get
+ * the same largest changes, so they stop on the same iteration.
+ */
+int check_convergence(struct convergence_check* check, double max_diff, 
+	int iteration, struct omega_adapter* omega, double precision, 
+	int dimension) {
+	int is_under_precision = 0;
+
+	// finish the reduction that ran during this iteration
+	if (check->pending) {
+		MPI_Wait(&check->request, MPI_STATUS_IGNORE);
+		check->pending = 0;
+		is_under_precision = is_relaxed(check, precision, iteration);
+		adapt_omega(omega, check->checked_iteration, check->global_diff, dimension);
+	}
+
+	if (is_under_precision || (iteration % check->interval != 0 && !omega_adapts_after(omega, iteration))) {
+		return is_under_precision;
+	}
+
+	// reduce the largest change of this iteration
+	check->local_diff = max_diff;
+	if (check->non_blocking) {
+		MPI_Iallreduce(&check->local_diff, &check->global_diff, 1, MPI_DOUBLE, MPI_MAX, check->comm, &check->request);
+		check->pending = 1;
+		check->checked_iteration = iteration;
+	} else {
+		MPI_Allreduce(&check->local_diff, &check->global_diff, 1, MPI_DOUBLE, MPI_MAX, check->comm);
+		is_under_precision = is_relaxed(check, precision, iteration);
+		adapt_omega(omega, iteration, check->global_diff, dimension);
+	}
+	return is_under_precision;
+}
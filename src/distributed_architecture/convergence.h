@@ -0,0 +1,32 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ * 
+ * Header file for the reductions used by processes to decide together when 
+ * the array is relaxed to the precision.
+ */
+
+
+struct convergence_check {
+	// structure used to keep track of how and when processes check convergence
+	MPI_Comm comm;			// root and children processes
+	int interval;			// iterations between two checks
+	int non_blocking;		// overlap the reduction with the next iteration
+	int pending;			// a non-blocking reduction is running
+	int checked_iteration;	// iteration whose change is being reduced
+	double local_diff;		// largest change of this process
+	double global_diff;		// largest change of all processes
+	MPI_Request request;		// request of the non-blocking reduction
+	struct stall stall;		// convergence of the largest changes
+	double coarse_precision;	// precision of the single precision sweeps of the
+							// mixed precision mode (0 once reached, or if none)
+	int single_iterations;	// iterations run by the single precision sweeps
+};
+
+
+void initialise_convergence_check(struct convergence_check* check, MPI_Comm comm);
+
+
+int check_convergence(struct convergence_check* check, double max_diff, 
+					  int iteration, struct omega_adapter* omega, 
+					  double precision, int dimension);
@@ -0,0 +1,185 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ * 
+ * Source file for the binary grid files read and written by all processes 
+ * together with MPI-IO.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <mpi.h>
+#include "real.h"
+#include "grid_io.h"
+
+#define GRID_MAGIC "RELAXGRD"
+#define GRID_MAGIC_LENGTH 8
+#define GRID_HEADER_LENGTH 16
+
+
+/*
+ * Stops all processes if an MPI-IO operation on the given file failed.
+ */
+static void check_file_error(int rc, const char* filename, const char* operation) {
+	char message[MPI_MAX_ERROR_STRING];
+	int length;
+
+	if (rc != MPI_SUCCESS) {
+		MPI_Error_string(rc, message, &length);
+		fprintf(stderr, "Error: could not %s grid file %s (%s).\n", operation, filename, message);
+		MPI_Abort(MPI_COMM_WORLD, rc);
+	}
+}
+
+
+/*
+ * Reads the dimension of the square array held in the given grid file.
+ * Called by all processes.
+ */
+int read_grid_dimension(const char* filename) {
+	MPI_File file;
+	char header[GRID_HEADER_LENGTH];
+	int64_t dimension;
+
+	check_file_error(MPI_File_open(MPI_COMM_WORLD, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &file), filename, "open");
+	check_file_error(MPI_File_read_at_all(file, 0, header, GRID_HEADER_LENGTH, MPI_BYTE, MPI_STATUS_IGNORE), filename, 
+		"read");
+	MPI_File_close(&file);
+
+	memcpy(&dimension, &header[GRID_MAGIC_LENGTH], sizeof(dimension));
+	if (memcmp(header, GRID_MAGIC, GRID_MAGIC_LENGTH) != 0 || dimension < 3 || dimension > INT32_MAX) {
+		fprintf(stderr, "Error: %s is not a grid file.\n", filename);
+		MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+	}
+	return (int)dimension;
+}
+
+
+/*
+ * Creates the datatypes of a num_rows x num_cols part of the square array 
+ * starting at row first_row and column first_col: in the file, and in memory 
+ * where its rows are stride values apart.
+ */
+static void create_part_types(int dimension, int stride, int first_row, int first_col, 
+	int num_rows, int num_cols, MPI_Datatype* file_type, MPI_Datatype* memory_type) {
+	int sizes[2] = {dimension, dimension};
+	int subsizes[2] = {num_rows, num_cols};
+	int starts[2] = {first_row, first_col};
+
+	MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE, file_type);
+	MPI_Type_commit(file_type);
+	MPI_Type_vector(num_rows, num_cols, stride, MPI_DOUBLE, memory_type);
+	MPI_Type_commit(memory_type);
+}
+
+
+#ifdef SINGLE_PRECISION
+/*
+ * Allocates the buffer of doubles a part of num_rows x num_cols values of the
+ * square array is converted in, when the values held are not doubles.
+ */
+static double* allocate_part_buffer(int num_rows, int num_cols) {
+	double *buffer = malloc((size_t)num_rows * (size_t)num_cols * sizeof(double));
+	if (buffer == NULL) {
+		fprintf(stderr, "Error: grid file buffer could not be allocated.\n");
+		MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+	}
+	return buffer;
+}
+#endif
+
+
+/*
+ * Reads the num_rows x num_cols part of the square array starting at row 
+ * first_row and column first_col from the given grid file, into values whose
+ * rows are stride values apart. Called by all processes of comm together, 
+ * each reading its own part.
+ */
+void read_grid_part(const char* filename, MPI_Comm comm, int dimension, real* values, 
+	int stride, int first_row, int first_col, int num_rows, int num_cols) {
+	MPI_File file;
+	MPI_Datatype file_type, memory_type;
+#ifdef SINGLE_PRECISION
+	double *buffer = allocate_part_buffer(num_rows, num_cols);
+	int buffer_stride = num_cols;
+	int i, j;
+#else
+	double *buffer = values;
+	int buffer_stride = stride;
+#endif
+
+	create_part_types(dimension, buffer_stride, first_row, first_col, num_rows, num_cols, &file_type, &memory_type);
+	check_file_error(MPI_File_open(comm, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &file), filename, "open");
+	check_file_error(MPI_File_set_view(file, GRID_HEADER_LENGTH, MPI_DOUBLE, file_type, "native", MPI_INFO_NULL), 
+		filename, "set the view of");
+	check_file_error(MPI_File_read_all(file, buffer, 1, memory_type, MPI_STATUS_IGNORE), filename, "read");
+	MPI_File_close(&file);
+	MPI_Type_free(&file_type);
+	MPI_Type_free(&memory_type);
+
+#ifdef SINGLE_PRECISION
+	for (i = 0; i < num_rows; i++) {
+		for (j = 0; j < num_cols; j++) {
+			values[(size_t)i * (size_t)stride + (size_t)j] = (real)buffer[(size_t)i * (size_t)num_cols + (size_t)j];
+		}
+	}
+	free(buffer);
+#endif
+}
+
+
+/*
+ * Writes the num_rows x num_cols part of the square array starting at row 
+ * first_row and column first_col to the given grid file, from values whose
+ * rows are stride values apart. Called by all processes of comm together, 
+ * each writing its own part (the parts must not overlap), the first of them
+ * writing the header too.
+ */
+void write_grid_part(const char* filename, MPI_Comm comm, int dimension, real* values, 
+	int stride, int first_row, int first_col, int num_rows, int num_cols) {
+	MPI_File file;
+	MPI_Datatype file_type, memory_type;
+	char header[GRID_HEADER_LENGTH];
+	int64_t header_dimension = dimension;
+	int rank;
+#ifdef SINGLE_PRECISION
+	double *buffer = allocate_part_buffer(num_rows, num_cols);
+	int buffer_stride = num_cols;
+	int i, j;
+
+	for (i = 0; i < num_rows; i++) {
+		for (j = 0; j < num_cols; j++) {
+			buffer[(size_t)i * (size_t)num_cols + (size_t)j] = values[(size_t)i * (size_t)stride + (size_t)j];
+		}
+	}
+#else
+	double *buffer = values;
+	int buffer_stride = stride;
+#endif
+
+	create_part_types(dimension, buffer_stride, first_row, first_col, num_rows, num_cols, &file_type, &memory_type);
+	check_file_error(MPI_File_open(comm, filename, MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL, &file), 
+		filename, "create");
+	check_file_error(MPI_File_set_size(file, GRID_HEADER_LENGTH + (MPI_Offset)dimension * dimension * 
+		(MPI_Offset)sizeof(double)), filename, "resize");
+
+	MPI_Comm_rank(comm, &rank);
+	if (rank == 0) {
+		memcpy(header, GRID_MAGIC, GRID_MAGIC_LENGTH);
+		memcpy(&header[GRID_MAGIC_LENGTH], &header_dimension, sizeof(header_dimension));
+		check_file_error(MPI_File_write_at(file, 0, header, GRID_HEADER_LENGTH, MPI_BYTE, MPI_STATUS_IGNORE), 
+			filename, "write");
+	}
+
+	check_file_error(MPI_File_set_view(file, GRID_HEADER_LENGTH, MPI_DOUBLE, file_type, "native", MPI_INFO_NULL), 
+		filename, "set the view of");
+	check_file_error(MPI_File_write_all(file, buffer, 1, memory_type, MPI_STATUS_IGNORE), filename, "write");
+	MPI_File_close(&file);
+	MPI_Type_free(&file_type);
+	MPI_Type_free(&memory_type);
+#ifdef SINGLE_PRECISION
+	free(buffer);
+#endif
+}
@@ -0,0 +1,32 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ * 
+ * Header file for the binary grid files read and written by all processes 
+ * together with MPI-IO.
+ */
+
+
+int read_grid_dimension(const char* filename);
+
+
+void read_grid_part(const char* filename, 
+					MPI_Comm comm, 
+					int dimension, 
+					real* values, 
+					int stride, 
+					int first_row, 
+					int first_col, 
+					int num_rows, 
+					int num_cols);
+
+
+void write_grid_part(const char* filename, 
+					 MPI_Comm comm, 
+					 int dimension, 
+					 real* values, 
+					 int stride, 
+					 int first_row, 
+					 int first_col, 
+					 int num_rows, 
+					 int num_cols);
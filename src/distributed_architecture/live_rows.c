@@ -0,0 +1,116 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ *
+ * Source file for the masked arrays, whose bands of rows are balanced by the
+ * number of live cells children processes relax rather than by their rows.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+#include "real.h"
+#include "live_rows.h"
+#include "live_segments.h"
+#include "grid_io.h"
+
+
+/*
+ * Reads num_rows rows of the mask starting at row start_row into a new array.
+ * Called by all processes of comm together.
+ */
+static real* read_mask_rows(const char* mask_file, MPI_Comm comm, int dimension, int start_row, int num_rows) {
+	real *mask = malloc((size_t)num_rows * (size_t)dimension * sizeof(real));
+
+	if (mask == NULL) {
+		fprintf(stderr, "Error: mask memory could not be allocated.\n");
+		MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+	}
+	read_grid_part(mask_file, comm, dimension, mask, dimension, start_row, 0, num_rows, dimension);
+	return mask;
+}
+
+
+/*
+ * Counts the live cells of every row of the mask, the boundaries of the array
+ * being fixed. Called by all processes, each of them counting an even share
+ * of the rows.
+ * Returns the number of live cells of each row, known to all processes.
+ */
+long* count_live_cells(const char* mask_file, int dimension) {
+	long *live_cells = calloc((size_t)dimension, sizeof(long));
+	real *mask;
+	int world_rank, world_size, start_row, end_row, i, j;
+
+	if (live_cells == NULL) {
+		fprintf(stderr, "Error: mask memory could not be allocated.\n");
+		MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+	}
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	start_row = (int)((long)dimension * world_rank / world_size);
+	end_row = (int)((long)dimension * (world_rank + 1) / world_size);
+
+	// processes left without rows (more processes than rows) read the first row without counting it,
+	// as reading the file takes all of them
+	mask = read_mask_rows(mask_file, MPI_COMM_WORLD, dimension, end_row > start_row ? start_row : 0,
+		end_row > start_row ? end_row - start_row : 1);
+	for (i = start_row > 1 ? start_row : 1; i < end_row && i < dimension - 1; i++) {
+		for (j = 1; j < dimension - 1; j++) {
+			if (mask[(size_t)(i - start_row) * (size_t)dimension + (size_t)j] == 0) {
+				live_cells[i]++;
+			}
+		}
+	}
+	free(mask);
+
+	MPI_Allreduce(MPI_IN_PLACE, live_cells, dimension, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+	return live_cells;
+}
+
+
+/*
+ * Splits the rows that are not boundaries of the array into num_children
+ * bands of at least one row holding about as many live cells each, given the
+ * live cells of each row. The band of child number k (0-based) goes from row
+ * first_rows[k] to first_rows[k+1] (excluded), first_rows[num_children] being
+ * the last row of the array.
+ */
+void balance_live_rows(const long* live_cells, int dimension, int num_children, int* first_rows) {
+	long total_cells = 0;
+	long band_cells = 0;
+	int i, k;
+
+	for (i = 1; i < dimension - 1; i++) {
+		total_cells += live_cells[i];
+	}
+
+	// a band ends where the bands up to it hold closest to their share of the live cells, leaving
+	// a row at least to each of the next bands
+	first_rows[0] = 1;
+	i = 1;
+	for (k = 1; k < num_children; k++) {
+		while (i < dimension - 1 - (num_children - k) &&
+			(i == first_rows[k-1] || 2 * band_cells + live_cells[i] <= 2 * (total_cells * k / num_children))) {
+			band_cells += live_cells[i];
+			i++;
+		}
+		first_rows[k] = i;
+	}
+	first_rows[num_children] = dimension - 1;
+}
+
+
+/*
+ * Reads the mask of the num_rows rows of a child process starting at row
+ * start_row, and indexes their live cells. Called by all children processes
+ * together.
+ */
+struct live_segments* read_live_segments(const char* mask_file, MPI_Comm comm, int dimension, int start_row,
+	int num_rows) {
+	real *mask = read_mask_rows(mask_file, comm, dimension, start_row, num_rows);
+	struct live_segments *ls = build_live_segments(mask, dimension, num_rows, dimension);
+
+	free(mask);
+	return ls;
+}
@@ -0,0 +1,23 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ *
+ * Header file for the masked arrays, whose bands of rows are balanced by the
+ * number of live cells children processes relax rather than by their rows.
+ */
+
+
+long* count_live_cells(const char* mask_file, int dimension);
+
+
+void balance_live_rows(const long* live_cells,
+					   int dimension,
+					   int num_children,
+					   int* first_rows);
+
+
+struct live_segments* read_live_segments(const char* mask_file,
+										 MPI_Comm comm,
+										 int dimension,
+										 int start_row,
+										 int num_rows);
@@ -6,8 +6,25 @@
  * memory architecture using MPI (Message Passing Interface)
  *
  * Local usage: 
- * 1) "mpicc -Wall -Wextra -Wconversion main.c -o distributed_relaxation"
- * 2) "mpirun -np <num_processes> ./distributed_relaxation -d <dimension> -p <precision> -debug <debug mode>"
+ * 1) "mpicc -O2 -Wall -Wextra -Wconversion -I../common main.c array_helpers.c 
+ *     print_helpers.c relaxation_helpers.c multigrid.c conjugate_gradient.c 
+ *     block_decomposition.c convergence.c grid_io.c thread_team.c live_rows.c 
+ *     volume_relaxation.c ../common/stencil_kernel.c ../common/wavefront.c 
+ *     ../common/initial_grid.c ../common/grid.c ../common/stall.c 
+ *     ../common/live_segments.c ../common/stencil_operator.c 
+ *     ../common/volume.c ../common/volume_sweep.c ../common/coarsening.c 
+ *     ../common/mixed_precision.c ../common/single_stencil_kernel.c 
+ *     -o distributed_relaxation -pthread -lm"
+ *     (or "make", "make PRECISION=single" for single precision values)
+ * 2) "mpirun -np <num_processes> ./distributed_relaxation -d <dimension> 
+ *     -p <precision> -m <mode> -cycle <v|w> -levels <levels> 
+ *     -block <jacobi sweeps per wavefront> -decomp <rows|blocks|slabs|pencils> 
+ *     -exchange <blocking|overlap> -root <coordinate|compute> 
+ *     -threads <threads per process> -check <iterations> 
+ *     -reduce <allreduce|iallreduce> -input <grid file> -output <grid file> 
+ *     -mask <grid file> -stencil <5|9> -coef <coefficient of the inclusion> 
+ *     -source <source term> -shape <square|cube> 
+ *     -mixed <precision of the single precision sweeps> -debug <debug mode>"
  * example: "mpirun -np 4 ./distributed_relaxation -d 15 -p 0.1 -debug 1"
  * 
  * Author: Adam Jaamour
@@ -20,13 +37,46 @@
 #include <string.h>
 #include <stdbool.h>
 #include <mpi.h>
+#include "real.h"
 #include "array_helpers.h"
 #include "print_helpers.h"
+#include "relaxation_helpers.h"
+#include "multigrid.h"
+#include "conjugate_gradient.h"
+#include "stencil_kernel.h"
+#include "wavefront.h"
+#include "initial_grid.h"
+#include "block_decomposition.h"
+#include "grid_io.h"
+#include "thread_team.h"
+#include "stall.h"
+#include "convergence.h"
+#include "grid.h"
+#include "live_segments.h"
+#include "live_rows.h"
+#include "stencil_operator.h"
+#include "volume.h"
+#include "volume_relaxation.h"
+#include "mixed_precision.h"
 
 #define SEND_TAG 1001
 #define RECV_TAG 1002
 
+// relaxation modes that can be selected from the command line
+#define MODE_JACOBI 0
+#define MODE_RED_BLACK 1
+#define MODE_SOR 2
+#define MODE_MULTIGRID 3
+#define MODE_CONJUGATE_GRADIENT 4
+
+// ways of splitting the array between children processes
+#define DECOMPOSITION_ROWS 0
+#define DECOMPOSITION_BLOCKS 1
+#define DECOMPOSITION_SLABS 2
+#define DECOMPOSITION_PENCILS 3
+
 int DEBUG;
+const char *mode_names[] = {"jacobi", "redblack", "sor", "multigrid", "cg"};
 struct sub_arr_rows {
 	// structure used for children processes to keep track of which part of the array they have
     int start;
@@ -34,44 +84,63 @@ struct sub_arr_rows {
 	int num_elements;
 };
 
+// options selected from the command line (see parse_arguments)
+int dimension, mode, cycle_index, max_levels, block_sweeps, decomposition, 
+	overlap_exchange, first_child_id;
+int num_threads, stencil_points, is_cube;
+double precision, contrast, source, mixed_precision;
+char *input_file;
+char *output_file;
+char *mask_file;
+struct omega_adapter omega;
+struct convergence_check convergence;
 
-int main(int argc, char *argv[]) {
-	
-	// Variables
-	int dimension, num_elements_to_send, num_elements_to_receive, 
-		num_sub_arr_elements, average_height, extra_rows, child_is_under_precision, 
-		extra_rows_counter, height, num_children_processes, iteration_count, 
-		is_under_precision, num_sub_arr_rows, prev_child_id, next_child_id;
-	int id, rc, world_rank, root_process_id, world_size, start_row, end_row;
-	int i, j;
-	double *square_array;
-	double *sub_arr;
-	double *temp_arr;
-	double *temp_sub_arr;
-	double *new_sub_arr;
-	double precision, difference;
-	double v_left, v_right, v_up, v_down, new_value;
-	bool first_iteration;
-	MPI_Status status;
-	MPI_Request request;
-	double start_MPI, end_MPI, elapsed_time;
+
+/*
+ * Parses the command line arguments into the options, warning about invalid
+ * arguments and using the default values of their options instead.
+ */
+void parse_arguments(int argc, char *argv[]) {
+	int arg;
 
 	// Default values (if no command line arguments are correctly passed)
 	DEBUG = 0;
 	dimension = 100;
 	precision = 0.01f;
+	mode = MODE_JACOBI;
+	omega.choice = OMEGA_AUTO;
+	omega.value = 1.0;
+	cycle_index = 1;
+	max_levels = 0;
+	block_sweeps = 1;
+	decomposition = DECOMPOSITION_ROWS;
+	overlap_exchange = 0;
+	first_child_id = 1;
+	num_threads = 1;
+	input_file = NULL;
+	output_file = NULL;
+	mask_file = NULL;
+	stencil_points = 5;
+	contrast = 1.0;
+	source = 0.0;
+	is_cube = 0;
+	mixed_precision = 0.0;
+	convergence.interval = 1;
+	convergence.non_blocking = 0;
 
 	// Read and Parse command line input if there are any
-	int arg;
 	for (arg = 1; arg < argc; arg++) {
-		// parse square array dimension
-		if (strcmp(argv[arg], "-d") == 0) { // compare first argument string with needed flag
+		// parse square array dimension (compare first argument string with 
+		// needed flag)
+		if (strcmp(argv[arg], "-d") == 0) {
 			if (arg + 1 <= argc - 1) { // ensure there are more arguments
 				if (atoi(argv[arg + 1]) > 0) {
 					arg++;
 					dimension = atoi(argv[arg]);
 				} else {
-					fprintf(stderr, "WARNING: Invalid argument for -d. Must be a positive integer. Using dimension = %d as default value.\n", dimension);
+					fprintf(stderr, "WARNING: Invalid argument for -d. Must "
+						"be a positive integer. Using dimension = %d as "
+						"default value.\n", dimension);
 				}
 			}
 		} 
@@ -82,7 +151,262 @@ int main(int argc, char *argv[]) {
 					arg++;
 					precision = atof(argv[arg]);
 				} else {
-					fprintf(stderr, "WARNING: Invalid argument for -p. Must be a positive float. Using precision = %f as default value.\n", precision);
+					fprintf(stderr, "WARNING: Invalid argument for -p. Must "
+						"be a positive float. Using precision = %f as default "
+						"value.\n", precision);
+				}
+			}
+		}
+		// parse relaxation mode
+		else if (strcmp(argv[arg], "-m") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (strcmp(argv[arg], "jacobi") == 0) {
+					mode = MODE_JACOBI;
+				} else if (strcmp(argv[arg], "redblack") == 0) {
+					mode = MODE_RED_BLACK;
+				} else if (strcmp(argv[arg], "sor") == 0) {
+					mode = MODE_SOR;
+				} else if (strcmp(argv[arg], "multigrid") == 0) {
+					mode = MODE_MULTIGRID;
+				} else if (strcmp(argv[arg], "cg") == 0) {
+					mode = MODE_CONJUGATE_GRADIENT;
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -m. Must "
+						"be jacobi, redblack, sor, multigrid or cg. Using "
+						"jacobi as default value.\n");
+				}
+			}
+		}
+		// parse SOR relaxation factor
+		else if (strcmp(argv[arg], "-w") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (strcmp(argv[arg], "auto") == 0) {
+					omega.choice = OMEGA_AUTO;
+				} else if (strcmp(argv[arg], "adapt") == 0) {
+					omega.choice = OMEGA_ADAPT;
+				} else if (atof(argv[arg]) > 0.0 && atof(argv[arg]) < 2.0) {
+					omega.choice = OMEGA_FIXED;
+					omega.value = atof(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -w. Must "
+						"be auto, adapt or a float between 0 and 2. Using "
+						"auto as default value.\n");
+					omega.choice = OMEGA_AUTO;
+				}
+			}
+		}
+		// parse multigrid cycle type
+		else if (strcmp(argv[arg], "-cycle") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (strcmp(argv[arg], "v") == 0) {
+					cycle_index = 1;
+				} else if (strcmp(argv[arg], "w") == 0) {
+					cycle_index = 2;
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -cycle. "
+						"Must be v or w. Using v as default value.\n");
+				}
+			}
+		}
+		// parse maximum number of multigrid levels
+		else if (strcmp(argv[arg], "-levels") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atoi(argv[arg + 1]) > 0) {
+					arg++;
+					max_levels = atoi(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -levels. "
+						"Must be a positive integer. Using as many levels as "
+						"possible.\n");
+				}
+			}
+		}
+		// parse number of jacobi sweeps per wavefront
+		else if (strcmp(argv[arg], "-block") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atoi(argv[arg + 1]) > 0) {
+					arg++;
+					block_sweeps = atoi(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -block. "
+						"Must be a positive integer. Using block = %d as "
+						"default value.\n", block_sweeps);
+				}
+			}
+		}
+		// parse the way the array is split between children processes
+		else if (strcmp(argv[arg], "-decomp") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (strcmp(argv[arg], "rows") == 0) {
+					decomposition = DECOMPOSITION_ROWS;
+				} else if (strcmp(argv[arg], "blocks") == 0) {
+					decomposition = DECOMPOSITION_BLOCKS;
+				} else if (strcmp(argv[arg], "slabs") == 0) {
+					decomposition = DECOMPOSITION_SLABS;
+				} else if (strcmp(argv[arg], "pencils") == 0) {
+					decomposition = DECOMPOSITION_PENCILS;
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -decomp. "
+						"Must be rows, blocks, slabs or pencils. Using rows "
+						"as default value.\n");
+				}
+			}
+		}
+		// parse the way boundary rows are exchanged between children processes
+		else if (strcmp(argv[arg], "-exchange") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (strcmp(argv[arg], "blocking") == 0) {
+					overlap_exchange = 0;
+				} else if (strcmp(argv[arg], "overlap") == 0) {
+					overlap_exchange = 1;
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -exchange. "
+						"Must be blocking or overlap. Using blocking as "
+						"default value.\n");
+				}
+			}
+		}
+		// parse whether the root process only coordinates the children or
+		// relaxes its share too
+		else if (strcmp(argv[arg], "-root") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (strcmp(argv[arg], "coordinate") == 0) {
+					first_child_id = 1;
+				} else if (strcmp(argv[arg], "compute") == 0) {
+					first_child_id = 0;
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -root. "
+						"Must be coordinate or compute. Using coordinate as "
+						"default value.\n");
+				}
+			}
+		}
+		// parse number of iterations between two convergence checks
+		else if (strcmp(argv[arg], "-check") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atoi(argv[arg + 1]) > 0) {
+					arg++;
+					convergence.interval = atoi(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -check. "
+						"Must be a positive integer. Using check = %d as "
+						"default value.\n", convergence.interval);
+				}
+			}
+		}
+		// parse reduction used to check convergence
+		else if (strcmp(argv[arg], "-reduce") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (strcmp(argv[arg], "allreduce") == 0) {
+					convergence.non_blocking = 0;
+				} else if (strcmp(argv[arg], "iallreduce") == 0) {
+					convergence.non_blocking = 1;
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -reduce. "
+						"Must be allreduce or iallreduce. Using allreduce as "
+						"default value.\n");
+				}
+			}
+		}
+		// parse number of threads relaxing the sub array of every process
+		else if (strcmp(argv[arg], "-threads") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atoi(argv[arg + 1]) > 0) {
+					arg++;
+					num_threads = atoi(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -threads. "
+						"Must be a positive integer. Using threads = %d as "
+						"default value.\n", num_threads);
+				}
+			}
+		}
+		// parse grid file holding the initial values of the array
+		else if (strcmp(argv[arg], "-input") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				input_file = argv[arg];
+			}
+		}
+		// parse grid file the relaxed array is written to
+		else if (strcmp(argv[arg], "-output") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				output_file = argv[arg];
+			}
+		}
+		// parse grid file marking the cells held fixed at their initial values
+		else if (strcmp(argv[arg], "-mask") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				mask_file = argv[arg];
+			}
+		}
+		// parse points of the Laplacian
+		else if (strcmp(argv[arg], "-stencil") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (atoi(argv[arg]) == 5 || atoi(argv[arg]) == 9) {
+					stencil_points = atoi(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -stencil. "
+						"Must be 5 or 9. Using 5 as default value.\n");
+				}
+			}
+		}
+		// parse coefficient of the inclusion
+		else if (strcmp(argv[arg], "-coef") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atof(argv[arg + 1]) > 0.0) {
+					arg++;
+					contrast = atof(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -coef. "
+						"Must be a positive float. Using uniform coefficients "
+						"as default value.\n");
+				}
+			}
+		}
+		// parse source term
+		else if (strcmp(argv[arg], "-source") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				source = atof(argv[arg]);
+			}
+		}
+		// parse shape of the array relaxed
+		else if (strcmp(argv[arg], "-shape") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (strcmp(argv[arg], "square") == 0) {
+					is_cube = 0;
+				} else if (strcmp(argv[arg], "cube") == 0) {
+					is_cube = 1;
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -shape. "
+						"Must be square or cube. Using square as default "
+						"value.\n");
+				}
+			}
+		}
+		// parse precision of the sweeps of the single precision copy of the
+		// array
+		else if (strcmp(argv[arg], "-mixed") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atof(argv[arg + 1]) > 0.0) {
+					arg++;
+					mixed_precision = atof(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -mixed. "
+						"Must be a positive float. Using %s precision sweeps "
+						"only.\n", REAL_NAME);
 				}
 			}
 		}
@@ -93,18 +417,227 @@ int main(int argc, char *argv[]) {
 					arg++;
 					DEBUG = atoi(argv[arg]);
 				} else {
-					fprintf(stderr, "WARNING: Invalid argument for -debug. Must be a positive integer. Using debug mode = %d as default value.\n", DEBUG);
+					fprintf(stderr, "WARNING: Invalid argument for -debug. "
+						"Must be a positive integer. Using debug mode = %d as "
+						"default value.\n", DEBUG);
 				}
 			}
 		}
 	}
+}
+
+
+/*
+ * Falls back on the default values of the options a combination of options
+ * doesn't support, warning about each of them: the modes, decompositions and
+ * exchanges only relax the arrays and equations they were written for.
+ */
+void check_option_compatibility(void) {
+	// Only the SOR mode over-relaxes values, red-black sweeps use omega = 1
+	// otherwise
+	if (mode != MODE_SOR) {
+		omega.choice = OMEGA_FIXED;
+		omega.value = 1.0;
+	}
 
-	// Initialize the MPI environment.
-    rc = MPI_Init(NULL, NULL);
+	// cubes are split into slabs or pencils (rows and blocks of the square
+	// array) relaxed by the 7-point jacobi and red-black sweeps of their planes
+	// only (see volume_relaxation.c)
+	if (is_cube && (decomposition == DECOMPOSITION_ROWS || 
+		decomposition == DECOMPOSITION_BLOCKS)) {
+		decomposition = decomposition == DECOMPOSITION_ROWS ? 
+			DECOMPOSITION_SLABS : DECOMPOSITION_PENCILS;
+	} else if (!is_cube && (decomposition == DECOMPOSITION_SLABS || 
+		decomposition == DECOMPOSITION_PENCILS)) {
+		fprintf(stderr, "WARNING: -decomp slabs and pencils only support "
+			"-shape cube. Using rows as default value.\n");
+		decomposition = DECOMPOSITION_ROWS;
+	}
+	if (is_cube && (mode == MODE_MULTIGRID || 
+		mode == MODE_CONJUGATE_GRADIENT)) {
+		fprintf(stderr, "WARNING: -shape cube only supports the jacobi, "
+			"redblack and sor modes. Using jacobi as default value.\n");
+		mode = MODE_JACOBI;
+	}
+	if (is_cube && (block_sweeps > 1 || overlap_exchange || num_threads > 1 || 
+		input_file != NULL || output_file != NULL || mask_file != NULL || 
+		stencil_points == 9 || contrast != 1.0 || source != 0.0)) {
+		fprintf(stderr, "WARNING: -shape cube doesn't support -block, "
+			"-exchange overlap, -threads, -input, -output, -mask, -stencil 9, "
+			"-coef or -source. Using their default values.\n");
+		block_sweeps = 1;
+		overlap_exchange = 0;
+		num_threads = 1;
+		input_file = NULL;
+		output_file = NULL;
+		mask_file = NULL;
+		stencil_points = 5;
+		contrast = 1.0;
+		source = 0.0;
+	}
+
+	// a mask only changes the jacobi and red-black sweeps of bands of rows
+	// exchanged between sweeps
+	if (mask_file != NULL && (mode == MODE_MULTIGRID || 
+		mode == MODE_CONJUGATE_GRADIENT)) {
+		fprintf(stderr, "WARNING: -mask only supports the jacobi, redblack "
+			"and sor modes. Using jacobi as default value.\n");
+		mode = MODE_JACOBI;
+	}
+	if (mask_file != NULL && (decomposition == DECOMPOSITION_BLOCKS || 
+		block_sweeps > 1 || overlap_exchange || num_threads > 1)) {
+		fprintf(stderr, "WARNING: -mask doesn't support -decomp blocks, "
+			"-block, -exchange overlap or -threads. Using their default "
+			"values.\n");
+		decomposition = DECOMPOSITION_ROWS;
+		block_sweeps = 1;
+		overlap_exchange = 0;
+		num_threads = 1;
+	}
+
+	// equations other than the Laplace equation are relaxed by the blocking
+	// jacobi and red-black sweeps of bands of rows only, and the 9-point
+	// stencil (which only comes with uniform coefficients) by jacobi sweeps
+	// only, as the corners of a cell are of its own colour
+	if ((stencil_points == 9 || contrast != 1.0 || source != 0.0) && 
+		(mode == MODE_MULTIGRID || mode == MODE_CONJUGATE_GRADIENT)) {
+		fprintf(stderr, "WARNING: -stencil 9, -coef and -source only support "
+			"the jacobi, redblack and sor modes. Using jacobi as default "
+			"value.\n");
+		mode = MODE_JACOBI;
+	} else if (stencil_points == 9 && contrast == 1.0 && mode != MODE_JACOBI) {
+		fprintf(stderr, "WARNING: -stencil 9 only supports the jacobi mode. "
+			"Using jacobi as default value.\n");
+		mode = MODE_JACOBI;
+	}
+	if ((stencil_points == 9 || contrast != 1.0 || source != 0.0) && 
+		(decomposition == DECOMPOSITION_BLOCKS || block_sweeps > 1 || 
+		overlap_exchange || num_threads > 1 || mask_file != NULL)) {
+		fprintf(stderr, "WARNING: -stencil 9, -coef and -source don't support "
+			"-decomp blocks, -block, -exchange overlap, -threads or -mask. "
+			"Using their default values.\n");
+		decomposition = DECOMPOSITION_ROWS;
+		block_sweeps = 1;
+		overlap_exchange = 0;
+		num_threads = 1;
+		mask_file = NULL;
+	}
+
+	// multigrid, conjugate gradient and blocks of sweeps work on bands of full
+	// rows only
+	if (decomposition == DECOMPOSITION_BLOCKS && (mode == MODE_MULTIGRID || 
+		mode == MODE_CONJUGATE_GRADIENT || block_sweeps > 1)) {
+		fprintf(stderr, "WARNING: -decomp blocks only supports the jacobi, "
+			"redblack and sor modes without -block. Using rows as default "
+			"value.\n");
+		decomposition = DECOMPOSITION_ROWS;
+	}
+
+	// exchanges are only overlapped with the sweeps of the row bands
+	if (overlap_exchange && (mode == MODE_MULTIGRID || 
+		mode == MODE_CONJUGATE_GRADIENT || block_sweeps > 1 || 
+		decomposition == DECOMPOSITION_BLOCKS)) {
+		fprintf(stderr, "WARNING: -exchange overlap only supports the jacobi, "
+			"redblack and sor modes without -block and with -decomp rows. "
+			"Using blocking as default value.\n");
+		overlap_exchange = 0;
+	}
+
+	// omega is adapted from the rate at which the changes of single sweeps
+	// shrink
+	if (omega.choice == OMEGA_ADAPT && block_sweeps > 1) {
+		fprintf(stderr, "WARNING: -block doesn't support -w adapt. Using "
+			"block = 1 as default value.\n");
+		block_sweeps = 1;
+	}
+
+	// threads share the sweeps of the jacobi and red-black modes only
+	if (num_threads > 1 && (mode == MODE_MULTIGRID || 
+		mode == MODE_CONJUGATE_GRADIENT || block_sweeps > 1)) {
+		fprintf(stderr, "WARNING: -threads only supports the jacobi, redblack "
+			"and sor modes without -block. Using threads = 1 as default "
+			"value.\n");
+		num_threads = 1;
+	}
+
+	// the single precision copy of the array is relaxed by the blocking jacobi
+	// and red-black sweeps of bands of rows of the Laplace equation only, in
+	// double precision builds
+	if (mixed_precision > 0.0 && (sizeof(real) != sizeof(double) || 
+		mode == MODE_MULTIGRID || mode == MODE_CONJUGATE_GRADIENT || 
+		is_cube || decomposition == DECOMPOSITION_BLOCKS || 
+		block_sweeps > 1 || overlap_exchange || num_threads > 1 || 
+		mask_file != NULL || stencil_points == 9 || contrast != 1.0 || 
+		source != 0.0)) {
+		fprintf(stderr, "WARNING: -mixed only supports double precision "
+			"builds relaxing the Laplace equation with the jacobi, redblack "
+			"and sor modes and -decomp rows, without -block, -exchange "
+			"overlap, -threads or -mask. Using %s precision sweeps only.\n", 
+			REAL_NAME);
+		mixed_precision = 0.0;
+	}
+}
+
+
+int main(int argc, char *argv[]) {
+	
+	// Variables
+	int num_elements_to_receive, 
+		num_sub_arr_elements, average_height, extra_rows, 
+		extra_rows_counter, height, num_children_processes, iteration_count, 
+		is_under_precision, num_sub_arr_rows;
+	int id, rc, world_rank, root_process_id, world_size, start_row, end_row;
+	int prev_child_id, next_child_id, halo_rows, sub_arr_width, sub_arr_pitch, gather_array;
+	int thread_support;
+	int first_row, first_col;
+	int dims[2];
+	int *first_rows;
+	long *live_cells;
+	long num_live_cells, child_live_cells;
+	int row;
+	real *square_array;
+	real *sub_arr;
+	real *temp_arr;
+	real *new_sub_arr;
+	real *scratch;
+	double max_diff, child_max_diff;
+	struct multigrid *mg;
+	struct conjugate_gradient *cg;
+	struct block_decomposition *bd;
+	struct thread_team *team;
+	struct grid *grid;
+	struct live_segments *ls;
+	struct stencil_operator op;
+	struct grid *coefficient_grid;
+	struct volume_decomposition *vd;
+	struct single_grid *sg;
+	struct sub_arr_rows *rows_arr;
+	bool first_iteration;
+	MPI_Comm children_comm;
+	MPI_Comm relaxation_comm;
+	MPI_Status status;
+	MPI_Datatype rows_type;
+	double start_MPI, end_MPI, elapsed_time;
+
+	// Read and Parse command line input if there are any, falling back on the options the modes support
+	parse_arguments(argc, argv);
+	check_option_compatibility();
+	square_array = NULL;
+	live_cells = NULL;
+	num_live_cells = 0;
+	initialise_stencil_kernel();
+
+	// Initialize the MPI environment, only the thread of the process calling MPI if it runs other threads
+    rc = MPI_Init_thread(NULL, NULL, num_threads > 1 ? MPI_THREAD_FUNNELED : MPI_THREAD_SINGLE, &thread_support);
 	if (rc != MPI_SUCCESS) {
 		printf ("Error starting MPI program\n");
 		MPI_Abort(MPI_COMM_WORLD, rc);
 	}
+	if (num_threads > 1 && thread_support < MPI_THREAD_FUNNELED) {
+		fprintf(stderr, "WARNING: the MPI library doesn't support MPI_THREAD_FUNNELED. Using threads = 1 as default "
+			"value.\n");
+		num_threads = 1;
+	}
 
 	// Start recording time after initialisation overhead and command line parsing is finished
 	start_MPI = MPI_Wtime();
@@ -114,33 +647,127 @@ int main(int argc, char *argv[]) {
 	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
 	root_process_id = 0;
 
-    // Kill program if less than 2 processes
-	if (world_size < 2) {
-		fprintf(stderr, "World size must be greater than 2 for %s\n", argv[0]);
+	// the dimension of an array read from a grid file is the one of the file
+	if (input_file != NULL) {
+		dimension = read_grid_dimension(input_file);
+	} else if (mask_file != NULL) {
+		dimension = read_grid_dimension(mask_file);
+	}
+	if (input_file != NULL && mask_file != NULL && read_grid_dimension(mask_file) != dimension) {
+		if (world_rank == root_process_id) {
+			fprintf(stderr, "Error: the mask %s and the input %s are not of the same dimension.\n", mask_file, 
+				input_file);
+		}
+		MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+	}
+	initialise_omega(&omega, dimension);
+	initialise_stencil_operator(&op, stencil_points, contrast, source, dimension);
+
+    // Kill program if less than 2 processes, unless the root process relaxes its share too
+	if (world_size < first_child_id + 1) {
+		fprintf(stderr, "World size must be greater than 2 for %s (or use -root compute)\n", argv[0]);
 		MPI_Abort(MPI_COMM_WORLD, rc);
 	}
 	
-	// Don't use more processes than there are num_sub_arr_rows to process in the array
-	if (world_size > dimension - 2) {
-		world_size = dimension - 2;
+	// Don't use more processes than there are num_sub_arr_rows (or blocks, slabs or pencils) to process in the array
+	if (decomposition == DECOMPOSITION_BLOCKS) {
+		while (!block_grid_dims(world_size - first_child_id, dimension, dims)) {
+			world_size--;
+		}
+	} else if (is_cube) {
+		while (!volume_grid_dims(world_size - first_child_id, dimension, decomposition == DECOMPOSITION_PENCILS, 
+			dims)) {
+			world_size--;
+		}
+	} else if (world_size - first_child_id > dimension - 2) {
+		world_size = dimension - 2 + first_child_id;
 	}
 	
 	// Calculating variables with constant values
-	num_children_processes = world_size - 1;
+	num_children_processes = world_size - first_child_id;
 	average_height = (int)floor((dimension - 2) / num_children_processes) + 2;
 	extra_rows = (dimension - 2) % num_children_processes;
+
+	// a block of sweeps gets the rows it needs around a child's rows from the next children 
+	// only, 1 row per jacobi sweep and 2 rows per red-black sweep (one per colour), so it 
+	// can't run more sweeps at a time than the smallest child has rows for
+	if (mode == MODE_MULTIGRID || mode == MODE_CONJUGATE_GRADIENT) {
+		block_sweeps = 1;
+	} else if (mode == MODE_JACOBI && block_sweeps > average_height - 2) {
+		block_sweeps = average_height - 2;
+	} else if (mode != MODE_JACOBI && block_sweeps > (average_height - 2) / 2) {
+		block_sweeps = (average_height - 2) / 2 > 1 ? (average_height - 2) / 2 : 1;
+	}
+	halo_rows = block_sweeps > 1 && mode != MODE_JACOBI ? 2 * block_sweeps - 1 : block_sweeps - 1;
+
+	// children processes relaxing the array get their own communicator for the collective 
+	// operations of multigrid and conjugate gradient (which the root process is only part of if it relaxes its share)
+	MPI_Comm_split(MPI_COMM_WORLD, world_rank < first_child_id || world_rank >= world_size ? MPI_UNDEFINED : 0, 
+		world_rank, &children_comm);
+
+	// the root process and the children processes check convergence together
+	MPI_Comm_split(MPI_COMM_WORLD, world_rank >= world_size ? MPI_UNDEFINED : 0, world_rank, &relaxation_comm);
+	initialise_convergence_check(&convergence, relaxation_comm);
+	convergence.coarse_precision = mixed_precision;
 	
 
-	// Executed by root process only
-    if (world_rank == root_process_id) {
-		first_iteration = true;
+	// the start row, end row and total number of elements of each of the children's sub array, 
+	// which every process finds by itself instead of getting them from the root process
+	rows_arr = malloc((size_t)world_size * sizeof(struct sub_arr_rows));
+	extra_rows_counter = extra_rows;
+	end_row = average_height - 1; // (minus 1 for index of array)
+	for (id = first_child_id; id < world_size; id++) {
+		
+		// determine the number of extra num_sub_arr_rows (if any) given to each child process
+		height = average_height;
+		if (extra_rows_counter > 0) {
+			height++;
+			extra_rows_counter--;
+		}
 		
-		// initialise array values
-		square_array = initialise_square_array(dimension);
+		// assign previous process end row as first editable row and pass row before for relaxation
+		start_row = end_row - 1;
+		// first child process starts with 0
+		if (id == first_child_id) start_row = 0;
+		// assign end row using the row index (minus 1)
+		end_row = start_row + (height - 1);
 		
+		rows_arr[id].start = start_row;
+		rows_arr[id].end = end_row;
+		rows_arr[id].num_elements = dimension * height;
+	}
+
+	// with a mask, the bands of rows hold about as many live cells instead of as many rows
+	if (mask_file != NULL) {
+		live_cells = count_live_cells(mask_file, dimension);
+		first_rows = malloc((size_t)(num_children_processes + 1) * sizeof(int));
+		balance_live_rows(live_cells, dimension, num_children_processes, first_rows);
+		for (id = first_child_id; id < world_size; id++) {
+			rows_arr[id].start = first_rows[id - first_child_id] - 1;
+			rows_arr[id].end = first_rows[id - first_child_id + 1];
+			rows_arr[id].num_elements = dimension * (rows_arr[id].end - rows_arr[id].start + 1);
+		}
+		for (row = 1; row < dimension - 1; row++) {
+			num_live_cells += live_cells[row];
+		}
+		free(first_rows);
+	}
+
+	// the relaxed array is only gathered by the root process to be printed, every process 
+	// generates its own part of the initial array so that none of them holds all of it
+	gather_array = DEBUG >= 3 && !is_cube;
+
+	// Executed by root process only: log the portion of the array of each child process
+    if (world_rank == root_process_id) {
 		// print initial parameters for log information
-		print_parameters(dimension, world_size, precision);
-		if (DEBUG >= 3) {
+		print_parameters(dimension, world_size, precision, mode_names[mode]);
+		if (gather_array && input_file != NULL) {
+			square_array = create_new_array(dimension * dimension);
+			read_grid_part(input_file, MPI_COMM_SELF, dimension, square_array, dimension, 0, 0, dimension, dimension);
+		} else if (gather_array) {
+			square_array = initialise_square_array(dimension);
+		}
+		if (gather_array) {
 			printf("Initial square array to relax:\n");
 			print_square_array(dimension, square_array); 
 			printf("\n");
@@ -150,76 +777,382 @@ int main(int argc, char *argv[]) {
 		iteration_count = 0;
 		is_under_precision = 0;
 
-		// array used to keep track of the start row, end row and total number 
-		// of elements for each of the children's sub array
-		struct sub_arr_rows rows_arr[num_children_processes]; 
+		if (DEBUG >= 1 && decomposition == DECOMPOSITION_BLOCKS) {
+			printf("Blocks: %d down x %d across\n\n", dims[0], dims[1]);
+		} else if (DEBUG >= 1 && is_cube) {
+			printf("Parts of the cube: %d down the planes x %d down the rows\n\n", dims[0], dims[1]);
+		}
+		for (id = first_child_id; id < world_size && DEBUG >= 1 && decomposition == DECOMPOSITION_ROWS && mask_file == NULL; id++) {
+			printf("Process ID %d: start row = %d - end row = %d\n\n", id, rows_arr[id].start, rows_arr[id].end);
+		}
+		for (id = first_child_id; id < world_size && DEBUG >= 1 && mask_file != NULL; id++) {
+			child_live_cells = 0;
+			for (row = rows_arr[id].start + 1; row < rows_arr[id].end; row++) {
+				child_live_cells += live_cells[row];
+			}
+			printf("Process ID %d: start row = %d - end row = %d - live cells = %ld\n\n", id, rows_arr[id].start, 
+				rows_arr[id].end, child_live_cells);
+		}
+	} 
+	
+	// Executed by all children processes relaxing a cube, which relax the planes of their slab or pencil instead 
+	// (see volume_relaxation.c), and by the root process if it relaxes its share too 
+	if (is_cube && world_rank >= first_child_id && world_rank < world_size) {
+		vd = initialise_volume_decomposition(dimension, dims, mode == MODE_JACOBI ? 2 : 1, children_comm);
+		iteration_count = relax_volume_part(vd, mode != MODE_JACOBI, &omega, &convergence, precision, dimension);
+		is_under_precision = 1;
+		free_volume_decomposition(vd);
+		MPI_Comm_free(&children_comm);
+	}
+
+	// Executed by all children processes, and by the root process if it relaxes its share too 
+	// (processes left out of the decomposition have nothing to do)
+	if (!is_cube && world_rank >= first_child_id && world_rank < world_size) {
+
+		// initialise children processes variables
+		is_under_precision = 0;
+		iteration_count = 0;
+		first_iteration = true;
+		num_sub_arr_elements = 0;
+
+		// get the number of elements of the sub array and where they start in the main array, 
+		// or the block of the child from its place in the cartesian communicator
+		bd = NULL;
+		team = NULL;
+		if (num_threads > 1) {
+			team = initialise_thread_team(num_threads);
+		}
+		if (decomposition == DECOMPOSITION_BLOCKS) {
+			bd = initialise_block_decomposition(dimension, dims, children_comm);
+			num_sub_arr_elements = bd->num_rows * bd->num_cols;
+			sub_arr_width = bd->num_cols;
+			// only the parity of row + column of the first value matters to red-black sweeps
+			start_row = bd->start_row - 1 + bd->start_col - 1;
+		} else {
+			num_sub_arr_elements = rows_arr[world_rank].num_elements;
+			start_row = rows_arr[world_rank].start;
+			sub_arr_width = dimension;
+		}
+		if (DEBUG >= 2) {
+			printf("Hello world from processor #%d out of %d children processes\n\n", world_rank, 
+				num_children_processes);
+		}
+		
+		// create the grid of the sub array (see common/grid.c), with a second buffer to store the new values of 
+		// jacobi sweeps and room for the extra rows around the sub array used by blocks of sweeps
+		grid = allocate_grid(num_sub_arr_elements / sub_arr_width, sub_arr_width, halo_rows, 
+			mode == MODE_JACOBI ? 2 : 1);
+		clear_grid_rows(grid, 0, grid->num_rows);
+		num_sub_arr_rows = grid->num_rows;
+		sub_arr_pitch = grid->pitch;
+		sub_arr = grid->values;
+		new_sub_arr = grid->next_values;
+		scratch = NULL;
+
+		// first and last children processes hold a boundary of the array instead of sharing a row
+		prev_child_id = world_rank == first_child_id ? MPI_PROC_NULL : world_rank - 1;
+		next_child_id = world_rank == world_size - 1 ? MPI_PROC_NULL : world_rank + 1;
+		mg = NULL;
+		cg = NULL;
+		ls = NULL;
+		sg = NULL;
+
+		// coefficients of the rows of the sub array, generated by every process for its own rows (see 
+		// common/stencil_operator.c)
+		coefficient_grid = NULL;
+		if (op.coefficients) {
+			coefficient_grid = allocate_grid(num_sub_arr_rows, dimension, 0, 1);
+			initialise_coefficients(&op, coefficient_grid->values, coefficient_grid->pitch, start_row, 0, 
+				num_sub_arr_rows, dimension);
+		}
 
 		while (!is_under_precision) {
-			// send a portion of the array to each child process only once
+			// first iteration where the entire sub array is generated by this process
 			if (first_iteration) {
 				
-				extra_rows_counter = extra_rows;
-				end_row = average_height - 1; // (minus 1 for index of array)
-
-				// determine portions of the original square array to send to children processes and send them
-				for (id = 1; id < world_size; id++) {
-					
-					// determine the number of extra num_sub_arr_rows (if any) to send to each child process
-					height = average_height;
-					if (extra_rows_counter > 0) {
-						height++;
-						extra_rows_counter--;
+				// read or generate the initial values of the portion of the array that will need to be relaxed in this 
+				// process
+				if (input_file != NULL && bd != NULL) {
+					read_grid_part(input_file, children_comm, dimension, sub_arr, sub_arr_pitch, bd->start_row - 1, 
+						bd->start_col - 1, bd->num_rows, bd->num_cols);
+				} else if (input_file != NULL) {
+					read_grid_part(input_file, children_comm, dimension, grid->rows[halo_rows], sub_arr_pitch, 
+						start_row, 0, num_sub_arr_elements / dimension, dimension);
+				} else if (bd != NULL) {
+					initialise_grid_values(sub_arr, sub_arr_pitch, bd->start_row - 1, bd->start_col - 1, bd->num_rows, 
+						bd->num_cols);
+				} else {
+					initialise_grid_values(grid->rows[halo_rows], sub_arr_pitch, start_row, 0, 
+						num_sub_arr_elements / dimension, dimension);
+				}
+		        
+				// copy the values in the new values buffer (where the fixed cells of a mask keep their values)
+				if (mode == MODE_JACOBI) {
+					copy_grid_buffer(grid);
+				}
+
+				// the mixed precision mode relaxes a single precision copy of the sub array first (see 
+				// common/mixed_precision.c)
+				if (mixed_precision > 0.0) {
+					sg = allocate_single_grid(num_sub_arr_rows, dimension, mode == MODE_JACOBI ? 2 : 1);
+					to_single_rows(grid->rows, sg->rows, 0, num_sub_arr_rows, dimension);
+					if (mode == MODE_JACOBI) {
+						to_single_rows(grid->rows, sg->next_rows, 0, num_sub_arr_rows, dimension);
 					}
-					
-					// assign previous process end row as first editable row and pass row before for relaxation
-					start_row = end_row - 1;
-					// first child process starts with 0
-					if (id == 1) start_row = 0;
-					// assign end row using the row index (minus 1)
-					end_row = start_row + (height - 1);
-					
-					if (DEBUG >= 1) printf("Process ID %d: start row = %d - end row = %d\n\n", id, start_row, end_row);
-					
-					// tell children processes how many elements from the original array they will receive in a non-blocking send
-					num_elements_to_send = dimension * height;
-					MPI_Isend(&num_elements_to_send, 1, MPI_INT, id, SEND_TAG, MPI_COMM_WORLD, &request);
-					
-					// Store this information in our struct for later use when we receive the array back
-					rows_arr[id].start = start_row;
-					rows_arr[id].end = end_row;
-					rows_arr[id].num_elements = num_elements_to_send;
-										
-					// send the sub array to the children processes in a non-blocking send
-					MPI_Isend(&square_array[rows_arr[id].start * dimension], num_elements_to_send, MPI_DOUBLE, id, SEND_TAG, MPI_COMM_WORLD, &request);
+				}
+
+				// sweeps only relax the live cells of the rows of the sub array
+				if (mask_file != NULL) {
+					ls = read_live_segments(mask_file, children_comm, dimension, start_row, num_sub_arr_rows);
 				}
 				first_iteration = false;
-			} 
-			iteration_count++;
 
-			// wait for children processes to have received their sub arrays
-			MPI_Wait(&request, &status);
-			if (DEBUG >= 4) printf("\nIteration number %d\n\n", iteration_count);
+				// the wavefront reaches the rows of the sub arrays through the row pointers of the grid
+				if (block_sweeps > 1 && mode == MODE_JACOBI) {
+					scratch = initialise_wavefront_scratch(dimension, block_sweeps);
+				}
+
+				// the rows around the sub array a block of sweeps needs come from the next 
+				// children processes (each process only generates one row on each side)
+				if (halo_rows > 0) {
+					exchange_halo_rows(sub_arr, num_sub_arr_rows, sub_arr_pitch, halo_rows + 1, prev_child_id, 
+						next_child_id);
+				}
+
+				// multigrid relaxes the sub array in place on its finest level
+				if (mode == MODE_MULTIGRID) {
+					mg = initialise_multigrid(sub_arr, num_sub_arr_rows, dimension, sub_arr_pitch, start_row, 
+						prev_child_id, next_child_id, children_comm, max_levels, cycle_index, precision);
+				} else if (mode == MODE_CONJUGATE_GRADIENT) {
+					cg = initialise_conjugate_gradient(sub_arr, num_sub_arr_rows, dimension, sub_arr_pitch, start_row, 
+						prev_child_id, next_child_id, children_comm);
+				}
+			}
+			
+			// future iterations do no send/receive the entire portion of tha array to relax again as it causes unnecessary communication overhead 
+			// from now on, send and receive the first and last rows of the sub array this process is working on
+			// (multigrid and conjugate gradient share the rows they need themselves, overlapped sweeps 
+			// and teams of threads exchange them while relaxing the other rows)
+			else if (sg != NULL) {
+				exchange_single_rows(sg->rows, num_sub_arr_rows, dimension, prev_child_id, next_child_id);
+			} else if (bd != NULL) {
+				exchange_block_halos(bd, sub_arr);
+			} else if (mode != MODE_MULTIGRID && mode != MODE_CONJUGATE_GRADIENT && !overlap_exchange && team == NULL) {
+				exchange_halo_rows(sub_arr, num_sub_arr_rows, sub_arr_pitch, halo_rows + 1, prev_child_id, 
+					next_child_id);
+			}
 
-			// check with each process to see if they went out of precision on this iteration
-			is_under_precision = 1;
-			child_is_under_precision = 0;
-			for (id = 1; id < world_size; id++) {
-				MPI_Recv(&child_is_under_precision, 1, MPI_INT, id, RECV_TAG, MPI_COMM_WORLD, &status);
-				if (!child_is_under_precision && is_under_precision) {
-					is_under_precision = 0;
+			// perform relaxation on assigned portion of the array
+			if (sg != NULL && mode == MODE_JACOBI) {
+				max_diff = single_jacobi_rows(sg->rows, sg->next_rows, 1, num_sub_arr_rows - 1, dimension);
+			} else if (sg != NULL) {
+				// same as the red-black sweeps below, on the single precision copy
+				max_diff = single_colour_rows(sg->rows, 1, num_sub_arr_rows - 1, dimension, start_row, 0, omega.value);
+				exchange_single_rows(sg->rows, num_sub_arr_rows, dimension, prev_child_id, next_child_id);
+				child_max_diff = single_colour_rows(sg->rows, 1, num_sub_arr_rows - 1, dimension, start_row, 1, 
+					omega.value);
+				if (child_max_diff > max_diff) {
+					max_diff = child_max_diff;
+				}
+			} else if (mode == MODE_MULTIGRID) {
+				// one cycle, the change of its last sweep on the finest level decides convergence
+				max_diff = multigrid_cycle(mg, 0);
+			} else if (mode == MODE_CONJUGATE_GRADIENT) {
+				// one iteration, the change a Jacobi sweep would still make decides convergence
+				max_diff = conjugate_gradient_iteration(cg);
+			} else if (team != NULL && mode == MODE_JACOBI) {
+				max_diff = team_jacobi_sweep(team, sub_arr, new_sub_arr, num_sub_arr_rows, sub_arr_width, 
+					sub_arr_pitch, bd == NULL, prev_child_id, next_child_id);
+			} else if (team != NULL) {
+				// blocks share the updated rows and columns before updating black cells
+				max_diff = team_red_black_sweep(team, sub_arr, num_sub_arr_rows, sub_arr_width, sub_arr_pitch, 
+					start_row, 0, omega.value, bd == NULL, prev_child_id, next_child_id);
+				if (bd != NULL) {
+					exchange_block_halos(bd, sub_arr);
+				}
+				child_max_diff = team_red_black_sweep(team, sub_arr, num_sub_arr_rows, sub_arr_width, sub_arr_pitch, 
+					start_row, 1, omega.value, bd == NULL, prev_child_id, next_child_id);
+				if (child_max_diff > max_diff) {
+					max_diff = child_max_diff;
+				}
+			} else if (overlap_exchange && mode == MODE_JACOBI) {
+				max_diff = overlapped_jacobi_sweep(sub_arr, new_sub_arr, num_sub_arr_rows, dimension, sub_arr_pitch, 
+					prev_child_id, next_child_id);
+			} else if (overlap_exchange) {
+				// exchange rows while updating red cells, then again while updating black cells
+				max_diff = overlapped_red_black_sweep(sub_arr, num_sub_arr_rows, dimension, sub_arr_pitch, start_row, 
+					0, omega.value, prev_child_id, next_child_id);
+				child_max_diff = overlapped_red_black_sweep(sub_arr, num_sub_arr_rows, dimension, sub_arr_pitch, 
+					start_row, 1, omega.value, prev_child_id, next_child_id);
+				if (child_max_diff > max_diff) {
+					max_diff = child_max_diff;
+				}
+			} else if (block_sweeps > 1 && mode != MODE_JACOBI) {
+				// several sweeps relaxing again the rows of the neighbours, the change of the last one decides 
+				// convergence
+				max_diff = red_black_block_sweeps(sub_arr, num_sub_arr_rows, dimension, sub_arr_pitch, halo_rows + 1, 
+					start_row, omega.value, prev_child_id, next_child_id, block_sweeps);
+			} else if (!is_plain_laplacian(&op) && mode != MODE_JACOBI) {
+				// same as below, with the kernels of the stencil operator
+				max_diff = operator_rows_colour(&op, grid->rows, 
+					coefficient_grid != NULL ? coefficient_grid->rows : NULL, 1, num_sub_arr_rows - 1, dimension, 
+					start_row, 0, omega.value);
+				exchange_boundary_rows(sub_arr, num_sub_arr_rows, sub_arr_pitch, prev_child_id, next_child_id);
+				child_max_diff = operator_rows_colour(&op, grid->rows, 
+					coefficient_grid != NULL ? coefficient_grid->rows : NULL, 1, num_sub_arr_rows - 1, dimension, 
+					start_row, 1, omega.value);
+				if (child_max_diff > max_diff) {
+					max_diff = child_max_diff;
 				}
+			} else if (ls != NULL && mode != MODE_JACOBI) {
+				// same as below, one segment of live cells at a time
+				max_diff = red_black_live_rows(ls, grid->rows, 1, num_sub_arr_rows - 1, start_row, 0, omega.value);
+				exchange_boundary_rows(sub_arr, num_sub_arr_rows, sub_arr_pitch, prev_child_id, next_child_id);
+				child_max_diff = red_black_live_rows(ls, grid->rows, 1, num_sub_arr_rows - 1, start_row, 1, 
+					omega.value);
+				if (child_max_diff > max_diff) {
+					max_diff = child_max_diff;
+				}
+			} else if (mode == MODE_RED_BLACK || mode == MODE_SOR) {
+				// update red cells, then share the updated rows before updating black cells
+				max_diff = red_black_sweep(sub_arr, NULL, num_sub_arr_rows, sub_arr_width, sub_arr_pitch, start_row, 0, 
+					omega.value);
+				if (bd != NULL) {
+					exchange_block_halos(bd, sub_arr);
+				} else {
+					exchange_boundary_rows(sub_arr, num_sub_arr_rows, sub_arr_pitch, prev_child_id, next_child_id);
+				}
+				child_max_diff = red_black_sweep(sub_arr, NULL, num_sub_arr_rows, sub_arr_width, sub_arr_pitch, 
+					start_row, 1, omega.value);
+				if (child_max_diff > max_diff) {
+					max_diff = child_max_diff;
+				}
+			} else if (block_sweeps > 1) {
+				// several sweeps while rows are in cache, the change of the last one decides convergence
+				max_diff = jacobi_wavefront(grid->rows, grid->next_rows, num_sub_arr_rows, dimension, block_sweeps, 
+					prev_child_id, next_child_id, scratch);
+			} else if (!is_plain_laplacian(&op)) {
+				max_diff = operator_rows(&op, grid->rows, grid->next_rows, 
+					coefficient_grid != NULL ? coefficient_grid->rows : NULL, 1, num_sub_arr_rows - 1, dimension);
+			} else if (ls != NULL) {
+				max_diff = jacobi_live_rows(ls, grid->rows, grid->next_rows, 1, num_sub_arr_rows - 1);
+			} else {
+				max_diff = jacobi_sweep(sub_arr, new_sub_arr, num_sub_arr_rows, sub_arr_width, sub_arr_pitch);
 			}
+			iteration_count += block_sweeps;
+
+			// find out with the other processes whether the values of all processes changed by less than 
+			// the precision, which tells this process to stop or continue relaxing sub array
+			is_under_precision = check_convergence(&convergence, max_diff, iteration_count / block_sweeps, &omega, 
+				precision, dimension);
 
-			// tell children processes to continue or to stop relaxing their portion of the array
-			for (id = 1; id < world_size; id++) {
-				MPI_Isend(&is_under_precision, 1, MPI_INT, id, SEND_TAG, MPI_COMM_WORLD, &request);
+			// update arrays for next iteration (red-black relaxes in place)
+			if (sg != NULL && mode == MODE_JACOBI) {
+				swap_single_buffers(sg);
+			} else if (mode == MODE_JACOBI) {
+				swap_grid_buffers(grid);
+				sub_arr = grid->values;
+				new_sub_arr = grid->next_values;
+			}
+
+			// once the values of all processes changed by less than the coarse precision, or stalled in single 
+			// precision, the sub array picks up the values of its copy and the sweeps go on in double precision
+			if (sg != NULL && convergence.coarse_precision == 0.0) {
+				to_double_rows(sg->rows, grid->rows, 1, num_sub_arr_rows - 1, dimension);
+				free_single_grid(sg);
+				sg = NULL;
+			}
+		}
+		
+		// all processes write the values they relaxed to the grid file together, the boundaries 
+		// of the array being written by the processes holding them
+		if (output_file != NULL && bd != NULL) {
+			first_row = bd->start_row - (bd->north == MPI_PROC_NULL ? 1 : 0);
+			first_col = bd->start_col - (bd->west == MPI_PROC_NULL ? 1 : 0);
+			write_grid_part(output_file, children_comm, dimension, 
+				&sub_arr[(first_row - bd->start_row + 1) * sub_arr_pitch + first_col - bd->start_col + 1], 
+				sub_arr_pitch, first_row, first_col, bd->end_row + (bd->south == MPI_PROC_NULL ? 1 : 0) - first_row, 
+				bd->end_col + (bd->east == MPI_PROC_NULL ? 1 : 0) - first_col);
+		} else if (output_file != NULL) {
+			first_row = start_row + (prev_child_id == MPI_PROC_NULL ? 0 : 1);
+			write_grid_part(output_file, children_comm, dimension, grid->rows[halo_rows + first_row - start_row], 
+				sub_arr_pitch, first_row, 0, 
+				start_row + num_sub_arr_elements / dimension - (next_child_id == MPI_PROC_NULL ? 0 : 1) - first_row, 
+				dimension);
+		}
+
+		// child process is finished and sends back its relaxed portion of the 
+		// array to the root process that will stitch it back with the final array
+		// (the root process stitches its own straight away), if the array is printed
+		if (gather_array) {
+			if (bd != NULL && world_rank == root_process_id) {
+				store_block(bd, sub_arr, square_array, dimension);
+			} else if (bd != NULL) {
+				send_block_back(bd, sub_arr);
+			} else if (world_rank == root_process_id) {
+				square_array = stitch_array(square_array, grid->rows[halo_rows], start_row, 
+					start_row + num_sub_arr_elements / dimension - 1, dimension, sub_arr_pitch);
+			} else {
+				// rows are sent without their padding
+				MPI_Type_vector(num_sub_arr_elements / dimension, dimension, sub_arr_pitch, REAL_MPI_TYPE, &rows_type);
+				MPI_Type_commit(&rows_type);
+				MPI_Send(grid->rows[halo_rows], 1, rows_type, root_process_id, RECV_TAG, MPI_COMM_WORLD);
+				MPI_Type_free(&rows_type);
 			}
-			MPI_Wait(&request, &status);
+		}
+		
+		// free up allocated space used for sub arrays
+		if (mg != NULL) {
+			free_multigrid(mg);
+		}
+		if (cg != NULL) {
+			free_conjugate_gradient(cg);
+		}
+		if (bd != NULL) {
+			free_block_decomposition(bd);
+		}
+		if (team != NULL) {
+			free_thread_team(team);
+		}
+		if (ls != NULL) {
+			free_live_segments(ls);
+		}
+		if (coefficient_grid != NULL) {
+			free_grid(coefficient_grid);
+		}
+		if (sg != NULL) {
+			free_single_grid(sg);
+		}
+		if (block_sweeps > 1 && mode == MODE_JACOBI) {
+			free(scratch);
+		}
+		free_grid(grid);
+		MPI_Comm_free(&children_comm);
+	}
+
+	// Executed by root process only: follow the children until the array is relaxed and stitch it back
+	if (world_rank == root_process_id) {
+		// a root process that doesn't relax its share takes part in the reductions of the children's 
+		// largest changes (with no change of its own) to stop with them, and follow their omega, which 
+		// only depends on the largest changes
+		while (world_rank < first_child_id && !is_under_precision) {
+			iteration_count += block_sweeps;
+			if (DEBUG >= 4) printf("\nIteration number %d\n\n", iteration_count);
+			is_under_precision = check_convergence(&convergence, 0.0, iteration_count / block_sweeps, &omega, 
+				precision, dimension);
 		}
 
 		// Relaxation is finished for all children processes (all within precision)
 		// Start stitching the sub arrays back into the final relaxed square array
-		for (id = 1; id < world_size; id++) {
+		if (gather_array && decomposition == DECOMPOSITION_BLOCKS) {
+			gather_blocks(square_array, dimension, dims, first_child_id);
+		}
+		for (id = first_child_id; id < world_size && gather_array && decomposition == DECOMPOSITION_ROWS; id++) {
+			// the root process' own rows are already stitched
+			if (id == root_process_id) {
+				continue;
+			}
+
 			// get back the start row, end row and number of elements to receive that 
 			// were previously calculated and stored in the array
 			start_row = rows_arr[id].start;
@@ -231,20 +1164,70 @@ int main(int argc, char *argv[]) {
 			temp_arr = create_new_array(num_elements_to_receive);
 
 			// receive the relaxed sub array and store it into a temporary array before merging
-			MPI_Recv(temp_arr, num_elements_to_receive, MPI_DOUBLE, id, RECV_TAG, MPI_COMM_WORLD, &status);
+			MPI_Recv(temp_arr, num_elements_to_receive, REAL_MPI_TYPE, id, RECV_TAG, MPI_COMM_WORLD, &status);
 
 			// calculate number of rows received by the child process
 			num_sub_arr_rows = end_row + 1 - start_row;
 
 			// stitch back the received sub array to the main square array
-			square_array = stitch_array(square_array, temp_arr, start_row, end_row, dimension);
+			square_array = stitch_array(square_array, temp_arr, start_row, end_row, dimension, dimension);
 			
 			// free up allocated space used for the temporary array
 			free(temp_arr);
 		}
 		
-		printf("Relaxation successfully completed in %d iterations using %d processes (1 root process and %d children)\n\n", iteration_count, world_size, num_children_processes);
-		if (DEBUG >= 3){
+		if (first_child_id == root_process_id) {
+			printf("Relaxation successfully completed in %d iterations using %d processes (root process relaxing its "
+				"share too)\n\n", iteration_count, world_size);
+		} else {
+			printf("Relaxation successfully completed in %d iterations using %d processes (1 root process and %d "
+				"children)\n\n", iteration_count, world_size, num_children_processes);
+		}
+		warn_if_stalled(convergence.global_diff, precision);
+		if (mode != MODE_CONJUGATE_GRADIENT && !is_cube) {
+			printf("Stencil kernel: %s\n\n", stencil_kernel_name());
+		}
+		if (block_sweeps > 1 && mode == MODE_JACOBI) {
+			printf("Wavefront: %d sweeps per block\n\n", block_sweeps);
+		} else if (block_sweeps > 1) {
+			printf("Deep halo: %d sweeps per exchange of %d rows\n\n", block_sweeps, halo_rows + 1);
+		}
+		if (decomposition == DECOMPOSITION_BLOCKS) {
+			printf("Decomposition: %d x %d blocks\n\n", dims[0], dims[1]);
+		} else if (decomposition == DECOMPOSITION_SLABS) {
+			printf("Decomposition: cube of %d x %d x %d values in %d slabs\n\n", dimension, dimension, dimension, 
+				dims[0]);
+		} else if (decomposition == DECOMPOSITION_PENCILS) {
+			printf("Decomposition: cube of %d x %d x %d values in %d x %d pencils\n\n", dimension, dimension, 
+				dimension, dims[0], dims[1]);
+		}
+		if (num_threads > 1) {
+			printf("Threads: %d per process\n\n", num_threads);
+		}
+		if (!is_plain_laplacian(&op)) {
+			printf("Stencil: %s\n\n", op.name);
+		}
+		if (mask_file != NULL) {
+			printf("Mask: %ld live cells of %ld (%.1f%%), balanced between the children\n\n", num_live_cells, 
+				(long)(dimension - 2) * (dimension - 2), 
+				100.0 * (double)num_live_cells / ((double)(dimension - 2) * (dimension - 2)));
+		}
+		if (convergence.interval > 1 || convergence.non_blocking) {
+			printf("Convergence: checked every %d iterations with %s\n\n", convergence.interval, 
+				convergence.non_blocking ? "MPI_Iallreduce" : "MPI_Allreduce");
+		}
+		if (mixed_precision > 0.0) {
+			printf("Mixed precision: %d single precision iterations to %f\n\n", convergence.single_iterations, 
+				mixed_precision);
+		}
+		if (mode == MODE_SOR) {
+			printf("Relaxation factor (omega): %f\n\n", omega.value);
+		}
+		if (mode == MODE_MULTIGRID) {
+			printf("Multigrid: %c-cycles over %d levels\n\n", cycle_index == 1 ? 'V' : 'W', 
+				count_multigrid_levels(dimension, max_levels));
+		}
+		if (gather_array){
 			printf("Final relaxed square array:\n");
 			print_square_array(dimension, square_array);
 			printf("\n");
@@ -257,125 +1240,14 @@ int main(int argc, char *argv[]) {
 
 		// free up allocated space used for sub arrays and wait for all children process to gracefully finish
 		free(square_array);
-		MPI_Wait(&request, &status);
-	} 
-	
-	// Executed by all children processes
-	else {
-
-		// initialise children processes variables
-		is_under_precision = 0;
-		first_iteration = true;
-		num_sub_arr_elements = 0;
-
-		// get the number of elements from the main array to receive
-		MPI_Recv(&num_sub_arr_elements, 1, MPI_INT, root_process_id, SEND_TAG, MPI_COMM_WORLD, &status);
-		if (DEBUG >= 2) {
-			printf("Hello world from processor #%d out of %d children processes\n\n", world_rank, world_size - 1);
-		}
-		
-		// create 2 arrays to receive the current values and store the new values while relaxing
-		sub_arr = create_new_array(num_sub_arr_elements);
-		new_sub_arr = create_new_array(num_sub_arr_elements);
-		
-		// determine the number of rows the sub array will have
-		num_sub_arr_rows = num_sub_arr_elements / dimension;
-
-		while (!is_under_precision) {
-			// first iteration where the entire sub array is received from the root process
-			if (first_iteration) {
-				
-				// receive the entire portion of th array that will need to be relaxed in this process
-		        MPI_Recv(sub_arr, num_sub_arr_elements, MPI_DOUBLE, root_process_id, SEND_TAG, MPI_COMM_WORLD, &status);
-		        
-				// copy the values in the new values array
-		        for (i = 0; i < num_sub_arr_rows; i++) {
-					for (j = 0; j < dimension; j++) {
-						new_sub_arr[i * dimension + j] = sub_arr[i * dimension + j];
-					}
-				}
-				first_iteration = false;
-			}
-			
-			// future iterations do no send/receive the entire portion of tha array to relax again as it causes unnecessary communication overhead 
-			// from now on, send and receive the first and last rows of the sub array this process is working on
-			else {
-				prev_child_id = world_rank - 1;
-				next_child_id = world_rank + 1;
-				
-				// send first row to the previous child process (unless if this is the first child process)
-				if (world_rank != 1) {
-					MPI_Isend(&sub_arr[dimension], dimension, MPI_DOUBLE, prev_child_id, SEND_TAG, MPI_COMM_WORLD, &request);
-				}
-				
-				//  send last row to the next child process (unless if this is the last child process)
-				if (world_rank != num_children_processes) {
-					MPI_Isend(&sub_arr[(num_sub_arr_rows - 2) * dimension], dimension, MPI_DOUBLE, next_child_id, SEND_TAG, MPI_COMM_WORLD, &request);
-				}
-
-				// receive the first row from the previous child process (unless this is the first child process)
-				if (world_rank != 1) {
-					MPI_Recv(&sub_arr[0], dimension, MPI_DOUBLE, prev_child_id, SEND_TAG, MPI_COMM_WORLD, &status);
-				}
-
-				// receive the last row from the next child process (unless this is the last child process)
-				if (world_rank != num_children_processes) {
-					MPI_Recv(&sub_arr[(num_sub_arr_rows - 1) * dimension], dimension, MPI_DOUBLE, next_child_id, SEND_TAG, MPI_COMM_WORLD, &status);
-				}
-			}
-
-			// perform relaxation on assigned portion of the array
-			is_under_precision = 1;
-			for (i = 1; i < num_sub_arr_rows - 1; i++) {
-				for (j = 1; j < dimension - 1; j++) {
-					// get 4 surrounding values needed to average
-					v_left = sub_arr[i * dimension + (j-1)];
-					v_right = sub_arr[i * dimension + (j+1)];
-					v_up = sub_arr[(i-1) * dimension + j];
-					v_down = sub_arr[(i+1) * dimension + j];
-					
-					// perform the calculation
-					new_value = (v_left + v_right + v_up + v_down) / 4.0;
-					
-					// replace the old value with the new one
-					new_sub_arr[i * dimension + j] = new_value;
-					
-					// check if process went within the precision needed to stop relaxation
-					difference = (double)fabs(sub_arr[i * dimension + j] - new_value);
-					if (difference > precision && is_under_precision == 1) {
-						is_under_precision = 0; // relaxation not finished, need to iterate again
-					}
-					
-					// print current iteration data
-					if (DEBUG >= 4) {
-						printf("\n");
-						print_relaxation_values_data(sub_arr[i * dimension + j], v_left, v_right, v_up, v_down, new_value);
-					}
-				}
-			}
-
-			// tell root process if this process relaxed its portion of the array within the precision
-			MPI_Send(&is_under_precision, 1, MPI_INT, root_process_id, RECV_TAG, MPI_COMM_WORLD);
-
-			// wait for root process to tell this process to stop or continue relaxaing sub array
-			MPI_Recv(&is_under_precision, 1, MPI_INT, root_process_id, SEND_TAG, MPI_COMM_WORLD, &status);
-
-			// update arrays for next iteration
-			temp_sub_arr = sub_arr;
-			sub_arr = new_sub_arr;
-			new_sub_arr = temp_sub_arr;
-		}
-		
-		// child process is finished and sends back its relaxed portion of the 
-		// array to the root process that will stitch it back with the final array
-		MPI_Send(sub_arr, num_sub_arr_elements, MPI_DOUBLE, root_process_id, RECV_TAG, MPI_COMM_WORLD);
-		
-		// free up allocated space used for sub arrays
-		free(sub_arr);
-		free(new_sub_arr);
+	}
+	free(rows_arr);
+	free(live_cells);
+	if (relaxation_comm != MPI_COMM_NULL) {
+		MPI_Comm_free(&relaxation_comm);
 	}
 	
 	// Clean up the MPI environment.
 	MPI_Finalize();
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,443 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ * 
+ * Source file for the geometric multigrid solver run by children processes on
+ * their sub arrays.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <mpi.h>
+#include "real.h"
+#include "array_helpers.h"
+#include "relaxation_helpers.h"
+#include "coarsening.h"
+#include "multigrid.h"
+
+#define PRE_SMOOTHING_SWEEPS 2		// sweeps before visiting the coarser level
+#define POST_SMOOTHING_SWEEPS 2		// sweeps after visiting the coarser level
+#define COARSEST_PRECISION 0.01		// fraction of the precision the coarsest 
+									// level is relaxed to
+#define MAX_COARSEST_SWEEPS 10000	// sweeps after which the coarsest level 
+									// relaxation gives up
+#define MIN_DISTRIBUTED_ROWS 4		// rows each child process needs on a level
+									// for it to stay split between them
+#define SEND_TAG 1001
+
+
+/*
+ * Returns the number of levels used for a square array of the given 
+ * dimension: levels are added until the coarsest level has a single value to 
+ * relax, or until there are max_levels levels (0 for no limit).
+ */
+int count_multigrid_levels(int dimension, int max_levels) {
+	int num_levels = 1;
+	while (dimension > 3 && (max_levels == 0 || num_levels < max_levels)) {
+		dimension = coarse_dimension(dimension);
+		num_levels++;
+	}
+	return num_levels;
+}
+
+
+/*
+ * Allocates the residuals of a level holding num_rows rows pitch values apart,
+ * filled with zeros, with one more row before the first row. Also computes how
+ * the level maps to its coarser level, unless it is the coarsest level.
+ */
+void allocate_residuals(struct multigrid_level* lvl, int is_coarsest) {
+	lvl->residual_rows = create_zero_array((lvl->num_rows + 1) * lvl->pitch);
+	lvl->residuals = &lvl->residual_rows[lvl->pitch];
+	lvl->coarsening = is_coarsest ? NULL : initialise_coarsening(lvl->dimension);
+}
+
+
+/*
+ * Allocates the arrays of a level holding num_rows rows, filled with zeros.
+ */
+void allocate_level(struct multigrid_level* lvl, int dimension, int start_row,
+	int num_rows, int is_coarsest) {
+	lvl->dimension = dimension;
+	lvl->start_row = start_row;
+	lvl->num_rows = num_rows;
+	lvl->pitch = dimension;
+	lvl->values = create_zero_array(num_rows * dimension);
+	lvl->rhs = create_zero_array(num_rows * dimension);
+	allocate_residuals(lvl, is_coarsest);
+}
+
+
+/*
+ * Initialises the levels of the multigrid solver for a child process holding
+ * num_rows rows of the square array (including the rows it only reads), 
+ * starting at row start_row. The finest level relaxes the sub array itself,
+ * whose rows are pitch values apart, coarser levels have rows of dimension 
+ * values one after the other.
+ * Must be called by all children processes at once, as they agree on how many
+ * levels stay split between them.
+ */
+struct multigrid* initialise_multigrid(real* sub_arr, int num_rows, 
+	int dimension, int pitch, int start_row, int prev_child_id, int next_child_id, 
+	MPI_Comm comm, int max_levels, int cycle_index, double precision) {
+	struct multigrid *mg;
+	int first_own_row, last_own_row, own_rows, min_own_rows, comm_size, l, id;
+	int gathered_start_row, gathered_own_rows;
+
+	mg = malloc(sizeof(struct multigrid));
+	if (mg == NULL) {
+		fprintf(stderr, "Failed to allocate space for the multigrid levels.\n");
+		exit(EXIT_FAILURE);
+	}
+	mg->num_levels = count_multigrid_levels(dimension, max_levels);
+	mg->cycle_index = cycle_index;
+	mg->precision = precision;
+	mg->prev_child_id = prev_child_id;
+	mg->next_child_id = next_child_id;
+	mg->comm = comm;
+	mg->gather_counts = NULL;
+	mg->gather_displs = NULL;
+	mg->scatter_counts = NULL;
+	mg->scatter_displs = NULL;
+	MPI_Comm_rank(comm, &mg->comm_rank);
+	MPI_Comm_size(comm, &comm_size);
+	mg->levels = malloc((long unsigned int) mg->num_levels * sizeof(struct multigrid_level));
+	mg->gathered = malloc((long unsigned int) mg->num_levels * sizeof(struct multigrid_level));
+	if (mg->levels == NULL || mg->gathered == NULL) {
+		fprintf(stderr, "Failed to allocate space for the multigrid levels.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// the finest level relaxes the sub array
+	mg->levels[0].dimension = dimension;
+	mg->levels[0].start_row = start_row;
+	mg->levels[0].num_rows = num_rows;
+	mg->levels[0].pitch = pitch;
+	mg->levels[0].values = sub_arr;
+	mg->levels[0].rhs = NULL;
+	allocate_residuals(&mg->levels[0], mg->num_levels == 1);
+
+	// coarser levels hold the coarse rows whose first fine row is one of the process's own rows
+	first_own_row = start_row + 1;
+	last_own_row = start_row + num_rows - 2;
+	mg->num_distributed = mg->num_levels;
+	for (l = 1; l < mg->num_levels; l++) {
+		dimension = coarse_dimension(dimension);
+		first_own_row = mg->levels[l - 1].coarsening->cell[first_own_row - 1] + 1;
+		last_own_row = mg->levels[l - 1].coarsening->cell[last_own_row];
+		own_rows = last_own_row - first_own_row + 1;
+		if (own_rows < 0) {
+			// a single fine row may have no coarse row starting on it
+			own_rows = 0;
+			last_own_row = first_own_row - 1;
+		}
+		allocate_level(&mg->levels[l], dimension, first_own_row - 1, own_rows + 2, l == mg->num_levels - 1);
+
+		// stop splitting levels once a process would have too few rows
+		MPI_Allreduce(&own_rows, &min_own_rows, 1, MPI_INT, MPI_MIN, comm);
+		if (min_own_rows < MIN_DISTRIBUTED_ROWS) {
+			mg->num_distributed = l;
+			break;
+		}
+	}
+
+	// the first child process holds the whole of the gathered levels
+	if (mg->num_distributed < mg->num_levels) {
+		l = mg->num_distributed;
+		if (mg->comm_rank == 0) {
+			for (; l < mg->num_levels; l++) {
+				allocate_level(&mg->gathered[l], dimension, 0, dimension, l == mg->num_levels - 1);
+				dimension = coarse_dimension(dimension);
+			}
+			mg->gather_counts = malloc((long unsigned int) comm_size * sizeof(int));
+			mg->gather_displs = malloc((long unsigned int) comm_size * sizeof(int));
+			mg->scatter_counts = malloc((long unsigned int) comm_size * sizeof(int));
+			mg->scatter_displs = malloc((long unsigned int) comm_size * sizeof(int));
+		}
+
+		// the first child process needs to know which rows each process holds
+		l = mg->num_distributed;
+		gathered_start_row = mg->levels[l].start_row;
+		gathered_own_rows = mg->levels[l].num_rows - 2;
+		MPI_Gather(&gathered_start_row, 1, MPI_INT, mg->scatter_displs, 1, MPI_INT, 0, comm);
+		MPI_Gather(&gathered_own_rows, 1, MPI_INT, mg->gather_counts, 1, MPI_INT, 0, comm);
+		if (mg->comm_rank == 0) {
+			for (id = 0; id < comm_size; id++) {
+				mg->scatter_displs[id] *= mg->levels[l].dimension;
+				mg->gather_displs[id] = mg->scatter_displs[id] + mg->levels[l].dimension;
+				mg->scatter_counts[id] = (mg->gather_counts[id] + 2) * mg->levels[l].dimension;
+				mg->gather_counts[id] *= mg->levels[l].dimension;
+			}
+		}
+	}
+
+	return mg;
+}
+
+
+/*
+ * Relaxes a level with red-black sweeps using the relaxation factor w, sharing
+ * boundary rows with the neighbouring processes before every colour.
+ * Returns the largest difference between an old and a new value.
+ */
+double smooth(struct multigrid_level* lvl, int sweeps, double w, 
+	int prev_child_id, int next_child_id) {
+	double max_diff = 0.0;
+	double diff;
+	int s, colour;
+
+	for (s = 0; s < sweeps; s++) {
+		for (colour = 0; colour < 2; colour++) {
+			exchange_boundary_rows(lvl->values, lvl->num_rows, lvl->pitch, prev_child_id, next_child_id);
+			diff = red_black_sweep(lvl->values, lvl->rhs, lvl->num_rows, lvl->dimension, lvl->pitch, lvl->start_row, 
+				colour, w);
+			if (diff > max_diff) {
+				max_diff = diff;
+			}
+		}
+	}
+	return max_diff;
+}
+
+
+/*
+ * Relaxes the coarsest level until its values change by less than a fraction
+ * of the precision, using red-black SOR with the optimal relaxation factor.
+ * If the level is split between the children processes, they agree on when to
+ * stop through a reduction.
+ * Returns the largest difference between an old and a new value during the 
+ * last sweep.
+ */
+double relax_coarsest(struct multigrid* mg, struct multigrid_level* lvl, 
+	int prev_child_id, int next_child_id, int is_distributed) {
+	double w = optimal_omega(lvl->dimension);
+	double max_diff;
+	int sweeps = 0;
+
+	do {
+		max_diff = smooth(lvl, 1, w, prev_child_id, next_child_id);
+		if (is_distributed) {
+			MPI_Allreduce(MPI_IN_PLACE, &max_diff, 1, MPI_DOUBLE, MPI_MAX, mg->comm);
+		}
+		sweeps++;
+	} while (max_diff > mg->precision * COARSEST_PRECISION && sweeps < MAX_COARSEST_SWEEPS);
+	return max_diff;
+}
+
+
+/*
+ * Sends the residuals of the second to last own row of a level to the next 
+ * child process, and receives the residuals of the second row before the own
+ * rows from the previous one, in the row before the residuals. A process with
+ * a single own row sends the row it received from the previous process 
+ * instead, so the residuals' boundary rows must already be up to date.
+ */
+void exchange_second_residual_rows(struct multigrid_level* lvl, 
+	int prev_child_id, int next_child_id) {
+	MPI_Sendrecv(&lvl->residuals[(lvl->num_rows - 3) * lvl->pitch], lvl->pitch, REAL_MPI_TYPE, next_child_id, SEND_TAG, 
+		lvl->residual_rows, lvl->pitch, REAL_MPI_TYPE, prev_child_id, SEND_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+}
+
+
+/*
+ * Computes the residuals f - A u of the process's own rows of the fine level,
+ * then restricts them to the right hand side of the process's own rows of the
+ * coarse level (with full weighting when n - 1 is even), and resets their 
+ * corrections to 0. The right hand side is the weighted sum of the residuals
+ * rather than their average, as the coarser level's cells are about twice as
+ * far apart.
+ */
+void restrict_residuals(struct multigrid_level* fine, 
+	struct multigrid_level* coarse, int prev_child_id, int next_child_id) {
+	struct coarsening *m = fine->coarsening;
+	real *u = fine->values;
+	real *r = fine->residuals;
+	int n = fine->dimension;
+	int pitch = fine->pitch;
+	int i, j, gi, fi, fj;
+	double wi, sum;
+
+	// residuals of the fine level, using up to date boundary rows
+	exchange_boundary_rows(u, fine->num_rows, pitch, prev_child_id, next_child_id);
+	for (i = 1; i < fine->num_rows - 1; i++) {
+		for (j = 1; j < n - 1; j++) {
+			r[i * pitch + j] = (real)((fine->rhs != NULL ? fine->rhs[i * pitch + j] : 0.0) - 4.0 * u[i * pitch + j] + 
+				u[i * pitch + j - 1] + u[i * pitch + j + 1] + u[(i - 1) * pitch + j] + u[(i + 1) * pitch + j]);
+		}
+	}
+	exchange_boundary_rows(r, fine->num_rows, pitch, prev_child_id, next_child_id);
+	if ((n - 1) % 2 != 0) {
+		exchange_second_residual_rows(fine, prev_child_id, next_child_id);
+	}
+
+	// restriction to the coarse level, from global fine rows m->first to m->last of each coarse row
+	for (i = 1; i < coarse->num_rows - 1; i++) {
+		gi = coarse->start_row + i;
+		for (j = 1; j < coarse->dimension - 1; j++) {
+			sum = 0.0;
+			for (fi = m->first[gi]; fi <= m->last[gi]; fi++) {
+				wi = restriction_weight(m, fi, gi);
+				for (fj = m->first[j]; fj <= m->last[j]; fj++) {
+					sum += wi * restriction_weight(m, fj, j) * r[(fi - fine->start_row) * pitch + fj];
+				}
+			}
+			coarse->rhs[i * coarse->pitch + j] = (real)sum;
+			coarse->values[i * coarse->pitch + j] = 0.0;
+		}
+	}
+}
+
+
+/*
+ * Interpolates the coarse level's corrections bilinearly and adds them to the
+ * process's own rows of the fine level. The coarse level's boundary rows must 
+ * be up to date.
+ */
+void prolongate_corrections(struct multigrid_level* coarse, 
+	struct multigrid_level* fine) {
+	struct coarsening *m = fine->coarsening;
+	real *e = coarse->values;
+	int n = coarse->pitch;
+	int i, j, gi, ci, cj;
+	double wi, wj;
+
+	for (i = 1; i < fine->num_rows - 1; i++) {
+		gi = fine->start_row + i;
+		ci = m->cell[gi] - coarse->start_row;
+		wi = m->weight[gi];
+		for (j = 1; j < fine->dimension - 1; j++) {
+			cj = m->cell[j];
+			wj = m->weight[j];
+			fine->values[i * fine->pitch + j] += (real)((1 - wi) * ((1 - wj) * e[ci * n + cj] + wj * e[ci * n + cj + 1]) + 
+				wi * ((1 - wj) * e[(ci + 1) * n + cj] + wj * e[(ci + 1) * n + cj + 1]));
+		}
+	}
+}
+
+
+/*
+ * Runs one multigrid cycle from the given gathered level on the first child 
+ * process alone, the same way as multigrid_cycle.
+ */
+void gathered_cycle(struct multigrid* mg, int level) {
+	struct multigrid_level *fine = &mg->gathered[level];
+	struct multigrid_level *coarse = &mg->gathered[level + 1];
+	int c;
+
+	if (level == mg->num_levels - 1) {
+		relax_coarsest(mg, fine, MPI_PROC_NULL, MPI_PROC_NULL, 0);
+		return;
+	}
+
+	smooth(fine, PRE_SMOOTHING_SWEEPS, 1.0, MPI_PROC_NULL, MPI_PROC_NULL);
+	restrict_residuals(fine, coarse, MPI_PROC_NULL, MPI_PROC_NULL);
+	for (c = 0; c < mg->cycle_index; c++) {
+		gathered_cycle(mg, level + 1);
+	}
+	prolongate_corrections(coarse, fine);
+	smooth(fine, POST_SMOOTHING_SWEEPS, 1.0, MPI_PROC_NULL, MPI_PROC_NULL);
+}
+
+
+/*
+ * Gathers the right hand side of the first gathered level on the first child
+ * process, which runs the coarse cycles alone, then scatters the corrections 
+ * back, including the boundary rows each process needs to interpolate them.
+ */
+void solve_gathered(struct multigrid* mg) {
+	struct multigrid_level *lvl = &mg->levels[mg->num_distributed];
+	struct multigrid_level *full = &mg->gathered[mg->num_distributed];
+	int n = lvl->dimension;
+	int i, c;
+
+	MPI_Gatherv(&lvl->rhs[n], (lvl->num_rows - 2) * n, REAL_MPI_TYPE, 
+		mg->comm_rank == 0 ? full->rhs : NULL, mg->gather_counts, mg->gather_displs, REAL_MPI_TYPE, 0, mg->comm);
+	if (mg->comm_rank == 0) {
+		for (i = 0; i < n * n; i++) {
+			full->values[i] = 0.0;
+		}
+		for (c = 0; c < mg->cycle_index; c++) {
+			gathered_cycle(mg, mg->num_distributed);
+		}
+	}
+	MPI_Scatterv(mg->comm_rank == 0 ? full->values : NULL, mg->scatter_counts, mg->scatter_displs, REAL_MPI_TYPE, 
+		lvl->values, lvl->num_rows * n, REAL_MPI_TYPE, 0, mg->comm);
+}
+
+
+/*
+ * Runs one multigrid cycle from the given level: smooths, restricts the 
+ * residuals, runs cycle_index cycles on the coarser level (1: V-cycle, 
+ * 2: W-cycle), adds the interpolated corrections and smooths again. The 
+ * coarsest level is relaxed until it has converged instead.
+ * Must be called by all children processes at once.
+ * Returns the largest difference between an old and a new value of the 
+ * process's rows during the last sweep.
+ */
+double multigrid_cycle(struct multigrid* mg, int level) {
+	struct multigrid_level *fine = &mg->levels[level];
+	struct multigrid_level *coarse = &mg->levels[level + 1];
+	int c;
+
+	if (level == mg->num_levels - 1) {
+		return relax_coarsest(mg, fine, mg->prev_child_id, mg->next_child_id, 1);
+	}
+
+	smooth(fine, PRE_SMOOTHING_SWEEPS, 1.0, mg->prev_child_id, mg->next_child_id);
+	restrict_residuals(fine, coarse, mg->prev_child_id, mg->next_child_id);
+	if (level + 1 < mg->num_distributed) {
+		for (c = 0; c < mg->cycle_index; c++) {
+			multigrid_cycle(mg, level + 1);
+		}
+		exchange_boundary_rows(coarse->values, coarse->num_rows, coarse->pitch, mg->prev_child_id, mg->next_child_id);
+	} else {
+		solve_gathered(mg);
+	}
+	prolongate_corrections(coarse, fine);
+	smooth(fine, POST_SMOOTHING_SWEEPS - 1, 1.0, mg->prev_child_id, mg->next_child_id);
+	return smooth(fine, 1, 1.0, mg->prev_child_id, mg->next_child_id);
+}
+
+
+/*
+ * Frees the residuals of a level and its mapping to the coarser level.
+ */
+void free_level_residuals(struct multigrid_level* lvl) {
+	free(lvl->residual_rows);
+	if (lvl->coarsening != NULL) {
+		free_coarsening(lvl->coarsening);
+	}
+}
+
+
+/*
+ * Frees the arrays of the levels (the finest level's values are the sub array,
+ * which is freed separately).
+ */
+void free_multigrid(struct multigrid* mg) {
+	int l, last_held_level;
+
+	last_held_level = mg->num_distributed < mg->num_levels ? mg->num_distributed : mg->num_levels - 1;
+	for (l = 0; l <= last_held_level; l++) {
+		if (l > 0) {
+			free(mg->levels[l].values);
+			free(mg->levels[l].rhs);
+		}
+		free_level_residuals(&mg->levels[l]);
+	}
+	if (mg->num_distributed < mg->num_levels && mg->comm_rank == 0) {
+		for (l = mg->num_distributed; l < mg->num_levels; l++) {
+			free(mg->gathered[l].values);
+			free(mg->gathered[l].rhs);
+			free_level_residuals(&mg->gathered[l]);
+		}
+		free(mg->gather_counts);
+		free(mg->gather_displs);
+		free(mg->scatter_counts);
+		free(mg->scatter_displs);
+	}
+	free(mg->levels);
+	free(mg->gathered);
+	free(mg);
+}
@@ -0,0 +1,56 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ * 
+ * Header file for the geometric multigrid solver run by children processes on
+ * their sub arrays.
+ */
+
+
+struct multigrid_level {
+	// structure used to keep track of the rows of one level held by a process
+	int dimension;		// dimension of the square array on this level
+	int start_row;		// index on this level of the first row held
+	int num_rows;		// number of rows held, including the 2 boundary rows
+	int pitch;			// values from the start of a row to the next one
+	real *values;		// values (finest level) or corrections
+	real *rhs;			// right hand side (NULL on the finest level)
+	real *residuals;	// residuals restricted to the coarser level
+	real *residual_rows;	// allocation of the residuals, from the row before them
+	struct coarsening *coarsening;	// mapping to the coarser level (NULL if none)
+};
+
+struct multigrid {
+	// structure used to keep track of the levels and how they are split
+	int num_levels;			// number of levels, the finest level is level 0
+	int num_distributed;	// levels split between children, coarser levels are
+							// gathered on the first child process
+	int cycle_index;		// coarser level visits per cycle (1: V, 2: W)
+	double precision;		// precision the finest level is relaxed to
+	int prev_child_id;		// previous child process (MPI_PROC_NULL if none)
+	int next_child_id;		// next child process (MPI_PROC_NULL if none)
+	MPI_Comm comm;			// communicator of the children processes
+	int comm_rank;			// rank of this process in comm
+	int *gather_counts;		// elements gathered from each child process
+	int *gather_displs;		// where they go in the gathered level
+	int *scatter_counts;	// elements scattered to each child process
+	int *scatter_displs;	// where they come from in the gathered level
+	struct multigrid_level *levels;		// rows of the levels held by this process
+	struct multigrid_level *gathered;	// gathered levels (first child only)
+};
+
+
+int count_multigrid_levels(int dimension, int max_levels);
+
+
+struct multigrid* initialise_multigrid(real* sub_arr, int num_rows, 
+									   int dimension, int pitch, int start_row, 
+									   int prev_child_id, int next_child_id, 
+									   MPI_Comm comm, int max_levels, 
+									   int cycle_index, double precision);
+
+
+double multigrid_cycle(struct multigrid* mg, int level);
+
+
+void free_multigrid(struct multigrid* mg);
@@ -9,16 +9,19 @@
  */
  
 #include <stdio.h>
+#include "real.h"
 #include "print_helpers.h"
 
 
 /*
  * Prints the initial data values used to initiate the program.
  */
-void print_parameters(int dimension, int num_processes, double precision) {
+void print_parameters(int dimension, int num_processes, double precision, 
+	const char* mode_name) {
 	printf("\nArray dimension: %d\n", dimension);
 	printf("World size: %d\n", num_processes);
-	printf("Precision: %f\n", precision);
+	printf("Precision: %f (%s precision values)\n", precision, REAL_NAME);
+	printf("Relaxation mode: %s\n", mode_name);
 	printf("\n");
 }
 
@@ -26,7 +29,7 @@ void print_parameters(int dimension, int num_processes, double precision) {
 /*
  * Prints a square array to the command line.
  */
-void print_square_array(int dim, double* sq_array) {
+void print_square_array(int dim, real* sq_array) {
 	int i, j;
 	for (i = 0; i < dim; i++) {
  		for (j = 0; j < dim; j++) {
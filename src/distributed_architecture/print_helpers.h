@@ -9,10 +9,10 @@
  */
 
  
- void print_parameters(int dimension, int num_processes, double precision);
+ void print_parameters(int dimension, int num_processes, double precision, const char* mode_name);
  
  
- void print_square_array(int dimension, double* sq_array);
+ void print_square_array(int dimension, real* sq_array);
   
  
  void print_relaxation_values_data(double old, double l, double r, double u, double d, double new);
\ No newline at end of file
@@ -0,0 +1,396 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ * 
+ * Source file for functions used by children processes to relax their portion
+ * of the square array.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mpi.h>
+#include "real.h"
+#include "array_helpers.h"
+#include "relaxation_helpers.h"
+#include "print_helpers.h"
+#include "stencil_kernel.h"
+#include "wavefront.h"
+
+#define SEND_TAG 1001
+#define OMEGA_ADAPT_SWEEPS 20		// sweeps between two estimates of omega
+#define OMEGA_ADAPT_TOLERANCE 0.001	// smallest omega increase to keep adapting
+
+extern int DEBUG;
+
+
+/*
+ * Sends the first and last rows a child process relaxes to the previous and 
+ * next children processes, and receives their rows in the sub array's first 
+ * and last rows (which are only read from when relaxing). Rows are pitch 
+ * values apart, and sent with their padding.
+ * The first child process has no previous process and the last child process 
+ * has no next process (MPI_PROC_NULL), as their first/last rows are boundaries
+ * of the array, in which case nothing is sent or received.
+ */
+void exchange_boundary_rows(real* sub_arr, int num_rows, int pitch, 
+	int prev_child_id, int next_child_id) {
+	exchange_halo_rows(sub_arr, num_rows, pitch, 1, prev_child_id, next_child_id);
+}
+
+
+/*
+ * Same as exchange_boundary_rows, but with the given number of rows on each 
+ * side: the first and last depth rows of the sub array are received from the 
+ * previous and next children processes, which get the depth rows after and 
+ * before them. Used by the wavefront, which needs as many rows around the rows
+ * a child process relaxes as it runs sweeps at a time.
+ */
+void exchange_halo_rows(real* sub_arr, int num_rows, int pitch, int depth, 
+	int prev_child_id, int next_child_id) {
+	MPI_Request requests[4];
+
+	// the rows that were sent will be overwritten by the next sweep
+	start_halo_exchange(sub_arr, num_rows, pitch, depth, prev_child_id, next_child_id, requests);
+	MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+}
+
+
+/*
+ * Same as exchange_boundary_rows, for the rows of length values of the single
+ * precision copy of the sub array relaxed by the mixed precision mode (see 
+ * common/mixed_precision.c).
+ */
+void exchange_single_rows(float* const* rows, int num_rows, int length, 
+	int prev_child_id, int next_child_id) {
+	MPI_Request requests[4];
+
+	MPI_Irecv(rows[0], length, MPI_FLOAT, prev_child_id, SEND_TAG, MPI_COMM_WORLD, &requests[0]);
+	MPI_Irecv(rows[num_rows - 1], length, MPI_FLOAT, next_child_id, SEND_TAG, MPI_COMM_WORLD, &requests[1]);
+	MPI_Isend(rows[1], length, MPI_FLOAT, prev_child_id, SEND_TAG, MPI_COMM_WORLD, &requests[2]);
+	MPI_Isend(rows[num_rows - 2], length, MPI_FLOAT, next_child_id, SEND_TAG, MPI_COMM_WORLD, &requests[3]);
+	MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+}
+
+
+/*
+ * Starts exchanging the first and last depth rows of the sub array with the 
+ * previous and next children processes (see exchange_halo_rows) without 
+ * waiting for the rows to arrive. Rows that don't need the received rows can 
+ * be relaxed in the meantime, as long as the rows that are sent aren't 
+ * changed until the 4 requests are finished.
+ */
+void start_halo_exchange(real* sub_arr, int num_rows, int pitch, int depth, 
+	int prev_child_id, int next_child_id, MPI_Request* requests) {
+	int count = depth * pitch;
+
+	// receive the first rows from the previous child process and the last rows from the next child process
+	MPI_Irecv(&sub_arr[0], count, REAL_MPI_TYPE, prev_child_id, SEND_TAG, MPI_COMM_WORLD, &requests[0]);
+	MPI_Irecv(&sub_arr[(num_rows - depth) * pitch], count, REAL_MPI_TYPE, next_child_id, SEND_TAG, MPI_COMM_WORLD, &requests[1]);
+
+	// send first rows to the previous child process and last rows to the next child process
+	MPI_Isend(&sub_arr[depth * pitch], count, REAL_MPI_TYPE, prev_child_id, SEND_TAG, MPI_COMM_WORLD, &requests[2]);
+	MPI_Isend(&sub_arr[(num_rows - 2 * depth) * pitch], count, REAL_MPI_TYPE, next_child_id, SEND_TAG, MPI_COMM_WORLD, &requests[3]);
+}
+
+
+/*
+ * Relaxes the rows of the sub array (except its first and last rows) using the
+ * Jacobi method: new values are computed from the values in sub_arr and stored
+ * in new_sub_arr, a whole row at a time by the stencil kernel. Rows hold 
+ * dimension values and are pitch values apart.
+ * Returns the largest difference between an old and a new value.
+ */
+double jacobi_sweep(real* sub_arr, real* new_sub_arr, int num_rows, 
+	int dimension, int pitch) {
+	return jacobi_rows(sub_arr, new_sub_arr, 1, num_rows - 1, dimension, pitch);
+}
+
+
+/*
+ * Same as jacobi_sweep, but starts exchanging the first and last rows with 
+ * the previous and next children processes first, relaxes the rows that don't
+ * need the received rows while they are on their way, and only waits for them
+ * before relaxing the first and last rows the child process relaxes. This 
+ * hides the time taken by the exchange behind the relaxation of the other 
+ * rows.
+ */
+double overlapped_jacobi_sweep(real* sub_arr, real* new_sub_arr, int num_rows, 
+	int dimension, int pitch, int prev_child_id, int next_child_id) {
+	MPI_Request requests[4];
+	double max_diff, difference;
+
+	start_halo_exchange(sub_arr, num_rows, pitch, 1, prev_child_id, next_child_id, requests);
+	max_diff = jacobi_rows(sub_arr, new_sub_arr, 2, num_rows - 2, dimension, pitch);
+	MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+
+	// relax the first and last rows (which are the same row if there is only one)
+	difference = jacobi_rows(sub_arr, new_sub_arr, 1, 2, dimension, pitch);
+	max_diff = difference > max_diff ? difference : max_diff;
+	if (num_rows > 3) {
+		difference = jacobi_rows(sub_arr, new_sub_arr, num_rows - 2, num_rows - 1, dimension, pitch);
+		max_diff = difference > max_diff ? difference : max_diff;
+	}
+	return max_diff;
+}
+
+
+/*
+ * Relaxes the rows first_row to end_row (excluded) of the sub array with the 
+ * Jacobi method (see jacobi_sweep).
+ */
+double jacobi_rows(real* sub_arr, real* new_sub_arr, int first_row, 
+	int end_row, int dimension, int pitch) {
+	double max_diff = 0.0;
+	double difference;
+	int i, j;
+
+	for (i = first_row; i < end_row; i++) {
+		// average the 4 surrounding values of the whole row at once
+		difference = stencil_row(&sub_arr[(i-1) * pitch], &sub_arr[i * pitch], 
+			&sub_arr[(i+1) * pitch], &new_sub_arr[i * pitch], dimension);
+		
+		// keep track of the largest change, used to decide when to stop relaxation
+		if (difference > max_diff) {
+			max_diff = difference;
+		}
+		
+		// print current iteration data
+		if (DEBUG >= 4) {
+			for (j = 1; j < dimension - 1; j++) {
+				printf("\n");
+				print_relaxation_values_data(sub_arr[i * pitch + j], sub_arr[i * pitch + (j-1)], 
+					sub_arr[i * pitch + (j+1)], sub_arr[(i-1) * pitch + j], 
+					sub_arr[(i+1) * pitch + j], new_sub_arr[i * pitch + j]);
+			}
+		}
+	}
+
+	return max_diff;
+}
+
+
+/*
+ * Runs depth Jacobi sweeps over the rows of the sub array (which has depth 
+ * rows received from the previous and next children processes on each side) 
+ * with the wavefront (see wavefront.c), writing the values after the last 
+ * sweep of the rows the child process relaxes to new_rows. rows and new_rows 
+ * point to each row of the sub array and of the array of new values.
+ * The first and last children processes have a boundary of the array right 
+ * before and after their rows instead, which is never relaxed.
+ * Returns the largest difference between an old and a new value in the last 
+ * sweep.
+ */
+double jacobi_wavefront(real** rows, real** new_rows, int num_rows, 
+	int dimension, int depth, int prev_child_id, int next_child_id, 
+	real* scratch) {
+	int lowest_row = prev_child_id == MPI_PROC_NULL ? depth - 1 : 0;
+	int highest_row = next_child_id == MPI_PROC_NULL ? num_rows - depth : num_rows - 1;
+
+	return wavefront_sweeps(rows, new_rows, depth, num_rows - depth, lowest_row, highest_row, 
+		dimension, depth, scratch);
+}
+
+
+/*
+ * Relaxes the cells of the given colour of the sub array (except its first and
+ * last rows) in place. If rhs is not NULL, its values are added to the 4 
+ * neighbours before averaging, which relaxes the Poisson equation solved by 
+ * the coarse levels of multigrid. Cells are coloured like a chess board using their 
+ * position in the full square array: red cells (colour 0) have an even row + 
+ * column index, black cells (colour 1) an odd one. start_row is the index of
+ * the sub array's first row in the full square array.
+ * Values move from their old value towards the average of their neighbours by
+ * the relaxation factor omega (1 replaces them with the average, as in 
+ * Gauss-Seidel, and values above 1 over-relax them, as in SOR). Each row is 
+ * relaxed by the stencil kernel.
+ * Returns the largest difference between an old and a new value.
+ */
+double red_black_sweep(real* sub_arr, real* rhs, int num_rows, 
+	int dimension, int pitch, int start_row, int colour, double omega) {
+	return red_black_rows(sub_arr, rhs, 1, num_rows - 1, dimension, pitch, start_row, colour, omega);
+}
+
+
+/*
+ * Same as red_black_sweep (without right hand side), but overlaps the 
+ * exchange of the first and last rows with the relaxation of the other rows 
+ * (see overlapped_jacobi_sweep). Cells of one colour only read cells of the 
+ * other colour, so the rows that are sent don't change while they are sent.
+ */
+double overlapped_red_black_sweep(real* sub_arr, int num_rows, int dimension, 
+	int pitch, int start_row, int colour, double omega, int prev_child_id, int next_child_id) {
+	MPI_Request requests[4];
+	double max_diff, difference;
+
+	start_halo_exchange(sub_arr, num_rows, pitch, 1, prev_child_id, next_child_id, requests);
+	max_diff = red_black_rows(sub_arr, NULL, 2, num_rows - 2, dimension, pitch, start_row, colour, omega);
+	MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+
+	// relax the first and last rows (which are the same row if there is only one)
+	difference = red_black_rows(sub_arr, NULL, 1, 2, dimension, pitch, start_row, colour, omega);
+	max_diff = difference > max_diff ? difference : max_diff;
+	if (num_rows > 3) {
+		difference = red_black_rows(sub_arr, NULL, num_rows - 2, num_rows - 1, dimension, pitch, start_row, colour, omega);
+		max_diff = difference > max_diff ? difference : max_diff;
+	}
+	return max_diff;
+}
+
+
+/*
+ * Runs sweeps red-black sweeps over the rows of a child process with only one
+ * exchange of rows, before them, of depth = 2 * sweeps rows with each 
+ * neighbour (the sub array holding depth rows on each side of the rows it 
+ * relaxes, start_row being the index in the full square array of the last of
+ * the rows before them).
+ * The rows of the neighbours it holds are relaxed again along with its own 
+ * rows, every colour update making one more of them out of date on each side,
+ * so each update relaxes one row fewer on each side than the previous one and
+ * the last one only relaxes the process' own rows. Rows of the neighbours are
+ * relaxed exactly as their own process relaxes them, so the largest change of
+ * the last sweep is the same as with an exchange before every colour update.
+ * Returns the largest difference between an old and a new value of the last 
+ * sweep.
+ */
+double red_black_block_sweeps(real* sub_arr, int num_rows, int dimension, 
+	int pitch, int depth, int start_row, double omega, int prev_child_id, int next_child_id, 
+	int sweeps) {
+	// the first and last children hold the boundaries of the array, with empty rows beyond them
+	int lowest_row = prev_child_id == MPI_PROC_NULL ? depth : 1;
+	int highest_row = next_child_id == MPI_PROC_NULL ? num_rows - depth : num_rows - 1;
+	int first_row_index = start_row - depth + 1 + 2 * depth; // index of the first row, made positive (same parity)
+	double max_diff = 0.0;
+	double difference;
+	int update, reach, first_row, end_row;
+
+	for (update = 0; update < 2 * sweeps; update++) {
+		// rows of the neighbours relaxed on each side by this colour update
+		reach = 2 * sweeps - 1 - update;
+		first_row = depth - reach > lowest_row ? depth - reach : lowest_row;
+		end_row = num_rows - depth + reach < highest_row ? num_rows - depth + reach : highest_row;
+		difference = red_black_rows(sub_arr, NULL, first_row, end_row, dimension, pitch, first_row_index, update % 2, omega);
+		if (update >= 2 * sweeps - 2 && difference > max_diff) {
+			max_diff = difference;
+		}
+	}
+	return max_diff;
+}
+
+
+/*
+ * Relaxes the cells of the given colour of the rows first_row to end_row 
+ * (excluded) of the sub array in place (see red_black_sweep).
+ */
+double red_black_rows(real* sub_arr, real* rhs, int first_row, int end_row, 
+	int dimension, int pitch, int start_row, int colour, double omega) {
+	double max_diff = 0.0;
+	double difference;
+	real *old_row = NULL;
+	int i, j, first;
+
+	// old values are only kept to print them
+	if (DEBUG >= 4) {
+		old_row = create_new_array(dimension);
+	}
+
+	for (i = first_row; i < end_row; i++) {
+		// first column with the right colour in this row
+		first = 1 + (start_row + i + 1 + colour) % 2;
+		if (DEBUG >= 4) {
+			memcpy(old_row, &sub_arr[i * pitch], (long unsigned int) dimension * sizeof(real));
+		}
+
+		// relax the cells of the row with the right colour in place
+		difference = stencil_row_colour(&sub_arr[(i-1) * pitch], &sub_arr[i * pitch], 
+			&sub_arr[(i+1) * pitch], rhs != NULL ? &rhs[i * pitch] : NULL, dimension, first, omega);
+
+		// keep track of the largest change, used to decide when to stop relaxation
+		if (difference > max_diff) {
+			max_diff = difference;
+		}
+
+		// print current iteration data
+		if (DEBUG >= 4) {
+			for (j = first; j < dimension - 1; j += 2) {
+				printf("\n");
+				print_relaxation_values_data(old_row[j], sub_arr[i * pitch + (j-1)], 
+					sub_arr[i * pitch + (j+1)], sub_arr[(i-1) * pitch + j], 
+					sub_arr[(i+1) * pitch + j], sub_arr[i * pitch + j]);
+			}
+		}
+	}
+
+	free(old_row);
+	return max_diff;
+}
+
+
+/*
+ * Returns the theoretically optimal relaxation factor for relaxing a square
+ * array of the given dimension with fixed boundaries: 2 / (1 + sin(pi / n)),
+ * where n is the number of intervals between the boundaries.
+ */
+double optimal_omega(int dimension) {
+	return 2.0 / (1.0 + sin(M_PI / (double)(dimension - 1)));
+}
+
+
+/*
+ * Sets the relaxation factor used by the first sweep: the theoretical optimum
+ * if it is picked automatically, 1 if it is adapted while relaxing.
+ */
+void initialise_omega(struct omega_adapter* omega, int dimension) {
+	omega->adapting = omega->choice == OMEGA_ADAPT;
+	omega->window_start_diff = 0.0;
+	if (omega->choice == OMEGA_AUTO) {
+		omega->value = optimal_omega(dimension);
+	} else if (omega->choice == OMEGA_ADAPT) {
+		omega->value = 1.0;
+	}
+}
+
+
+/*
+ * Returns whether the relaxation factor is estimated again after the given 
+ * iteration, which needs the largest change of all processes.
+ */
+int omega_adapts_after(struct omega_adapter* omega, int iteration) {
+	return omega->adapting && iteration % OMEGA_ADAPT_SWEEPS == 0;
+}
+
+
+/*
+ * Adapts the relaxation factor every OMEGA_ADAPT_SWEEPS sweeps from the rate 
+ * lambda at which the largest change decreased over the last sweeps. For 
+ * red-black ordering, lambda and the Jacobi spectral radius mu are related by
+ * (lambda + omega - 1)^2 = lambda * omega^2 * mu^2, and the optimal factor is
+ * 2 / (1 + sqrt(1 - mu^2)). Omega only ever increases, and stops being adapted
+ * once estimates settle.
+ * Only depends on the largest change of each sweep, so every process that 
+ * calls it with the same values picks the same omega.
+ */
+void adapt_omega(struct omega_adapter* omega, int iteration, double max_diff, 
+	int dimension) {
+	double lambda, mu_squared, new_omega;
+	double w = omega->value;
+
+	if (!omega_adapts_after(omega, iteration)) {
+		return;
+	}
+	if (omega->window_start_diff > 0.0 && max_diff > 0.0) {
+		lambda = pow(max_diff / omega->window_start_diff, 1.0 / OMEGA_ADAPT_SWEEPS);
+		mu_squared = (lambda + w - 1) * (lambda + w - 1) / (lambda * w * w);
+		if (lambda >= 1.0 || mu_squared >= 1.0) {
+			new_omega = optimal_omega(dimension); // rate can't be measured
+		} else {
+			new_omega = 2.0 / (1.0 + sqrt(1.0 - mu_squared));
+		}
+		omega->adapting = new_omega > w + OMEGA_ADAPT_TOLERANCE;
+		if (new_omega > w) {
+			omega->value = new_omega;
+		}
+	}
+	omega->window_start_diff = max_diff;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ * 
+ * Header file for functions used by children processes to relax their portion
+ * of the square array.
+ */
+
+// ways of choosing the relaxation factor of the SOR mode
+#define OMEGA_FIXED 0
+#define OMEGA_AUTO 1
+#define OMEGA_ADAPT 2
+
+struct omega_adapter {
+	// structure used to keep track of the relaxation factor and how it is chosen
+	int choice;
+	double value;
+	int adapting;
+	double window_start_diff;
+};
+
+
+void exchange_boundary_rows(real* sub_arr, int num_rows, int pitch, 
+							int prev_child_id, int next_child_id);
+
+
+void exchange_single_rows(float* const* rows, int num_rows, int length, 
+						  int prev_child_id, int next_child_id);
+
+
+void exchange_halo_rows(real* sub_arr, int num_rows, int pitch, int depth, 
+						int prev_child_id, int next_child_id);
+
+
+void start_halo_exchange(real* sub_arr, int num_rows, int pitch, int depth, 
+						 int prev_child_id, int next_child_id, MPI_Request* requests);
+
+
+double jacobi_sweep(real* sub_arr, real* new_sub_arr, int num_rows, 
+					int dimension, int pitch);
+
+
+double overlapped_jacobi_sweep(real* sub_arr, real* new_sub_arr, int num_rows, 
+							   int dimension, int pitch, int prev_child_id, 
+							   int next_child_id);
+
+
+double jacobi_rows(real* sub_arr, real* new_sub_arr, int first_row, 
+				   int end_row, int dimension, int pitch);
+
+
+double jacobi_wavefront(real** rows, real** new_rows, int num_rows, 
+						int dimension, int depth, int prev_child_id, 
+						int next_child_id, real* scratch);
+
+
+double red_black_sweep(real* sub_arr, real* rhs, int num_rows, 
+					   int dimension, int pitch, int start_row, int colour, 
+					   double omega);
+
+
+double overlapped_red_black_sweep(real* sub_arr, int num_rows, int dimension, 
+								  int pitch, int start_row, int colour, double omega, 
+								  int prev_child_id, int next_child_id);
+
+
+double red_black_block_sweeps(real* sub_arr, int num_rows, int dimension, 
+							  int pitch, int depth, int start_row, double omega, 
+							  int prev_child_id, int next_child_id, int sweeps);
+
+
+double red_black_rows(real* sub_arr, real* rhs, int first_row, int end_row, 
+					  int dimension, int pitch, int start_row, int colour, double omega);
+
+
+double optimal_omega(int dimension);
+
+
+void initialise_omega(struct omega_adapter* omega, int dimension);
+
+
+int omega_adapts_after(struct omega_adapter* omega, int iteration);
+
+
+void adapt_omega(struct omega_adapter* omega, int iteration, double max_diff, 
+				 int dimension);
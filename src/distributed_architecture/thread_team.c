@@ -0,0 +1,222 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ * 
+ * Source file for the team of threads relaxing the sub array of a process 
+ * together in the hybrid MPI + threads mode.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+#include "real.h"
+#include "thread_team.h"
+#include "relaxation_helpers.h"
+
+#define CHUNKS_PER_THREAD 4		// rows of a sweep are taken in this many parts per thread
+
+
+/*
+ * Relaxes rows of the current sweep of the team, a few at a time, until no 
+ * rows are left, and stores the largest change in the slot of the thread.
+ */
+static void relax_team_rows(struct thread_team* team, int thread_number) {
+	double max_diff = 0.0;
+	double difference;
+	int first_row, end_row;
+
+	while (1) {
+		pthread_mutex_lock(&team->mutex);
+		first_row = team->next_row;
+		end_row = first_row + team->chunk_rows < team->end_row ? first_row + team->chunk_rows : team->end_row;
+		team->next_row = end_row;
+		pthread_mutex_unlock(&team->mutex);
+		if (first_row >= end_row) {
+			break;
+		}
+
+		if (team->colour < 0) {
+			difference = jacobi_rows(team->sub_arr, team->new_sub_arr, first_row, end_row, team->dimension, team->pitch);
+		} else {
+			difference = red_black_rows(team->sub_arr, NULL, first_row, end_row, team->dimension, team->pitch, team->start_row, 
+				team->colour, team->omega);
+		}
+		if (difference > max_diff) {
+			max_diff = difference;
+		}
+	}
+	team->thread_max_diff[thread_number] = max_diff;
+}
+
+
+/*
+ * Threaded function run by the threads of the team other than the process' 
+ * own thread: relaxes rows of every sweep until the team is freed.
+ */
+static void* team_runner(void* arg) {
+	struct team_member *member = (struct team_member*) arg;
+	struct thread_team *team = member->team;
+
+	while (1) {
+		// wait for the process' own thread to set up the sweep
+		pthread_barrier_wait(&team->barrier);
+		if (team->exiting) {
+			break;
+		}
+		relax_team_rows(team, member->thread_number);
+		pthread_barrier_wait(&team->barrier);
+	}
+	return NULL;
+}
+
+
+/*
+ * Creates a team of num_threads threads, the thread of the process calling it
+ * being the first of them.
+ */
+struct thread_team* initialise_thread_team(int num_threads) {
+	struct thread_team *team = malloc(sizeof(struct thread_team));
+	int t;
+
+	team->num_threads = num_threads;
+	team->exiting = 0;
+	team->threads = malloc((size_t)num_threads * sizeof(pthread_t));
+	team->members = malloc((size_t)num_threads * sizeof(struct team_member));
+	team->thread_max_diff = calloc((size_t)num_threads, sizeof(double));
+	if (team->threads == NULL || team->members == NULL || team->thread_max_diff == NULL) {
+		fprintf(stderr, "Error: thread team memory could not be allocated.\n");
+		exit(EXIT_FAILURE);
+	}
+	pthread_barrier_init(&team->barrier, NULL, (unsigned int) num_threads);
+	pthread_mutex_init(&team->mutex, NULL);
+
+	for (t = 1; t < num_threads; t++) {
+		team->members[t].team = team;
+		team->members[t].thread_number = t;
+		pthread_create(&team->threads[t], NULL, team_runner, &team->members[t]);
+	}
+	return team;
+}
+
+
+/*
+ * Relaxes the rows first_row to end_row (excluded) of a sweep with all threads
+ * of the team (colour -1 for a jacobi sweep), while the process' own thread 
+ * first waits for the given MPI requests to complete.
+ * Returns the largest change found by any thread.
+ */
+static double team_sweep(struct thread_team* team, int first_row, int end_row, int colour, 
+	MPI_Request* requests, int num_requests) {
+	double max_diff = 0.0;
+	int t;
+
+	team->next_row = first_row;
+	team->end_row = end_row;
+	team->colour = colour;
+	team->chunk_rows = (end_row - first_row) / (team->num_threads * CHUNKS_PER_THREAD);
+	if (team->chunk_rows < 1) {
+		team->chunk_rows = 1;
+	}
+
+	// the other threads start relaxing while the rows are exchanged
+	pthread_barrier_wait(&team->barrier);
+	if (num_requests > 0) {
+		MPI_Waitall(num_requests, requests, MPI_STATUSES_IGNORE);
+	}
+	relax_team_rows(team, 0);
+	pthread_barrier_wait(&team->barrier);
+
+	for (t = 0; t < team->num_threads; t++) {
+		if (team->thread_max_diff[t] > max_diff) {
+			max_diff = team->thread_max_diff[t];
+		}
+	}
+	return max_diff;
+}
+
+
+/*
+ * Same as jacobi_sweep, but with the threads of the team. If exchange is set,
+ * the first and last rows are exchanged with the previous and next children 
+ * processes while the threads relax the other rows (see 
+ * overlapped_jacobi_sweep), otherwise they must have been exchanged before.
+ */
+double team_jacobi_sweep(struct thread_team* team, real* sub_arr, real* new_sub_arr, 
+	int num_rows, int dimension, int pitch, int exchange, int prev_child_id, int next_child_id) {
+	MPI_Request requests[4];
+	double max_diff, difference;
+
+	team->sub_arr = sub_arr;
+	team->new_sub_arr = new_sub_arr;
+	team->dimension = dimension;
+	team->pitch = pitch;
+	if (!exchange) {
+		return team_sweep(team, 1, num_rows - 1, -1, NULL, 0);
+	}
+
+	start_halo_exchange(sub_arr, num_rows, pitch, 1, prev_child_id, next_child_id, requests);
+	max_diff = team_sweep(team, 2, num_rows - 2, -1, requests, 4);
+
+	// relax the first and last rows (which are the same row if there is only one)
+	difference = jacobi_rows(sub_arr, new_sub_arr, 1, 2, dimension, pitch);
+	max_diff = difference > max_diff ? difference : max_diff;
+	if (num_rows > 3) {
+		difference = jacobi_rows(sub_arr, new_sub_arr, num_rows - 2, num_rows - 1, dimension, pitch);
+		max_diff = difference > max_diff ? difference : max_diff;
+	}
+	return max_diff;
+}
+
+
+/*
+ * Same as red_black_sweep (without right hand side), but with the threads of
+ * the team, exchanging the first and last rows while relaxing the other rows 
+ * if exchange is set (see team_jacobi_sweep).
+ */
+double team_red_black_sweep(struct thread_team* team, real* sub_arr, int num_rows, 
+	int dimension, int pitch, int start_row, int colour, double omega, int exchange, 
+	int prev_child_id, int next_child_id) {
+	MPI_Request requests[4];
+	double max_diff, difference;
+
+	team->sub_arr = sub_arr;
+	team->dimension = dimension;
+	team->pitch = pitch;
+	team->start_row = start_row;
+	team->omega = omega;
+	if (!exchange) {
+		return team_sweep(team, 1, num_rows - 1, colour, NULL, 0);
+	}
+
+	start_halo_exchange(sub_arr, num_rows, pitch, 1, prev_child_id, next_child_id, requests);
+	max_diff = team_sweep(team, 2, num_rows - 2, colour, requests, 4);
+
+	// relax the first and last rows (which are the same row if there is only one)
+	difference = red_black_rows(sub_arr, NULL, 1, 2, dimension, pitch, start_row, colour, omega);
+	max_diff = difference > max_diff ? difference : max_diff;
+	if (num_rows > 3) {
+		difference = red_black_rows(sub_arr, NULL, num_rows - 2, num_rows - 1, dimension, pitch, start_row, colour, omega);
+		max_diff = difference > max_diff ? difference : max_diff;
+	}
+	return max_diff;
+}
+
+
+/*
+ * Stops the threads of the team and frees it.
+ */
+void free_thread_team(struct thread_team* team) {
+	int t;
+
+	team->exiting = 1;
+	pthread_barrier_wait(&team->barrier);
+	for (t = 1; t < team->num_threads; t++) {
+		pthread_join(team->threads[t], NULL);
+	}
+	pthread_barrier_destroy(&team->barrier);
+	pthread_mutex_destroy(&team->mutex);
+	free(team->threads);
+	free(team->members);
+	free(team->thread_max_diff);
+	free(team);
+}
@@ -0,0 +1,67 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ * 
+ * Header file for the team of threads relaxing the sub array of a process 
+ * together in the hybrid MPI + threads mode.
+ */
+
+#include <pthread.h>
+
+
+struct team_member {
+	// structure passed to every thread of a team other than the process' own thread
+	struct thread_team *team;
+	int thread_number;
+};
+
+struct thread_team {
+	// structure used to share the rows of the current sweep between the threads of a process
+	int num_threads;			// threads relaxing rows, the process' own thread included
+	pthread_t *threads;			// the other threads of the team
+	struct team_member *members;	// arguments of the other threads
+	pthread_barrier_t barrier;	// threads meet at before and after every sweep
+	pthread_mutex_t mutex;		// protects the next rows to relax
+	int exiting;				// threads leave the team instead of relaxing rows
+	int next_row;				// next rows of the sweep no thread has taken yet
+	int end_row;				// end (excluded) of the rows of the sweep
+	int chunk_rows;				// rows a thread takes at a time
+	int colour;					// red-black colour of the sweep, -1 for a jacobi sweep
+	int dimension;				// length of the rows
+	int pitch;					// values from the start of a row to the next one
+	int start_row;				// index of the sub array's first row in the square array
+	double omega;				// relaxation factor of red-black sweeps
+	real *sub_arr;				// values relaxed
+	real *new_sub_arr;			// new values of jacobi sweeps
+	double *thread_max_diff;	// largest change found by each thread
+};
+
+
+struct thread_team* initialise_thread_team(int num_threads);
+
+
+double team_jacobi_sweep(struct thread_team* team, 
+						 real* sub_arr, 
+						 real* new_sub_arr, 
+						 int num_rows, 
+						 int dimension, 
+						 int pitch, 
+						 int exchange, 
+						 int prev_child_id, 
+						 int next_child_id);
+
+
+double team_red_black_sweep(struct thread_team* team, 
+							real* sub_arr, 
+							int num_rows, 
+							int dimension, 
+							int pitch, 
+							int start_row, 
+							int colour, 
+							double omega, 
+							int exchange, 
+							int prev_child_id, 
+							int next_child_id);
+
+
+void free_thread_team(struct thread_team* team);
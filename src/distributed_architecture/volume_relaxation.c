@@ -0,0 +1,189 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ *
+ * Source file for the decomposition of a cube into slabs or pencils relaxed by
+ * children processes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+#include "real.h"
+#include "relaxation_helpers.h"
+#include "stall.h"
+#include "convergence.h"
+#include "volume.h"
+#include "volume_sweep.h"
+#include "volume_relaxation.h"
+#include "initial_grid.h"
+
+#define SEND_TAG 1001
+
+
+/*
+ * Finds how many parts down the planes and the rows of the cube to split it
+ * into for the given number of children processes: slabs of planes only, or
+ * pencils as close to square as possible.
+ * Returns 0 if the parts don't fit in the cube (more parts down the planes or
+ * the rows than there are planes or rows to relax), 1 otherwise.
+ */
+int volume_grid_dims(int num_children, int dimension, int pencils, int dims[2]) {
+	dims[0] = num_children;
+	dims[1] = 1;
+	if (pencils) {
+		dims[0] = 0;
+		dims[1] = 0;
+		MPI_Dims_create(num_children, 2, dims);
+	}
+	return dims[0] <= dimension - 2 && dims[1] <= dimension - 2;
+}
+
+
+/*
+ * Finds the band of planes or rows that are not boundaries of the cube held by
+ * the part number index of num_parts: they are split into contiguous bands,
+ * the first parts getting one extra plane or row each if they can't be split
+ * evenly. The band goes from start to end (excluded).
+ */
+static void band_of_values(int dimension, int index, int num_parts,
+	int* start, int* end) {
+	int height = (dimension - 2) / num_parts;
+	int extra = (dimension - 2) % num_parts;
+	*start = 1 + index * height + (index < extra ? index : extra);
+	*end = *start + height + (index < extra ? 1 : 0);
+}
+
+
+/*
+ * Creates the cartesian communicator of the children processes (without
+ * reordering them), finds the part and neighbours of this child process, and
+ * allocates the volume of the part with num_buffers buffers, generating its
+ * initial values, halo values included.
+ */
+struct volume_decomposition* initialise_volume_decomposition(int dimension,
+	const int dims[2], int num_buffers, MPI_Comm comm) {
+	struct volume_decomposition *vd = malloc(sizeof(struct volume_decomposition));
+	struct volume *v;
+	int periods[2] = {0, 0};
+	int cart_rank;
+
+	if (vd == NULL) {
+		fprintf(stderr, "Failed to allocate space for the array.\n");
+		exit(EXIT_FAILURE);
+	}
+	vd->dims[0] = dims[0];
+	vd->dims[1] = dims[1];
+	MPI_Cart_create(comm, 2, vd->dims, periods, 0, &vd->cart_comm);
+	MPI_Comm_rank(vd->cart_comm, &cart_rank);
+	MPI_Cart_coords(vd->cart_comm, cart_rank, 2, vd->coords);
+	MPI_Cart_shift(vd->cart_comm, 0, 1, &vd->above, &vd->below);
+	MPI_Cart_shift(vd->cart_comm, 1, 1, &vd->north, &vd->south);
+
+	band_of_values(dimension, vd->coords[0], dims[0], &vd->start_plane, &vd->end_plane);
+	band_of_values(dimension, vd->coords[1], dims[1], &vd->start_row, &vd->end_row);
+
+	// the part, its halo values being the values of the neighbouring parts or the boundaries of the cube
+	v = allocate_volume(vd->end_plane - vd->start_plane + 2, vd->end_row - vd->start_row + 2, dimension, num_buffers);
+	clear_volume_planes(v, 0, v->num_planes);
+	initialise_volume_values(v->values, v->pitch, v->plane_pitch, vd->start_plane - 1, vd->start_row - 1, 0,
+		v->num_planes, v->num_rows, v->num_cols);
+	if (num_buffers == 2) {
+		copy_volume_buffer(v);
+	}
+	vd->volume = v;
+
+	// the relaxed values of a plane, and the relaxed values of a row of every plane
+	MPI_Type_vector(v->num_rows - 2, v->num_cols - 2, v->pitch, REAL_MPI_TYPE, &vd->plane_face_type);
+	MPI_Type_commit(&vd->plane_face_type);
+	MPI_Type_vector(v->num_planes - 2, v->num_cols - 2, v->plane_pitch, REAL_MPI_TYPE, &vd->row_face_type);
+	MPI_Type_commit(&vd->row_face_type);
+
+	return vd;
+}
+
+
+/*
+ * Sends the first and last planes and rows a child process relaxes to the
+ * children processes holding the parts around it, and receives theirs in the
+ * halo values around the part (which are only read from when relaxing).
+ * Children holding parts at the boundaries of the cube have no neighbour on
+ * that side (MPI_PROC_NULL), in which case nothing is sent or received.
+ */
+void exchange_volume_halos(struct volume_decomposition* vd) {
+	MPI_Request requests[4];
+	real *values = vd->volume->values;
+	size_t pitch = (size_t)vd->volume->pitch;
+	size_t plane_pitch = (size_t)vd->volume->plane_pitch;
+	size_t last_plane = (size_t)(vd->volume->num_planes - 2) * plane_pitch;
+	size_t last_row = (size_t)(vd->volume->num_rows - 2) * pitch;
+
+	// send first and last planes above and below, first and last rows of every plane north and south
+	MPI_Isend(&values[plane_pitch + pitch + 1], 1, vd->plane_face_type, vd->above, SEND_TAG, vd->cart_comm, &requests[0]);
+	MPI_Isend(&values[last_plane + pitch + 1], 1, vd->plane_face_type, vd->below, SEND_TAG, vd->cart_comm, &requests[1]);
+	MPI_Isend(&values[plane_pitch + pitch + 1], 1, vd->row_face_type, vd->north, SEND_TAG, vd->cart_comm, &requests[2]);
+	MPI_Isend(&values[plane_pitch + last_row + 1], 1, vd->row_face_type, vd->south, SEND_TAG, vd->cart_comm, &requests[3]);
+
+	// receive the neighbours' planes and rows in the halo values
+	MPI_Recv(&values[pitch + 1], 1, vd->plane_face_type, vd->above, SEND_TAG, vd->cart_comm, MPI_STATUS_IGNORE);
+	MPI_Recv(&values[last_plane + plane_pitch + pitch + 1], 1, vd->plane_face_type, vd->below, SEND_TAG, vd->cart_comm,
+		MPI_STATUS_IGNORE);
+	MPI_Recv(&values[plane_pitch + 1], 1, vd->row_face_type, vd->north, SEND_TAG, vd->cart_comm, MPI_STATUS_IGNORE);
+	MPI_Recv(&values[plane_pitch + last_row + pitch + 1], 1, vd->row_face_type, vd->south, SEND_TAG, vd->cart_comm,
+		MPI_STATUS_IGNORE);
+
+	// the values that were sent will be overwritten by the next sweep
+	MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+}
+
+
+/*
+ * Relaxes the part of the cube of this child process until the values of all
+ * processes change by less than the precision, with jacobi sweeps, or with
+ * red-black sweeps over-relaxed by omega (sharing the updated faces before
+ * updating black cells). Returns the number of iterations.
+ */
+int relax_volume_part(struct volume_decomposition* vd, int red_black,
+	struct omega_adapter* omega, struct convergence_check* convergence,
+	double precision, int dimension) {
+	struct volume *v = vd->volume;
+	// only the parity of plane + row + column of the first value matters to red-black sweeps
+	int start_index = vd->start_plane - 1 + vd->start_row - 1;
+	int iteration_count = 0;
+	int is_under_precision = 0;
+	double max_diff, black_diff;
+
+	while (!is_under_precision) {
+		// the halo values of the first iteration were generated with the part
+		if (iteration_count > 0) {
+			exchange_volume_halos(vd);
+		}
+		if (red_black) {
+			max_diff = volume_colour_sweep(v, v->values, 1, v->num_planes - 1, start_index, 0, omega->value);
+			exchange_volume_halos(vd);
+			black_diff = volume_colour_sweep(v, v->values, 1, v->num_planes - 1, start_index, 1, omega->value);
+			if (black_diff > max_diff) {
+				max_diff = black_diff;
+			}
+		} else {
+			max_diff = volume_jacobi_sweep(v, v->values, v->next_values, 1, v->num_planes - 1);
+			swap_volume_buffers(v);
+		}
+		iteration_count++;
+		is_under_precision = check_convergence(convergence, max_diff, iteration_count, omega, precision, dimension);
+	}
+	return iteration_count;
+}
+
+
+/*
+ * Frees the cartesian communicator, datatypes, volume and structure of the
+ * decomposition.
+ */
+void free_volume_decomposition(struct volume_decomposition* vd) {
+	MPI_Type_free(&vd->plane_face_type);
+	MPI_Type_free(&vd->row_face_type);
+	MPI_Comm_free(&vd->cart_comm);
+	free_volume(vd->volume);
+	free(vd);
+}
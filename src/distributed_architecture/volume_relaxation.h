@@ -0,0 +1,44 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 2
+ *
+ * Header file for the decomposition of a cube into slabs or pencils relaxed by
+ * children processes.
+ */
+
+
+struct volume_decomposition {
+	// structure used by a child process to keep track of its part of the cube and neighbours
+	MPI_Comm cart_comm;				// cartesian communicator of the children processes
+	int dims[2];					// number of parts down the planes and the rows of the cube
+	int coords[2];					// place of this process' part down the planes and the rows
+	int above, below;				// processes holding the planes before and after the part
+	int north, south;				// processes holding the rows before and after the part
+									// (MPI_PROC_NULL at the boundaries)
+	int start_plane, end_plane;		// planes of the cube relaxed (end excluded)
+	int start_row, end_row;			// rows of the cube relaxed (end excluded)
+	struct volume *volume;			// values of the part, including 1 halo value on each side
+	MPI_Datatype plane_face_type;	// face of the part facing the planes before and after it
+	MPI_Datatype row_face_type;		// face of the part facing the rows before and after it
+};
+
+
+int volume_grid_dims(int num_children, int dimension, int pencils, int dims[2]);
+
+
+struct volume_decomposition* initialise_volume_decomposition(int dimension,
+															 const int dims[2],
+															 int num_buffers,
+															 MPI_Comm comm);
+
+
+void exchange_volume_halos(struct volume_decomposition* vd);
+
+
+int relax_volume_part(struct volume_decomposition* vd, int red_black,
+					  struct omega_adapter* omega,
+					  struct convergence_check* convergence,
+					  double precision, int dimension);
+
+
+void free_volume_decomposition(struct volume_decomposition* vd);
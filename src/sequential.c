@@ -2,21 +2,49 @@
  * SEQUENTIAL VERSION
  * author: Adam Jaamour
  *
- * gcc sequential.c -o sequential.exe -Wall -Wextra -Wconversion
- * ./sequential
+ * gcc -O2 -Icommon sequential.c common/stencil_kernel.c common/initial_grid.c common/grid.c 
+ *     common/stall.c common/stencil_operator.c common/coarsening.c
+ *     common/mixed_precision.c common/single_stencil_kernel.c
+ *     -o sequential.exe [-DSINGLE_PRECISION]
+ *     -Wall -Wextra -Wconversion -lm
+ * ./sequential -d <dimension> -p <precision> -w <omega>
+ * ./sequential -d <dimension> -p <precision> -m sor
+ * ./sequential -d <dimension> -p <precision> -m jacobi
+ * ./sequential -d <dimension> -p <precision> -m multigrid -cycle <v|w> 
+ *     -levels <number of levels>
+ * ./sequential -d <dimension> -p <precision> -stencil <5|9> 
+ *     -coef <coefficient of the inclusion> -source <source term>
+ * ./sequential -d <dimension> -p <precision> [-m jacobi] 
+ *     -mixed <precision of the single precision sweeps>
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include <math.h>
 #include <sys/time.h>
+#include "real.h"
+#include "stencil_kernel.h"
+#include "initial_grid.h"
+#include "grid.h"
+#include "stall.h"
+#include "stencil_operator.h"
+#include "coarsening.h"
+#include "mixed_precision.h"
 
 
 // Function definitions
 void initialise_square_array(void);
-void relaxation(double precision);
-void check_malloc(void);
+void parse_arguments(int argc, char *argv[]);
+int relaxation(double precision);
+int jacobi(double precision);
+int red_black(double precision);
+int multigrid(double precision);
+int single_precision(double coarse_precision);
+struct grid* allocate_zero_grid(int n);
+double gauss_seidel_sweep(real **u, real **f, int n);
+void multigrid_cycle(int level);
 double double_random(double low, double high);
 void print_initial_data(double precision);
 void print_array(void);
@@ -25,25 +53,54 @@ void print_relaxation_data(double old, double l, double r, double u, double d, d
 
 // Global variables
 bool DEBUG = false;				// print data to the command line
-#define dim 7					// square array dimensions
-#define SEED 1000
+int dim = 7;					// square array dimensions
+double precision = 1;			// precision to perform relaxation at
+double omega = 1;				// relaxation factor (1: Gauss-Seidel, >1: SOR)
+bool use_jacobi = false;		// relax with Jacobi sweeps into a second array
+bool use_multigrid = false;		// relax with multigrid cycles instead of sweeps
+int cycle_index = 1;			// coarse level visits per cycle (1: V, 2: W)
+int max_levels = 0;				// multigrid levels to use (0: as many as can be)
+int stencil_points = 5;			// points of the Laplacian (5 or 9)
+double contrast = 1.0;			// coefficient of the inclusion (1: uniform)
+double source = 0.0;			// source term of the Poisson equation
+double mixed_precision = 0.0;	// precision of single precision sweeps (0: none)
+struct stencil_operator op;		// equation relaxed (see common/stencil_operator.c)
+struct grid *coefficient_grid;	// coefficients of the cells (NULL if uniform)
+real **coefficients;			// rows of the coefficients (NULL if uniform)
+#define SMOOTHING_SWEEPS 2		// multigrid sweeps before and after coarse level
+#define COARSEST_PRECISION 0.01	// fraction of precision coarsest level reaches
 struct timeval time1, time2;	// structure used to calculate program time
-double **square_array;			// global square array of double
+struct grid *grid;				// grid holding the square array
+real **square_array;			// rows of the square array
+struct level {					// one level of the multigrid hierarchy
+	int n;						// square array dimensions on this level
+	struct grid *u;				// values (finest level) or corrections
+	struct grid *f;				// right hand side (NULL on the finest level)
+	struct grid *r;				// residuals
+	struct coarsening *c;		// mapping to the coarser level (NULL on the coarsest)
+} *levels;
+int num_levels;
 
 
 /*
  * Program entry.
  */
-int main() {
+int main(int argc, char *argv[]) {
 	// initialise values
-	double precision = 1; // precision to perform relaxation at
+	parse_arguments(argc, argv);
+	initialise_stencil_kernel();
 	initialise_square_array();
 	print_initial_data(precision);
 
 	// iterate averaging until precision reached
 	gettimeofday(&time1, NULL);	// start recording time
-	relaxation(precision);
+	int iterations = mixed_precision > 0.0 ? single_precision(mixed_precision) : 0;
+	iterations += use_multigrid ? multigrid(precision) : 
+		use_jacobi ? jacobi(precision) : 
+		!is_plain_laplacian(&op) ? red_black(precision) : 
+		relaxation(precision);
 	gettimeofday(&time2, NULL);	// stop recording time
+	printf("Iterations: %d\n", iterations);
 	printf ("Total time = %f seconds\n\n", 
 		(double) (time2.tv_usec - time1.tv_usec) / 1000000 +
 		(double) (time2.tv_sec - time1.tv_sec));
@@ -54,37 +111,134 @@ int main() {
 	}
 
 	// free allocated array space and successfully exit program
- 	free(square_array);
+ 	free_grid(grid);
+	if (coefficient_grid != NULL) {
+		free_grid(coefficient_grid);
+	}
    	return 0;
 }
 
 
 /*
- * Initialises a square array by creating an initial array of pointers, each 
- * looking at 1D arrays of doubles.
+ * Parses the command line arguments: -d for the square array dimension, -p for
+ * the precision and -w for the relaxation factor, where "auto" picks the 
+ * theoretical optimum 2 / (1 + sin(pi / (dim - 1))), also picked by "-m sor"
+ * without -w (Gauss-Seidel sweeps use omega = 1). "-m jacobi" relaxes with
+ * Jacobi sweeps and "-m multigrid" with multigrid cycles instead, "-cycle" 
+ * picks V or W-cycles and "-levels" the number of levels. "-stencil", "-coef" 
+ * and "-source" pick the equation relaxed (see common/stencil_operator.c): 
+ * multigrid only relaxes the Laplace equation, and the 9-point stencil only 
+ * Jacobi sweeps, other equations being relaxed by red-black sweeps instead 
+ * of the default sweeps. "-mixed" relaxes a single precision copy of the 
+ * array to the given precision first (see common/mixed_precision.c), with 
+ * Jacobi sweeps or red-black sweeps over-relaxed by omega, for the Laplace 
+ * equation only.
+ */
+void parse_arguments(int argc, char *argv[]) {
+	bool auto_omega = false;
+	bool use_sor = false;
+	bool omega_chosen = false;
+	int arg;
+	for (arg = 1; arg < argc - 1; arg++) {
+		if (strcmp(argv[arg], "-d") == 0 && atoi(argv[arg + 1]) > 2) {
+			dim = atoi(argv[++arg]);
+		} else if (strcmp(argv[arg], "-p") == 0 && atof(argv[arg + 1]) > 0.0) {
+			precision = atof(argv[++arg]);
+		} else if (strcmp(argv[arg], "-m") == 0) {
+			arg++;
+			use_jacobi = strcmp(argv[arg], "jacobi") == 0;
+			use_multigrid = strcmp(argv[arg], "multigrid") == 0;
+			use_sor = strcmp(argv[arg], "sor") == 0;
+		} else if (strcmp(argv[arg], "-cycle") == 0) {
+			cycle_index = strcmp(argv[++arg], "w") == 0 ? 2 : 1;
+		} else if (strcmp(argv[arg], "-levels") == 0 && atoi(argv[arg + 1]) >= 0) {
+			max_levels = atoi(argv[++arg]);
+		} else if (strcmp(argv[arg], "-w") == 0) {
+			arg++;
+			omega_chosen = true;
+			if (strcmp(argv[arg], "auto") == 0) {
+				auto_omega = true;
+			} else if (atof(argv[arg]) > 0.0 && atof(argv[arg]) < 2.0) {
+				omega = atof(argv[arg]);
+			} else {
+				fprintf(stderr, "WARNING: Invalid argument for -w. Using omega = %f.\n", omega);
+			}
+		} else if (strcmp(argv[arg], "-stencil") == 0) {
+			arg++;
+			if (atoi(argv[arg]) == 5 || atoi(argv[arg]) == 9) {
+				stencil_points = atoi(argv[arg]);
+			} else {
+				fprintf(stderr, "WARNING: Invalid argument for -stencil. Using 5 points.\n");
+			}
+		} else if (strcmp(argv[arg], "-coef") == 0) {
+			arg++;
+			if (atof(argv[arg]) > 0.0) {
+				contrast = atof(argv[arg]);
+			} else {
+				fprintf(stderr, "WARNING: Invalid argument for -coef. Using uniform coefficients.\n");
+			}
+		} else if (strcmp(argv[arg], "-source") == 0) {
+			source = atof(argv[++arg]);
+		} else if (strcmp(argv[arg], "-mixed") == 0) {
+			arg++;
+			if (atof(argv[arg]) > 0.0) {
+				mixed_precision = atof(argv[arg]);
+			} else {
+				fprintf(stderr, "WARNING: Invalid argument for -mixed. Using double precision sweeps only.\n");
+			}
+		}
+	}
+	// the SOR mode over-relaxes by the theoretical optimum unless told otherwise
+	if (auto_omega || (use_sor && !omega_chosen)) {
+		omega = 2.0 / (1.0 + sin(M_PI / (double)(dim - 1)));
+	}
+	initialise_stencil_operator(&op, stencil_points, contrast, source, dim);
+	if (use_multigrid && !is_plain_laplacian(&op)) {
+		fprintf(stderr, "WARNING: -m multigrid only supports the 5-point stencil without -coef and -source. Using jacobi.\n");
+		use_multigrid = false;
+		use_jacobi = true;
+	} else if (!use_jacobi && op.points == 9) {
+		fprintf(stderr, "WARNING: the 9-point stencil only supports -m jacobi. Using jacobi.\n");
+		use_multigrid = false;
+		use_jacobi = true;
+	}
+	if (mixed_precision > 0.0 && (sizeof(real) != sizeof(double) || 
+		use_multigrid || !is_plain_laplacian(&op))) {
+		fprintf(stderr, "WARNING: -mixed only supports double precision builds relaxing the Laplace equation with sweeps. Using %s precision sweeps only.\n", REAL_NAME);
+		mixed_precision = 0.0;
+	}
+}
+
+
+/*
+ * Initialises a square array in a grid (see common/grid.c), with a second 
+ * buffer for the Jacobi sweeps to write to.
  */
 void initialise_square_array(void) {
-	srand(SEED);
 	int i, j;
 	
-	// allocate space for a 1D array of double pointers.
-	square_array = malloc(dim * sizeof(double*));
-	check_malloc();
+	// allocate space for the rows of the array
+	grid = allocate_grid(dim, dim, 0, use_jacobi ? 2 : 1);
+	square_array = grid->rows;
 
-	// allocate space for multiple 1D arrays of doubles
-	for (i = 0; i < dim; i++) {
-		square_array[i] = malloc(dim * sizeof(double));
-		check_malloc();
-	}
-
-	// populate the array with random doubles
+	// populate the array with random doubles (the same as the distributed memory version)
 	for (i = 0; i < dim; i++) {
 		for (j = 0; j < dim; j++) {
 			//square_array[i][j] = (i*dim) + (j*j*j*j) + 10;
 			//square_array[i][j] = double_random(1.0, 10.0);
-			square_array[i][j] = (double)(rand() % 10);
+			square_array[i][j] = (real)initial_grid_value(i, j);
 		}
 	}
+
+	// coefficients of the cells, read by the sweeps along with the values
+	coefficient_grid = NULL;
+	coefficients = NULL;
+	if (op.coefficients) {
+		coefficient_grid = allocate_grid(dim, dim, 0, 1);
+		initialise_coefficients(&op, coefficient_grid->values, 
+			coefficient_grid->pitch, 0, 0, dim, dim);
+		coefficients = coefficient_grid->rows;
+	}
 }
 
 
@@ -93,38 +247,46 @@ void initialise_square_array(void) {
  * neighbouring values (left, right, up and down). Loops until all the values 
  * changed differ by less than the precision specified at the start of the
  * program. Does not update boundary values.
- * Returns a new square array with the updated values.
+ * Returns the number of iterations needed to reach the precision.
  */
-void relaxation(double precision) {
+int relaxation(double precision) {
 	bool is_above_precision = true;
 	int precision_counter = 0;
 	int iteration_counter = 0;
 	double difference = 0.0; // different between old and new value
+	double max_diff;
 	int number_of_values_to_change = ((dim-2) * (dim-2));
 	int i, j;
+	struct stall stall;
 
+	initialise_stall(&stall);
 	while (is_above_precision) {
 		precision_counter = 0;
+		max_diff = 0.0;
 		if (DEBUG) printf("\n------------------------ Iteration #%d\n", iteration_counter);
 		for (i = 1; i < dim - 1; i++) {
 			for (j = 1; j < dim - 1; j++) {
 				// value to replace
-				double old_value = square_array[i][j]; 
+				real old_value = square_array[i][j]; 
 
 				// get 4 surrounding values needed to average
-				double v_left = square_array[i][j-1];
-				double v_right = square_array[i][j+1];
-				double v_up = square_array[i-1][j];
-				double v_down = square_array[i+1][j];
+				real v_left = square_array[i][j-1];
+				real v_right = square_array[i][j+1];
+				real v_up = square_array[i-1][j];
+				real v_down = square_array[i+1][j];
 
-				// perform the calculation
-				double new_value = (v_left + v_right + v_up + v_down) / 4;
+				// perform the calculation, over-relaxed by omega
+				real new_value = (real)((1 - omega) * old_value + 
+					omega * (v_left + v_right + v_up + v_down) / 4);
 				
 				// replace the old value with the new one
 				square_array[i][j] = new_value;
 
 				// check if difference is smaller than precision
 				difference = (double)fabs(old_value - new_value);
+				if (difference > max_diff) {
+					max_diff = difference;
+				}
 				if (difference < precision) {
 					precision_counter++;
 				} else { // reset precision counter if diff smaller than prec
@@ -147,28 +309,302 @@ void relaxation(double precision) {
 			}
 		}
 		iteration_counter++;
+
+		// stop if the values stopped converging (see common/stall.c)
+		if (is_above_precision && has_stalled(&stall, max_diff)) {
+			warn_if_stalled(max_diff, precision);
+			is_above_precision = false;
+		}
 	}
+	return iteration_counter;
 }
 
 
 /*
- * Check that malloc correctly allocated the amount of space required for the 
- * square array of doubles.
- * If not, exit the program with a failure.
+ * Relaxes a single precision copy of the square array with Jacobi sweeps (or
+ * red-black sweeps over-relaxed by omega) until a sweep changes every value 
+ * by less than the coarse precision or the sweeps stall, then copies the 
+ * relaxed values back into the square array (see common/mixed_precision.c).
+ * Returns the number of sweeps.
  */
-void check_malloc(void) {
-	if (square_array == NULL) {
-		fprintf(stderr, "Failed to allocate space for the array.\n");
-		exit(EXIT_FAILURE);
+int single_precision(double coarse_precision) {
+	struct single_grid *single = allocate_single_grid(dim, dim, use_jacobi ? 2 : 1);
+	double max_diff, difference;
+	int iteration_counter = 0;
+	struct stall stall;
+
+	// the boundary values never change, so every buffer starts with them
+	to_single_rows(square_array, single->rows, 0, dim, dim);
+	if (use_jacobi) {
+		to_single_rows(square_array, single->next_rows, 0, dim, dim);
 	}
+	initialise_stall(&stall);
+
+	do {
+		if (use_jacobi) {
+			max_diff = single_jacobi_rows(single->rows, single->next_rows, 1, 
+				dim - 1, dim);
+			swap_single_buffers(single);
+		} else {
+			max_diff = single_colour_rows(single->rows, 1, dim - 1, dim, 0, 0, 
+				omega);
+			difference = single_colour_rows(single->rows, 1, dim - 1, dim, 0, 
+				1, omega);
+			if (difference > max_diff) {
+				max_diff = difference;
+			}
+		}
+		iteration_counter++;
+	} while (max_diff >= coarse_precision && 
+		!has_float_stalled(&stall, max_diff));
+
+	to_double_rows(single->rows, square_array, 1, dim - 1, dim);
+	free_single_grid(single);
+	printf("Single precision sweeps: %d (largest change %f)\n", 
+		iteration_counter, max_diff);
+	return iteration_counter;
+}
+
+
+/*
+ * Relaxes the square array with Jacobi sweeps: new values are the average of 
+ * the 4 neighbours in the previous sweep (or the value of the stencil 
+ * operator), so whole rows are computed at once by the stencil kernel (see 
+ * common/stencil_kernel.c and common/stencil_operator.c) and written to the 
+ * second buffer of the grid. Loops until a sweep changes every value by less 
+ * than the precision.
+ * Returns the number of sweeps needed to reach the precision.
+ */
+int jacobi(double precision) {
+	double max_diff;
+	int iteration_counter = 0;
+	struct stall stall;
+
+	// the boundary values never change, so both buffers start with them
+	copy_grid_buffer(grid);
+	initialise_stall(&stall);
+
+	do {
+		max_diff = operator_rows(&op, square_array, grid->next_rows, 
+			coefficients, 1, dim - 1, dim);
+
+		// new values become the current values for the next sweep
+		swap_grid_buffers(grid);
+		square_array = grid->rows;
+		iteration_counter++;
+	} while (max_diff >= precision && !has_stalled(&stall, max_diff));
+	warn_if_stalled(max_diff, precision);
+
+	printf("Stencil kernel: %s\n", stencil_kernel_name());
+	return iteration_counter;
 }
 
+
+/*
+ * Relaxes the square array in place with red-black sweeps of the stencil 
+ * operator, over-relaxed by omega: red cells (even row + column index) are 
+ * relaxed first, then black cells using the new red values. Loops until a 
+ * sweep changes every value by less than the precision.
+ * Returns the number of sweeps needed to reach the precision.
+ */
+int red_black(double precision) {
+	double max_diff, difference;
+	int iteration_counter = 0;
+	struct stall stall;
+
+	initialise_stall(&stall);
+	do {
+		max_diff = operator_rows_colour(&op, square_array, coefficients, 1, 
+			dim - 1, dim, 0, 0, omega);
+		difference = operator_rows_colour(&op, square_array, coefficients, 1, 
+			dim - 1, dim, 0, 1, omega);
+		if (difference > max_diff) {
+			max_diff = difference;
+		}
+		iteration_counter++;
+	} while (max_diff >= precision && !has_stalled(&stall, max_diff));
+	warn_if_stalled(max_diff, precision);
+
+	printf("Stencil kernel: %s\n", stencil_kernel_name());
+	return iteration_counter;
+}
+
+
+/*
+ * Relaxes the square array with multigrid cycles until the last sweep of a 
+ * cycle changes every value by less than the precision.
+ * Relaxing the array amounts to solving A u = 0 with fixed boundary values, 
+ * where A u = 4 u[i][j] - (sum of the 4 neighbours). Sweeps quickly remove the
+ * error that varies from cell to cell but are slow on smooth error, so each 
+ * cycle moves the residual to a coarser level where the smooth error is cheap
+ * to relax, then interpolates the correction back. A level of dimension n has
+ * a coarser level of dimension n / 2 + 1 spanning the same array (see 
+ * common/coarsening.c).
+ * Returns the number of cycles.
+ */
+int multigrid(double precision) {
+	double max_diff;
+	int n = dim;
+	int cycles = 0;
+	int l;
+	struct stall stall;
+
+	// count and allocate the levels
+	num_levels = 1;
+	while (n > 3 && (max_levels == 0 || num_levels < max_levels)) {
+		n = coarse_dimension(n);
+		num_levels++;
+	}
+	levels = malloc((long unsigned int) num_levels * sizeof(struct level));
+	n = dim;
+	for (l = 0; l < num_levels; l++) {
+		levels[l].n = n;
+		levels[l].u = l == 0 ? grid : allocate_zero_grid(n);
+		levels[l].f = l == 0 ? NULL : allocate_zero_grid(n);
+		levels[l].r = allocate_zero_grid(n);
+		levels[l].c = l < num_levels - 1 ? initialise_coarsening(n) : NULL;
+		n = coarse_dimension(n);
+	}
+	printf("Multigrid: %c-cycles over %d levels\n", 
+		cycle_index == 1 ? 'V' : 'W', num_levels);
+
+	// cycle until the last sweep of the finest level is within precision
+	initialise_stall(&stall);
+	do {
+		multigrid_cycle(0);
+		cycles++;
+		max_diff = gauss_seidel_sweep(square_array, NULL, dim);
+	} while (max_diff >= precision && !has_stalled(&stall, max_diff));
+	warn_if_stalled(max_diff, precision);
+
+	// the finest level's values are the square array, freed by main
+	for (l = 0; l < num_levels; l++) {
+		if (l > 0) {
+			free_grid(levels[l].u);
+			free_grid(levels[l].f);
+		}
+		free_grid(levels[l].r);
+		if (levels[l].c != NULL) {
+			free_coarsening(levels[l].c);
+		}
+	}
+	free(levels);
+	return cycles;
+}
+
+
+/*
+ * Allocates a grid holding a square array of zeros of dimension n.
+ */
+struct grid* allocate_zero_grid(int n) {
+	struct grid *zero_grid = allocate_grid(n, n, 0, 1);
+	clear_grid_rows(zero_grid, 0, n);
+	return zero_grid;
+}
+
+
+/*
+ * Relaxes the values of u (dimension n) in place once, replacing each value 
+ * with the average of its 4 neighbours and its right hand side f (if not 
+ * NULL), like the relaxation function does.
+ * Returns the largest difference between an old and a new value.
+ */
+double gauss_seidel_sweep(real **u, real **f, int n) {
+	double max_diff = 0.0;
+	int i, j;
+	for (i = 1; i < n - 1; i++) {
+		for (j = 1; j < n - 1; j++) {
+			real old_value = u[i][j];
+			real sum = u[i][j-1] + u[i][j+1] + u[i-1][j] + u[i+1][j];
+			if (f != NULL) {
+				sum += f[i][j];
+			}
+			u[i][j] = sum / 4;
+			if (fabs(u[i][j] - old_value) > max_diff) {
+				max_diff = fabs(u[i][j] - old_value);
+			}
+		}
+	}
+	return max_diff;
+}
+
+
+/*
+ * Runs one multigrid cycle from the given level: smooths, restricts the 
+ * residuals to the coarser level, runs cycle_index cycles on the coarser 
+ * level, adds the bilinearly interpolated corrections and smooths again (see
+ * common/coarsening.c). The coarsest level is relaxed until it has converged.
+ */
+void multigrid_cycle(int level) {
+	struct level *fine = &levels[level];
+	struct level *coarse = &levels[level + 1];
+	struct coarsening *m = fine->c;
+	real **u = fine->u->rows;
+	real **f = fine->f != NULL ? fine->f->rows : NULL;
+	real **r = fine->r->rows;
+	int i, j, fi, fj, s, c;
+
+	if (level == num_levels - 1) {
+		while (gauss_seidel_sweep(u, f, fine->n) >= 
+			precision * COARSEST_PRECISION);
+		return;
+	}
+
+	for (s = 0; s < SMOOTHING_SWEEPS; s++) {
+		gauss_seidel_sweep(u, f, fine->n);
+	}
+
+	// residuals r = f - A u, restricted to the coarser right hand side
+	for (i = 1; i < fine->n - 1; i++) {
+		for (j = 1; j < fine->n - 1; j++) {
+			r[i][j] = (f != NULL ? f[i][j] : 0) - 4 * u[i][j] + 
+				u[i][j-1] + u[i][j+1] + u[i-1][j] + u[i+1][j];
+		}
+	}
+	for (i = 1; i < coarse->n - 1; i++) {
+		for (j = 1; j < coarse->n - 1; j++) {
+			double sum = 0.0;
+			for (fi = m->first[i]; fi <= m->last[i]; fi++) {
+				for (fj = m->first[j]; fj <= m->last[j]; fj++) {
+					sum += restriction_weight(m, fi, i) * 
+						restriction_weight(m, fj, j) * r[fi][fj];
+				}
+			}
+			coarse->f->rows[i][j] = (real)sum;
+			coarse->u->rows[i][j] = 0.0;
+		}
+	}
+
+	for (c = 0; c < cycle_index; c++) {
+		multigrid_cycle(level + 1);
+	}
+
+	// add the interpolated corrections
+	for (i = 1; i < fine->n - 1; i++) {
+		for (j = 1; j < fine->n - 1; j++) {
+			real **e = coarse->u->rows;
+			int ci = m->cell[i], cj = m->cell[j];
+			double wi = m->weight[i], wj = m->weight[j];
+			u[i][j] += (real)((1 - wi) * 
+				((1 - wj) * e[ci][cj] + wj * e[ci][cj + 1]) + 
+				wi * ((1 - wj) * e[ci + 1][cj] + wj * e[ci + 1][cj + 1]));
+		}
+	}
+
+	for (s = 0; s < SMOOTHING_SWEEPS; s++) {
+		gauss_seidel_sweep(u, f, fine->n);
+	}
+}
+
+
 /*
  * Prints the initial data values used to initiate the program.
  */
 void print_initial_data(double precision) {
 	printf("\nArray dimension: %d\n", dim);
-	printf("Precision: %f\n\n", precision);
+	printf("Precision: %f (%s precision values)\n", precision, REAL_NAME);
+	printf("Relaxation factor (omega): %f\n", omega);
+	printf("Stencil: %s\n\n", op.name);
 	if (DEBUG) {
 		printf("Initial square array:\n");
 		print_array();
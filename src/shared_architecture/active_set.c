@@ -0,0 +1,244 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ *
+ * Source file for the active set of the red-black sweeps, which only relax
+ * the tiles of the square array that are still changing.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "real.h"
+#include "relaxation_helpers.h"
+#include "stencil_kernel.h"
+#include "active_set.h"
+
+
+/*
+ * Cuts the band of rows of every thread into tiles, all of which are relaxed
+ * by the first sweep.
+ */
+struct active_set* initialise_active_set(int dim, int tile_size,
+	int quiet_sweeps, double precision, int num_thr) {
+	struct active_set *as = malloc(sizeof(struct active_set));
+	int tiles_across = (dim - 2 + tile_size - 1) / tile_size;
+	int tile_rows = 0;
+	int start_row, end_row, row, col, t, k;
+
+	if (as == NULL) {
+		fprintf(stderr, "Failed to allocate space for the active set.\n");
+		exit(EXIT_FAILURE);
+	}
+	as->num_thr = num_thr;
+	as->tile_size = tile_size;
+	as->quiet_sweeps = quiet_sweeps;
+	as->precision = precision;
+	as->first_tile = malloc((size_t)(num_thr + 1) * sizeof(int));
+	as->num_active = malloc((size_t)num_thr * sizeof(int));
+	as->relaxed_tiles = calloc((size_t)num_thr, sizeof(long));
+	as->relax_all = calloc((size_t)num_thr, sizeof(int));
+	if (as->first_tile == NULL || as->num_active == NULL ||
+		as->relaxed_tiles == NULL || as->relax_all == NULL) {
+		fprintf(stderr, "Failed to allocate space for the active set.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// rows of tiles of every band, one band after another
+	for (k = 0; k < num_thr; k++) {
+		band_of_rows(dim, k, num_thr, &start_row, &end_row);
+		as->first_tile[k] = tile_rows * tiles_across;
+		tile_rows += (end_row - start_row + tile_size - 1) / tile_size;
+	}
+	as->num_tiles = tile_rows * tiles_across;
+	as->first_tile[num_thr] = as->num_tiles;
+	as->tiles = calloc((size_t)as->num_tiles, sizeof(struct active_tile));
+	as->active_tiles = malloc((size_t)as->num_tiles * sizeof(int));
+	if (as->tiles == NULL || as->active_tiles == NULL) {
+		fprintf(stderr, "Failed to allocate space for the active set.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	t = 0;
+	for (k = 0; k < num_thr; k++) {
+		band_of_rows(dim, k, num_thr, &start_row, &end_row);
+		for (row = start_row; row < end_row; row += tile_size) {
+			for (col = 1; col < dim - 1; col += tile_size, t++) {
+				as->tiles[t].start_row = row;
+				as->tiles[t].end_row = row + tile_size < end_row ?
+					row + tile_size : end_row;
+				as->tiles[t].start_col = col;
+				as->tiles[t].end_col = col + tile_size < dim - 1 ?
+					col + tile_size : dim - 1;
+			}
+		}
+		as->num_active[k] = as->first_tile[k+1] - as->first_tile[k];
+	}
+
+	for (t = 0; t < as->num_tiles; t++) {
+		struct active_tile *tile = &as->tiles[t];
+		tile->num_neighbours = 0;
+		if (t >= tiles_across) {
+			tile->neighbours[tile->num_neighbours++] = t - tiles_across;
+		}
+		if (t < as->num_tiles - tiles_across) {
+			tile->neighbours[tile->num_neighbours++] = t + tiles_across;
+		}
+		if (t % tiles_across > 0) {
+			tile->neighbours[tile->num_neighbours++] = t - 1;
+		}
+		if (t % tiles_across < tiles_across - 1) {
+			tile->neighbours[tile->num_neighbours++] = t + 1;
+		}
+		tile->active = 1;
+		as->active_tiles[t] = t;
+	}
+	return as;
+}
+
+
+/*
+ * Relaxes the values of the given colour of the active tiles of the thread
+ * thread_index (0-based) in place, with relaxation factor w (see
+ * relax_colour). The first colour of a sweep starts the largest difference
+ * of each tile. Returns the largest difference of all of them.
+ * Active tiles next to each other in the same rows form a run, whose rows are
+ * relaxed by a single kernel call each, like the rows of relax_colour, rather
+ * than one short call per tile: every tile of a run keeps the largest 
+ * difference of the run.
+ */
+double relax_active_colour(struct active_set* as, real** sq_array,
+	int thread_index, int colour, double w) {
+	const int *active = &as->active_tiles[as->first_tile[thread_index]];
+	int num_active = as->num_active[thread_index];
+	double max_diff = 0.0;
+	double run_diff, difference;
+	int first, last, offset, length, i, k;
+
+	for (first = 0; first < num_active; first = last) {
+		// active tiles following the first one in the same rows
+		last = first + 1;
+		while (last < num_active && active[last] == active[last-1] + 1 &&
+			as->tiles[active[last]].start_row ==
+			as->tiles[active[first]].start_row) {
+			last++;
+		}
+
+		// the run, and the columns on either side of it
+		offset = as->tiles[active[first]].start_col - 1;
+		length = as->tiles[active[last-1]].end_col - offset + 1;
+		run_diff = colour == 0 ? 0.0 : as->tiles[active[first]].diff;
+		for (i = as->tiles[active[first]].start_row;
+			i < as->tiles[active[first]].end_row; i++) {
+			difference = stencil_row_colour(&sq_array[i-1][offset],
+				&sq_array[i][offset], &sq_array[i+1][offset], NULL, length,
+				1 + (i + offset + 1 + colour) % 2, w);
+			if (difference > run_diff) {
+				run_diff = difference;
+			}
+		}
+		for (k = first; k < last; k++) {
+			as->tiles[active[k]].diff = run_diff;
+		}
+		if (run_diff > max_diff) {
+			max_diff = run_diff;
+		}
+	}
+	return max_diff;
+}
+
+
+/*
+ * Counts the sweeps in a row the tiles of the thread thread_index (0-based)
+ * changed less than the precision, once both colours are relaxed and before
+ * the barrier ending the sweep. Tiles that weren't relaxed keep their count.
+ */
+void finish_active_sweep(struct active_set* as, int thread_index) {
+	int t;
+
+	for (t = as->first_tile[thread_index]; t < as->first_tile[thread_index+1];
+		t++) {
+		struct active_tile *tile = &as->tiles[t];
+		tile->relaxed = tile->active;
+		if (tile->active) {
+			tile->quiet_sweeps = tile->diff < as->precision ?
+				tile->quiet_sweeps + 1 : 0;
+		}
+	}
+	as->relaxed_tiles[thread_index] += as->num_active[thread_index];
+}
+
+
+/*
+ * Returns whether the last sweep relaxed every tile of the array, after the
+ * barrier ending it.
+ */
+int was_full_sweep(struct active_set* as) {
+	int t;
+
+	for (t = 0; t < as->num_tiles; t++) {
+		if (!as->tiles[t].relaxed) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+
+/*
+ * Picks the tiles of the thread thread_index (0-based) relaxed by the next
+ * sweep, after the barrier ending the last one: every tile once relax_all was
+ * set (by the first sweep whose relaxed tiles were within precision), 
+ * otherwise the tiles that, or one of whose neighbours, changed by more
+ * than the precision in one of the last quiet_sweeps sweeps, and the tiles
+ * next to a tile that just did.
+ */
+void update_active_set(struct active_set* as, int thread_index,
+	int relax_all) {
+	int *active = &as->active_tiles[as->first_tile[thread_index]];
+	int t, k;
+
+	// once every tile is in the list, it stays there
+	as->relax_all[thread_index] |= relax_all;
+	if (as->relax_all[thread_index] && as->num_active[thread_index] ==
+		as->first_tile[thread_index+1] - as->first_tile[thread_index]) {
+		return;
+	}
+	as->num_active[thread_index] = 0;
+	for (t = as->first_tile[thread_index]; t < as->first_tile[thread_index+1];
+		t++) {
+		struct active_tile *tile = &as->tiles[t];
+		if (as->relax_all[thread_index]) {
+			tile->active = 1;
+		} else if (tile->active) {
+			// stop relaxing the tile once it and its neighbours are quiet
+			tile->active = tile->quiet_sweeps < as->quiet_sweeps;
+			for (k = 0; k < tile->num_neighbours && !tile->active; k++) {
+				tile->active = as->tiles[tile->neighbours[k]].quiet_sweeps <
+					as->quiet_sweeps;
+			}
+		} else {
+			// relax the tile again once a neighbour moves the values around it
+			for (k = 0; k < tile->num_neighbours && !tile->active; k++) {
+				tile->active = as->tiles[tile->neighbours[k]].relaxed &&
+					as->tiles[tile->neighbours[k]].quiet_sweeps == 0;
+			}
+		}
+		if (tile->active) {
+			active[as->num_active[thread_index]++] = t;
+		}
+	}
+}
+
+
+/*
+ * Frees the tiles and lists of the active set.
+ */
+void free_active_set(struct active_set* as) {
+	free(as->tiles);
+	free(as->first_tile);
+	free(as->active_tiles);
+	free(as->num_active);
+	free(as->relaxed_tiles);
+	free(as->relax_all);
+	free(as);
+}
@@ -0,0 +1,60 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ *
+ * Header file for the active set of the red-black sweeps, which only relax
+ * the tiles of the square array that are still changing.
+ */
+
+struct active_tile {			// struct representing one tile of the array
+	int start_row;				// first row of the tile
+	int end_row;				// row after the last row of the tile
+	int start_col;				// first column of the tile
+	int end_col;				// column after the last column of the tile
+	int neighbours[4];			// tiles north, south, west and east of it
+	int num_neighbours;			// number of them inside the array
+	int active;					// tile relaxed by the next sweep
+	int relaxed;				// tile relaxed by the last sweep
+	int quiet_sweeps;			// sweeps in a row it changed less than precision
+	double diff;				// largest difference of the last sweep
+};
+
+struct active_set {				// struct shared by the threads of the sweeps
+	int num_thr;				// number of threads relaxing the tiles
+	int tile_size;				// rows and columns of a tile
+	int num_tiles;				// number of tiles of the array
+	int quiet_sweeps;			// quiet sweeps before a tile stops being relaxed
+	double precision;			// precision the array is relaxed to
+	struct active_tile *tiles;	// tiles, row by row, of one thread after another
+	int *first_tile;			// first tile of each thread (and the end)
+	int *active_tiles;			// active tiles of each thread, from its first
+	int *num_active;			// number of active tiles of each thread
+	long *relaxed_tiles;		// tiles relaxed by each thread over all sweeps
+	int *relax_all;				// each thread relaxes all its tiles from now on
+};
+
+
+struct active_set* initialise_active_set(int dim,
+										 int tile_size,
+										 int quiet_sweeps,
+										 double precision,
+										 int num_thr);
+
+
+double relax_active_colour(struct active_set* as,
+						   real** sq_array,
+						   int thread_index,
+						   int colour,
+						   double w);
+
+
+void finish_active_sweep(struct active_set* as, int thread_index);
+
+
+int was_full_sweep(struct active_set* as);
+
+
+void update_active_set(struct active_set* as, int thread_index, int relax_all);
+
+
+void free_active_set(struct active_set* as);
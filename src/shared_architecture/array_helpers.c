@@ -11,37 +11,180 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include "real.h"
+#include "sync_barrier.h"
+#include "worker_pool.h"
 #include "array_helpers.h"
+#include "relaxation_helpers.h"
+#include "grid.h"
+#include "volume.h"
+#include "initial_grid.h"
+
+struct row_placement {			// struct representing input data for a thread
+	struct grid *grid;			// grid whose rows are placed
+	int start_row;				// first row placed by the thread
+	int end_row;				// row after the last row placed by the thread
+};
+
+struct plane_placement {		// struct representing input data for a thread
+	struct volume *volume;		// volume whose planes are placed
+	int start_plane;			// first plane placed by the thread
+	int end_plane;				// plane after the last plane placed by the thread
+};
 
 
 /*
- * Initialises a square array by creating an initial array of pointers, each 
- * looking at a 1D arrays of doubles.
+ * Threaded function that first writes to rows of a grid, so that their pages 
+ * are placed in the memory of the thread's socket.
  */
-double** initialise_square_array(int dim) {
-	long unsigned int dimension = (long unsigned int) dim;
-	double **sq_array;
-	int i, j;
+static void* place_rows(void* arg) {
+	struct row_placement *placement = (struct row_placement*) arg;
+	clear_grid_rows(placement->grid, placement->start_row, placement->end_row);
+	return NULL;
+}
 
-	// allocate space for a 1D array of double pointers.
-	sq_array = malloc(dimension * sizeof(double*));
-	check_double_malloc(sq_array);
 
-	// allocate space for multiple 1D arrays of doubles
-	for (i = 0; i < dim; i++) {
-		sq_array[i] = malloc(dimension * sizeof(double));
-		check_double_malloc(sq_array);
+/*
+ * Allocates the grid of a square array (see common/grid.c). The rows are first
+ * written by the threads of the pool, each of them writing the band of rows it
+ * relaxes (the first and last threads also writing the boundary rows), so 
+ * that pinned threads find their rows in the memory of their socket.
+ */
+static struct grid* allocate_square_grid(int dim, int num_buffers, 
+	struct worker_pool* pool) {
+	struct grid *grid = allocate_grid(dim, dim, 0, num_buffers);
+	struct row_placement placements[pool->num_thr];
+	int i;
+
+	for (i = 0; i < pool->num_thr; i++) {
+		placements[i].grid = grid;
+		band_of_rows(dim, i, pool->num_thr, &placements[i].start_row, 
+			&placements[i].end_row);
+		if (i == 0) {
+			placements[i].start_row = 0;
+		}
+		if (i == pool->num_thr - 1) {
+			placements[i].end_row = dim;
+		}
 	}
+	run_worker_pool(pool, place_rows, placements, sizeof(struct row_placement));
+
+	return grid;
+}
+
+
+/*
+ * Initialises the grid of the square array, with a second buffer holding a 
+ * copy of its values if num_buffers is 2, so that boundary values are already
+ * in place (placed by the threads of the pool, see allocate_square_grid).
+ */
+struct grid* initialise_square_array(int dim, int num_buffers, 
+	struct worker_pool* pool) {
+	struct grid *grid;
+	int i, j;
+
+	// allocate space for the array
+	grid = allocate_square_grid(dim, num_buffers, pool);
 
 	// populate the array with random doubles
 	for (i = 0; i < dim; i++) {
 		for (j = 0; j < dim; j++) {
-			sq_array[i][j] = (double)(rand() % 100);
-			//sq_array[i][j] = (double)(i*dim+j*j+1);
+			grid->rows[i][j] = (real)(rand() % 100);
+			//grid->rows[i][j] = (double)(i*dim+j*j+1);
 		}
 	}
+	if (num_buffers == 2) {
+		copy_grid_buffer(grid);
+	}
+
+	return grid;
+}
+
+
+/*
+ * Threaded function that first writes to planes of a volume and generates 
+ * their values (see common/initial_grid.c), so that their pages are placed in
+ * the memory of the thread's socket.
+ */
+static void* place_planes(void* arg) {
+	struct plane_placement *placement = (struct plane_placement*) arg;
+	struct volume *v = placement->volume;
+
+	clear_volume_planes(v, placement->start_plane, placement->end_plane);
+	initialise_volume_values(&v->values[(size_t)placement->start_plane * 
+		(size_t)v->plane_pitch], v->pitch, v->plane_pitch, 
+		placement->start_plane, 0, 0, 
+		placement->end_plane - placement->start_plane, v->num_rows, 
+		v->num_cols);
+	return NULL;
+}
+
+
+/*
+ * Initialises the volume of a cube (see common/volume.c), with a second buffer
+ * holding a copy of its values if num_buffers is 2. The planes are first 
+ * written by the threads of the pool, each of them generating the slab of 
+ * planes it relaxes (the first and last threads also generating the boundary 
+ * planes), the same way as the square array.
+ */
+struct volume* initialise_cube(int dim, int num_buffers, 
+	struct worker_pool* pool) {
+	struct volume *cube = allocate_volume(dim, dim, dim, num_buffers);
+	struct plane_placement placements[pool->num_thr];
+	int i;
+
+	for (i = 0; i < pool->num_thr; i++) {
+		placements[i].volume = cube;
+		band_of_rows(dim, i, pool->num_thr, &placements[i].start_plane, 
+			&placements[i].end_plane);
+		if (i == 0) {
+			placements[i].start_plane = 0;
+		}
+		if (i == pool->num_thr - 1) {
+			placements[i].end_plane = dim;
+		}
+	}
+	run_worker_pool(pool, place_planes, placements, 
+		sizeof(struct plane_placement));
+	if (num_buffers == 2) {
+		copy_volume_buffer(cube);
+	}
+
+	return cube;
+}
+
+
+/*
+ * Initialises the grid of a square array of zeros, with a second buffer of 
+ * zeros if num_buffers is 2, used by the coarse levels of multigrid and by 
+ * conjugate gradient.
+ */
+struct grid* initialise_zero_grid(int dim, int num_buffers) {
+	struct grid *grid = allocate_grid(dim, dim, 0, num_buffers);
+	clear_grid_rows(grid, 0, dim);
+	return grid;
+}
+
+
+/*
+ * Initialises a 1D array of doubles, one per thread, used to share the largest
+ * difference found by each thread during a sweep.
+ */
+double* initialise_diff_array(int num_thr) {
+	long unsigned int size = (long unsigned int) num_thr;
+	double *diff_array;
+	int i;
+
+	diff_array = malloc(size * sizeof(double));
+	if (diff_array == NULL) {
+		fprintf(stderr, "Failed to allocate space for the array.\n");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < num_thr; i++) {
+		diff_array[i] = 0.0;
+	}
 
-	return sq_array;
+	return diff_array;
 }
 
 
@@ -80,7 +223,7 @@ pthread_mutex_t** initialise_mutex_array(int dim) {
  * square array of doubles.
  * If not, exit the program with a failure.
  */
-void check_double_malloc(double** square_array) {
+void check_double_malloc(real** square_array) {
 	if (square_array == NULL) {
 		fprintf(stderr, "Failed to allocate space for the array.\n");
 		exit(EXIT_FAILURE);
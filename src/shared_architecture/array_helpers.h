@@ -8,13 +8,26 @@
  * Date: 19-Nov-2018
  */
 
-double** initialise_square_array(int dim);
+struct grid* initialise_square_array(int dim, 
+									 int num_buffers, 
+									 struct worker_pool* pool);
+
+
+struct volume* initialise_cube(int dim, 
+							   int num_buffers, 
+							   struct worker_pool* pool);
+
+
+struct grid* initialise_zero_grid(int dim, int num_buffers);
+
+
+double* initialise_diff_array(int num_thr);
 
 
 pthread_mutex_t** initialise_mutex_array(int dim);
 
  
-void check_double_malloc(double** square_array);
+void check_double_malloc(real** square_array);
 
 
 void check_mutex_malloc(pthread_mutex_t** mutex_array);
\ No newline at end of file
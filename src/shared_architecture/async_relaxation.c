@@ -0,0 +1,192 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ *
+ * Source file for the asynchronous (chaotic) relaxation, in which threads
+ * relax their own band of rows without locks or barriers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "real.h"
+#include "relaxation_helpers.h"
+#include "async_relaxation.h"
+
+
+/*
+ * Initialises the counters of the threads relaxing the square array in place.
+ */
+struct async_relaxation* initialise_async_relaxation(real** square_array,
+	int dim, int num_thr) {
+	struct async_relaxation *ar = malloc(sizeof(struct async_relaxation));
+	if (ar == NULL) {
+		fprintf(stderr, "Failed to allocate space for the asynchronous "
+			"relaxation.\n");
+		exit(EXIT_FAILURE);
+	}
+	ar->sweeps = calloc((size_t)num_thr, sizeof(long));
+	if (ar->sweeps == NULL) {
+		fprintf(stderr, "Failed to allocate space for the asynchronous "
+			"relaxation.\n");
+		exit(EXIT_FAILURE);
+	}
+	ar->dim = dim;
+	ar->num_thr = num_thr;
+	ar->values = square_array;
+	ar->noisy_sweeps = 0;
+	ar->stop = 0;
+	return ar;
+}
+
+
+/*
+ * Initialises the snapshot of the counters of a thread, which is taken after
+ * its first sweep.
+ */
+struct async_snapshot* initialise_async_snapshot(struct async_relaxation* ar) {
+	struct async_snapshot *snapshot = malloc(sizeof(struct async_snapshot));
+	if (snapshot == NULL) {
+		fprintf(stderr, "Failed to allocate space for the asynchronous "
+			"relaxation.\n");
+		exit(EXIT_FAILURE);
+	}
+	snapshot->sweeps = calloc((size_t)ar->num_thr, sizeof(long));
+	if (snapshot->sweeps == NULL) {
+		fprintf(stderr, "Failed to allocate space for the asynchronous "
+			"relaxation.\n");
+		exit(EXIT_FAILURE);
+	}
+	snapshot->noisy_sweeps = -1;
+	return snapshot;
+}
+
+
+/*
+ * Relaxes the values of row i that have the given colour in place, reading
+ * and writing all values with relaxed atomic operations, as the row above or
+ * below is relaxed by another thread and this row is read by it.
+ * Returns the largest difference between an old and a new value.
+ */
+static double relax_shared_row(real** sq_array, int dimension, int i,
+	int colour) {
+	double max_diff = 0.0;
+	double difference;
+	real left, right, up, down, old_value, new_value;
+	int j;
+
+	for (j = 1 + (i + 1 + colour) % 2; j < dimension - 1; j += 2) {
+		__atomic_load(&sq_array[i][j-1], &left, __ATOMIC_RELAXED);
+		__atomic_load(&sq_array[i][j+1], &right, __ATOMIC_RELAXED);
+		__atomic_load(&sq_array[i-1][j], &up, __ATOMIC_RELAXED);
+		__atomic_load(&sq_array[i+1][j], &down, __ATOMIC_RELAXED);
+		__atomic_load(&sq_array[i][j], &old_value, __ATOMIC_RELAXED);
+		new_value = (left + right + up + down) / 4;
+		__atomic_store(&sq_array[i][j], &new_value, __ATOMIC_RELAXED);
+
+		difference = (double)fabs(new_value - old_value);
+		if (difference > max_diff) {
+			max_diff = difference;
+		}
+	}
+	return max_diff;
+}
+
+
+/*
+ * Relaxes the rows start_row to end_row (excluded) with one red-black sweep,
+ * the first and last rows being shared with the neighbouring threads.
+ * Returns the largest difference between an old and a new value (0 for the
+ * empty bands of threads left without rows).
+ */
+double async_sweep(struct async_relaxation* ar, int start_row, int end_row) {
+	double max_diff = 0.0;
+	double difference;
+	int colour;
+
+	if (start_row >= end_row) {
+		return max_diff;
+	}
+	for (colour = 0; colour < 2; colour++) {
+		difference = relax_shared_row(ar->values, ar->dim, start_row, colour);
+		if (difference > max_diff) {
+			max_diff = difference;
+		}
+		difference = relax_colour(ar->values, NULL, ar->dim, start_row + 1,
+			end_row - 1, colour, 1.0);
+		if (difference > max_diff) {
+			max_diff = difference;
+		}
+		if (end_row - 1 > start_row) {
+			difference = relax_shared_row(ar->values, ar->dim, end_row - 1,
+				colour);
+			if (difference > max_diff) {
+				max_diff = difference;
+			}
+		}
+	}
+	return max_diff;
+}
+
+
+/*
+ * Counts a sweep of thread thread_index (0-based), noisy unless is_quiet, and
+ * looks for the end of the relaxation with the thread's snapshot: once every
+ * thread completed 2 more sweeps since the snapshot and no sweep was noisy in
+ * the meantime, every band is relaxed to the precision and all threads stop.
+ * Returns 1 if the thread must stop, 0 otherwise.
+ */
+int finish_async_sweep(struct async_relaxation* ar, int thread_index,
+	int is_quiet, struct async_snapshot* snapshot) {
+	long noisy_sweeps;
+	int t;
+
+	if (!is_quiet) {
+		__atomic_add_fetch(&ar->noisy_sweeps, 1, __ATOMIC_SEQ_CST);
+	}
+	__atomic_add_fetch(&ar->sweeps[thread_index], 1, __ATOMIC_SEQ_CST);
+
+	// start over from a new snapshot after a noisy sweep
+	noisy_sweeps = __atomic_load_n(&ar->noisy_sweeps, __ATOMIC_SEQ_CST);
+	if (noisy_sweeps != snapshot->noisy_sweeps) {
+		snapshot->noisy_sweeps = noisy_sweeps;
+		for (t = 0; t < ar->num_thr; t++) {
+			snapshot->sweeps[t] = __atomic_load_n(&ar->sweeps[t],
+				__ATOMIC_SEQ_CST);
+		}
+		return __atomic_load_n(&ar->stop, __ATOMIC_SEQ_CST);
+	}
+
+	// wait for a whole sweep of every thread after the snapshot
+	for (t = 0; t < ar->num_thr; t++) {
+		if (__atomic_load_n(&ar->sweeps[t], __ATOMIC_SEQ_CST) <
+			snapshot->sweeps[t] + 2) {
+			return __atomic_load_n(&ar->stop, __ATOMIC_SEQ_CST);
+		}
+	}
+
+	// none of the sweeps counted since the snapshot was noisy
+	if (__atomic_load_n(&ar->noisy_sweeps, __ATOMIC_SEQ_CST) == noisy_sweeps) {
+		__atomic_store_n(&ar->stop, 1, __ATOMIC_SEQ_CST);
+	}
+	return __atomic_load_n(&ar->stop, __ATOMIC_SEQ_CST);
+}
+
+
+/*
+ * Frees the snapshot of a thread.
+ */
+void free_async_snapshot(struct async_snapshot* snapshot) {
+	free(snapshot->sweeps);
+	free(snapshot);
+}
+
+
+/*
+ * Frees the counters of the relaxation (the values are the square array,
+ * which is freed separately).
+ */
+void free_async_relaxation(struct async_relaxation* ar) {
+	free(ar->sweeps);
+	free(ar);
+}
@@ -0,0 +1,44 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ *
+ * Header file for the asynchronous (chaotic) relaxation, in which threads
+ * relax their own band of rows without locks or barriers.
+ */
+
+struct async_relaxation {		// struct shared by the threads relaxing
+	int dim;					// square array dimensions
+	int num_thr;				// number of threads relaxing
+	real **values;				// square array relaxed in place
+	long *sweeps;				// sweeps completed by each thread
+	long noisy_sweeps;			// sweeps that changed a value by the precision
+	int stop;					// termination was detected by a thread
+};
+
+struct async_snapshot {			// counters seen by a thread detecting the end
+	long noisy_sweeps;			// noisy sweeps when the snapshot was taken
+	long *sweeps;				// sweeps of each thread at the same time
+};
+
+
+struct async_relaxation* initialise_async_relaxation(real** square_array,
+													 int dim,
+													 int num_thr);
+
+
+struct async_snapshot* initialise_async_snapshot(struct async_relaxation* ar);
+
+
+double async_sweep(struct async_relaxation* ar, int start_row, int end_row);
+
+
+int finish_async_sweep(struct async_relaxation* ar,
+					   int thread_index,
+					   int is_quiet,
+					   struct async_snapshot* snapshot);
+
+
+void free_async_snapshot(struct async_snapshot* snapshot);
+
+
+void free_async_relaxation(struct async_relaxation* ar);
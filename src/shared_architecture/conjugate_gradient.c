@@ -0,0 +1,238 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ * 
+ * Source file for the preconditioned conjugate gradient solver, run by all 
+ * threads at once.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "real.h"
+#include "grid.h"
+#include "sync_barrier.h"
+#include "worker_pool.h"
+#include "array_helpers.h"
+#include "conjugate_gradient.h"
+
+
+/*
+ * Initialises the arrays of the conjugate gradient solver, which solves the 
+ * square array in place.
+ */
+struct conjugate_gradient* initialise_conjugate_gradient(real** square_array,
+	int dim, int num_thr, struct sync_barrier* barrier) {
+	struct conjugate_gradient *cg = malloc(sizeof(struct conjugate_gradient));
+	if (cg == NULL) {
+		fprintf(stderr, "Failed to allocate space for the conjugate gradient "
+			"solver.\n");
+		exit(EXIT_FAILURE);
+	}
+	cg->dim = dim;
+	cg->num_thr = num_thr;
+	cg->barrier = barrier;
+	cg->values = square_array;
+	cg->residual_grid = initialise_zero_grid(dim, 2);
+	cg->direction_grid = initialise_zero_grid(dim, 2);
+	cg->residuals = cg->residual_grid->rows;
+	cg->preconditioned = cg->residual_grid->next_rows;
+	cg->directions = cg->direction_grid->rows;
+	cg->products = cg->direction_grid->next_rows;
+	cg->thread_residual_product = initialise_diff_array(num_thr);
+	cg->thread_max_residual = initialise_diff_array(num_thr);
+	return cg;
+}
+
+
+/*
+ * Returns the sum of the shares of all threads. Must be called after the 
+ * barrier that ends the step the shares were computed in.
+ */
+double reduce_sum(struct conjugate_gradient* cg, double* thread_shares) {
+	double sum = 0.0;
+	int t;
+	for (t = 0; t < cg->num_thr; t++) {
+		sum += thread_shares[t];
+	}
+	return sum;
+}
+
+
+/*
+ * Returns the largest value of all threads. Must be called after the barrier 
+ * that ends the step the values were computed in.
+ */
+double reduce_max(struct conjugate_gradient* cg, double* thread_values) {
+	double max = 0.0;
+	int t;
+	for (t = 0; t < cg->num_thr; t++) {
+		if (thread_values[t] > max) {
+			max = thread_values[t];
+		}
+	}
+	return max;
+}
+
+
+/*
+ * Relaxes the preconditioned values of the cells of the given colour (0: red,
+ * 1: black) of the thread's rows towards A z = r, from the preconditioned 
+ * values of the other colour around them, or from 0 if from_zero is set.
+ */
+static void precondition_colour(struct conjugate_gradient* cg, int start_row, 
+	int end_row, int colour, bool from_zero) {
+	real **z = cg->preconditioned;
+	real **r = cg->residuals;
+	int i, j;
+
+	for (i = start_row; i < end_row; i++) {
+		for (j = 1 + (i + 1 + colour) % 2; j < cg->dim - 1; j += 2) {
+			if (from_zero) {
+				z[i][j] = r[i][j] / 4;
+			} else {
+				z[i][j] = (r[i][j] + z[i][j-1] + z[i][j+1] + z[i-1][j] + 
+					z[i+1][j]) / 4;
+			}
+		}
+	}
+}
+
+
+/*
+ * Applies the preconditioner to the residuals of the thread's rows, meeting 
+ * the other threads between colours as the cells of a colour read the rows 
+ * of the neighbouring threads, stores the thread's share of r.z and largest 
+ * residual, and waits for all threads.
+ * Returns the largest change a Jacobi sweep would still make to a value, 
+ * which is the residual divided by 4, so that the solver stops at the same 
+ * precision as the relaxation modes.
+ */
+double precondition(struct conjugate_gradient* cg, int thread_index, 
+	int start_row, int end_row, double* residual_product) {
+	double product = 0.0;
+	double max_residual = 0.0;
+	int i, j;
+
+	precondition_colour(cg, start_row, end_row, 0, true);
+	sync_barrier_wait(cg->barrier);
+	precondition_colour(cg, start_row, end_row, 1, false);
+	sync_barrier_wait(cg->barrier);
+	precondition_colour(cg, start_row, end_row, 0, false);
+
+	for (i = start_row; i < end_row; i++) {
+		for (j = 1; j < cg->dim - 1; j++) {
+			product += cg->residuals[i][j] * cg->preconditioned[i][j];
+			if (fabs(cg->residuals[i][j]) > max_residual) {
+				max_residual = fabs(cg->residuals[i][j]);
+			}
+		}
+	}
+	cg->thread_residual_product[thread_index] = product;
+	cg->thread_max_residual[thread_index] = max_residual;
+	sync_barrier_wait(cg->barrier);
+
+	*residual_product = reduce_sum(cg, cg->thread_residual_product);
+	return reduce_max(cg, cg->thread_max_residual) / 4;
+}
+
+
+/*
+ * Computes the residuals r = b - A u of the thread's rows and the first search
+ * directions p = z. Must be called by all threads at once.
+ * Stores r.z in residual_product and returns the largest change a Jacobi 
+ * sweep would make to a value.
+ */
+double start_conjugate_gradient(struct conjugate_gradient* cg, 
+	int thread_index, int start_row, int end_row, double* residual_product) {
+	real **u = cg->values;
+	double max_change;
+	int i, j;
+
+	for (i = start_row; i < end_row; i++) {
+		for (j = 1; j < cg->dim - 1; j++) {
+			cg->residuals[i][j] = u[i][j-1] + u[i][j+1] + u[i-1][j] + 
+				u[i+1][j] - 4 * u[i][j];
+		}
+	}
+	max_change = precondition(cg, thread_index, start_row, end_row, 
+		residual_product);
+
+	for (i = start_row; i < end_row; i++) {
+		for (j = 1; j < cg->dim - 1; j++) {
+			cg->directions[i][j] = cg->preconditioned[i][j];
+		}
+	}
+
+	// the products read the directions of the neighbouring threads' rows
+	sync_barrier_wait(cg->barrier);
+	return max_change;
+}
+
+
+/*
+ * Runs one conjugate gradient iteration on the thread's rows: moves the 
+ * values along the search directions by the step that minimises the error, 
+ * updates the residuals and picks the next search directions. Must be called 
+ * by all threads at once, with the r.z returned by the previous iteration.
+ * Returns the largest change a Jacobi sweep would still make to a value.
+ */
+double conjugate_gradient_iteration(struct conjugate_gradient* cg, 
+	int thread_index, int start_row, int end_row, double* residual_product) {
+	real **p = cg->directions;
+	real **ap = cg->products;
+	double product = 0.0;
+	double alpha, beta, previous_residual_product, max_change;
+	int i, j;
+
+	// products A p, the directions are 0 on the boundary
+	for (i = start_row; i < end_row; i++) {
+		for (j = 1; j < cg->dim - 1; j++) {
+			ap[i][j] = 4 * p[i][j] - 
+				(p[i][j-1] + p[i][j+1] + p[i-1][j] + p[i+1][j]);
+			product += p[i][j] * ap[i][j];
+		}
+	}
+	product = sync_barrier_reduce(cg->barrier, thread_index, product, 
+		REDUCE_SUM);
+
+	// the directions are 0 once the values are exact
+	alpha = product > 0.0 ? *residual_product / product : 0.0;
+
+	// move along the directions
+	for (i = start_row; i < end_row; i++) {
+		for (j = 1; j < cg->dim - 1; j++) {
+			cg->values[i][j] += (real)(alpha * p[i][j]);
+			cg->residuals[i][j] -= (real)(alpha * ap[i][j]);
+		}
+	}
+	previous_residual_product = *residual_product;
+	max_change = precondition(cg, thread_index, start_row, end_row, 
+		residual_product);
+
+	// next directions, conjugate to the previous ones
+	beta = previous_residual_product > 0.0 ? 
+		*residual_product / previous_residual_product : 0.0;
+	for (i = start_row; i < end_row; i++) {
+		for (j = 1; j < cg->dim - 1; j++) {
+			p[i][j] = (real)(cg->preconditioned[i][j] + beta * p[i][j]);
+		}
+	}
+	sync_barrier_wait(cg->barrier);
+	return max_change;
+}
+
+
+/*
+ * Frees the arrays of the solver (the values are the square array, which is 
+ * freed separately).
+ */
+void free_conjugate_gradient(struct conjugate_gradient* cg) {
+	free_grid(cg->residual_grid);
+	free_grid(cg->direction_grid);
+	free(cg->thread_residual_product);
+	free(cg->thread_max_residual);
+	free(cg);
+}
@@ -0,0 +1,45 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ * 
+ * Header file for the preconditioned conjugate gradient solver, run by all 
+ * threads at once.
+ */
+
+struct conjugate_gradient {		// struct shared by the threads solving
+	int dim;					// square array dimensions
+	int num_thr;				// number of threads solving
+	struct sync_barrier *barrier;	// barrier threads meet at between steps
+	real **values;				// square array being solved in place
+	real **residuals;			// r = b - A u
+	real **preconditioned;		// z = M^-1 r
+	real **directions;			// search directions p
+	real **products;			// A p
+	struct grid *residual_grid;	// grid of r and z (second buffer)
+	struct grid *direction_grid;	// grid of p and A p (second buffer)
+	double *thread_residual_product;	// each thread's share of r.z
+	double *thread_max_residual;		// each thread's largest residual
+};
+
+
+struct conjugate_gradient* initialise_conjugate_gradient(real** square_array,
+														 int dim, 
+														 int num_thr, 
+														 struct sync_barrier* barrier);
+
+
+double start_conjugate_gradient(struct conjugate_gradient* cg, 
+								int thread_index, 
+								int start_row, 
+								int end_row, 
+								double* residual_product);
+
+
+double conjugate_gradient_iteration(struct conjugate_gradient* cg, 
+									int thread_index, 
+									int start_row, 
+									int end_row, 
+									double* residual_product);
+
+
+void free_conjugate_gradient(struct conjugate_gradient* cg);
@@ -0,0 +1,113 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ *
+ * Source file for the binary grid files the square array is read from and
+ * written to.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "real.h"
+#include "grid_file.h"
+
+#define GRID_MAGIC "RELAXGRD"
+#define GRID_MAGIC_LENGTH 8
+#define GRID_HEADER_LENGTH 16
+
+
+/*
+ * Opens the given grid file in the given mode, exiting if it can't be opened.
+ */
+static FILE* open_grid_file(const char* filename, const char* mode) {
+	FILE *file = fopen(filename, mode);
+	if (file == NULL) {
+		fprintf(stderr, "Error: could not open grid file %s.\n", filename);
+		exit(EXIT_FAILURE);
+	}
+	return file;
+}
+
+
+/*
+ * Reads the dimension of the square array held in the given grid file.
+ */
+int read_grid_dimension(const char* filename) {
+	FILE *file = open_grid_file(filename, "rb");
+	char header[GRID_HEADER_LENGTH];
+	int64_t dimension = 0;
+
+	if (fread(header, 1, GRID_HEADER_LENGTH, file) == GRID_HEADER_LENGTH) {
+		memcpy(&dimension, &header[GRID_MAGIC_LENGTH], sizeof(dimension));
+	}
+	fclose(file);
+	if (memcmp(header, GRID_MAGIC, GRID_MAGIC_LENGTH) != 0 || dimension < 3 ||
+		dimension > INT32_MAX) {
+		fprintf(stderr, "Error: %s is not a grid file.\n", filename);
+		exit(EXIT_FAILURE);
+	}
+	return (int)dimension;
+}
+
+
+/*
+ * Reads the values of the square array of dimension dim held in the given
+ * grid file into the rows of the array.
+ */
+void read_grid_file(const char* filename, real** rows, int dim) {
+	FILE *file = open_grid_file(filename, "rb");
+	double *buffer = malloc((size_t)dim * sizeof(double));
+	int i, j;
+
+	if (buffer == NULL) {
+		fprintf(stderr, "Error: grid file buffer could not be allocated.\n");
+		exit(EXIT_FAILURE);
+	}
+	fseek(file, GRID_HEADER_LENGTH, SEEK_SET);
+	for (i = 0; i < dim; i++) {
+		if (fread(buffer, sizeof(double), (size_t)dim, file) != (size_t)dim) {
+			fprintf(stderr, "Error: could not read grid file %s.\n", filename);
+			exit(EXIT_FAILURE);
+		}
+		for (j = 0; j < dim; j++) {
+			rows[i][j] = (real)buffer[j];
+		}
+	}
+	free(buffer);
+	fclose(file);
+}
+
+
+/*
+ * Writes the rows of the square array of dimension dim to the given grid
+ * file.
+ */
+void write_grid_file(const char* filename, real** rows, int dim) {
+	FILE *file = open_grid_file(filename, "wb");
+	double *buffer = malloc((size_t)dim * sizeof(double));
+	char header[GRID_HEADER_LENGTH];
+	int64_t header_dimension = dim;
+	int i, j;
+
+	if (buffer == NULL) {
+		fprintf(stderr, "Error: grid file buffer could not be allocated.\n");
+		exit(EXIT_FAILURE);
+	}
+	memcpy(header, GRID_MAGIC, GRID_MAGIC_LENGTH);
+	memcpy(&header[GRID_MAGIC_LENGTH], &header_dimension,
+		sizeof(header_dimension));
+	fwrite(header, 1, GRID_HEADER_LENGTH, file);
+	for (i = 0; i < dim; i++) {
+		for (j = 0; j < dim; j++) {
+			buffer[j] = (double)rows[i][j];
+		}
+		fwrite(buffer, sizeof(double), (size_t)dim, file);
+	}
+	free(buffer);
+	if (fclose(file) != 0) {
+		fprintf(stderr, "Error: could not write grid file %s.\n", filename);
+		exit(EXIT_FAILURE);
+	}
+}
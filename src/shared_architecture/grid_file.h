@@ -0,0 +1,15 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ *
+ * Header file for the binary grid files the square array is read from and
+ * written to.
+ */
+
+int read_grid_dimension(const char* filename);
+
+
+void read_grid_file(const char* filename, real** rows, int dim);
+
+
+void write_grid_file(const char* filename, real** rows, int dim);
@@ -6,9 +6,27 @@
  * architecture using pthreads
  *
  * Local usage: 
- * 1) "gcc main.c array_helpers.c print_helpers.c -o shared_relaxation -pthread -Wall 
- *     -Wextra -Wconversion"
- * 2) "./shared_relaxation <number_of_threads>"
+ * 1) "gcc -O2 -I../common main.c array_helpers.c print_helpers.c 
+ *     relaxation_helpers.c multigrid.c conjugate_gradient.c 
+ *     async_relaxation.c task_graph.c active_set.c sync_barrier.c 
+ *     worker_pool.c thread_affinity.c ../common/stencil_kernel.c 
+ *     ../common/wavefront.c ../common/grid.c ../common/stall.c 
+ *     ../common/stencil_operator.c ../common/volume.c ../common/volume_sweep.c
+ *     ../common/initial_grid.c ../common/coarsening.c 
+ *     ../common/mixed_precision.c ../common/single_stencil_kernel.c 
+ *     grid_file.c
+ *     -o shared_relaxation 
+ *     -pthread -lm -Wall -Wextra -Wconversion 
+ *     [-DSINGLE_PRECISION]" 
+ *     (or "make", "make PRECISION=single")
+ * 2) "./shared_relaxation <number_of_threads> -m <mode> -d <dimension> 
+ *     -p <precision> -block <jacobi sweeps per wavefront> 
+ *     -tile <tile size> -active <quiet sweeps before skipping a tile> 
+ *     -affinity <none|compact|scatter> -stencil <5|9> 
+ *     -coef <coefficient of the inclusion> -source <source term> 
+ *     -shape <square|cube> -mixed <precision of single precision sweeps> 
+ *     -input <grid file> -output <grid file>"
+ * example: "./shared_relaxation 16 -m jacobi -d 1024 -p 0.01"
  * 
  * Author: Adam Jaamour
  * Date: 19-Nov-2018
@@ -16,12 +34,60 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include <math.h>
 #include <pthread.h>
+#include <sched.h>
 #include <sys/time.h>
+#include "real.h"
+#include "sync_barrier.h"
+#include "worker_pool.h"
 #include "array_helpers.h"
 #include "print_helpers.h"
+#include "relaxation_helpers.h"
+#include "multigrid.h"
+#include "conjugate_gradient.h"
+#include "async_relaxation.h"
+#include "stall.h"
+#include "task_graph.h"
+#include "active_set.h"
+#include "stencil_kernel.h"
+#include "stencil_operator.h"
+#include "wavefront.h"
+#include "thread_affinity.h"
+#include "grid.h"
+#include "volume.h"
+#include "volume_sweep.h"
+#include "mixed_precision.h"
+#include "grid_file.h"
+
+#define OMEGA_ADAPT_SWEEPS 20		// sweeps between two estimates of omega
+#define OMEGA_ADAPT_TOLERANCE 0.001	// smallest omega increase to keep adapting
+
+
+/* Relaxation modes that can be selected from the command line */
+enum relaxation_mode {
+	MODE_MUTEX,					// all threads sweep the array, locking values
+	MODE_JACOBI,				// threads own rows and meet at a barrier
+	MODE_RED_BLACK,				// in place red then black updates of own rows
+	MODE_SOR,					// red-black updates over-relaxed by omega
+	MODE_MULTIGRID,				// multigrid cycles smoothed by red-black sweeps
+	MODE_CONJUGATE_GRADIENT,	// preconditioned conjugate gradient iterations
+	MODE_ASYNC,					// threads relax own rows without waiting
+	MODE_DATAFLOW				// tiles relaxed once their neighbours are ready
+};
+
+/* Ways of choosing the relaxation factor of the SOR mode */
+enum omega_choice {
+	OMEGA_FIXED,				// omega given on the command line
+	OMEGA_AUTO,					// theoretical optimum for the array dimension
+	OMEGA_ADAPT					// estimated from the observed convergence rate
+};
+
+const char *mode_names[] = {"mutex", "jacobi", "redblack", "sor", "multigrid", 
+	"cg", "async", "dataflow"};
+const char *affinity_names[] = {"none", "compact", "scatter"};
 
 
 /* Global variables */
@@ -29,11 +95,47 @@ bool DEBUG = false;				// print data to the command line
 int dim = 100;					// square array dimensions
 int num_thr;					// number of threads to use
 double precision = 0.01f;		// precision to perform relaxation at
-double **square_array;			// global square array of double
+enum relaxation_mode mode = MODE_JACOBI;	// relaxation mode to use
+enum omega_choice omega_choice = OMEGA_AUTO;	// how SOR picks omega
+double omega = 1.0;				// relaxation factor used by red-black sweeps
+int cycle_index = 1;			// multigrid coarse level visits (1: V, 2: W)
+int max_levels = 0;				// multigrid levels to use (0: as many as can be)
+int block_sweeps = 1;			// jacobi sweeps run over rows while in cache
+int tile_size = 64;				// rows and columns of a dataflow or active tile
+int active_sweeps = 0;			// quiet sweeps before a tile is skipped (0: none)
+enum affinity_policy affinity = AFFINITY_NONE;	// how threads are pinned
+int stencil_points = 5;			// points of the Laplacian (5 or 9)
+double contrast = 1.0;			// coefficient of the inclusion (1: uniform)
+double source = 0.0;			// source term of the Poisson equation
+struct stencil_operator op;		// equation relaxed (see stencil_operator.c)
+bool is_cube = false;			// relax a cube instead of a square array
+double mixed_precision = 0.0;	// precision of single precision sweeps (0: none)
+struct single_grid *single;		// single precision copy of the array (or NULL)
+char *input_file = NULL;		// grid file of the initial values (or NULL)
+char *output_file = NULL;		// grid file the relaxed array is written to
+int single_iteration_count;		// number of single precision sweeps
+struct volume *cube;			// volume holding the cube (NULL if square)
+struct grid *coefficient_grid;	// coefficients of the cells (NULL if uniform)
+real **coefficients;			// rows of the coefficients (NULL if uniform)
+int *thread_cpus;				// cpu each thread is pinned to (NULL if not)
+struct multigrid *mg;			// multigrid levels shared by the threads
+struct conjugate_gradient *cg;	// conjugate gradient arrays shared by threads
+struct async_relaxation *ar;	// sweep counters shared by async threads
+struct task_graph *tg;			// tiles and tasks shared by dataflow threads
+struct active_set *as;			// tiles relaxed by red-black sweeps (or NULL)
+struct grid *grid;				// grid holding the square array
+real **square_array;			// global square array of values
+real **new_square_array;		// second buffer written to by jacobi modes
 pthread_mutex_t **mutex_array;	// array of mutexes to lock square array values
+struct worker_pool *pool;		// threads running every parallel job
+struct sync_barrier barrier;	// barrier threads meet at after every sweep
+double *thread_max_diff;		// largest difference of each async thread
+int iteration_count;			// number of sweeps needed to reach precision
 struct timeval time1, time2;	// structure used to calculate program time
 struct relaxation_data {		// struct representing input data for a thread
 	int thr_number;				// thread number (in order of creation)
+	int start_row;				// first row relaxed by the thread
+	int end_row;				// row after the last row relaxed by the thread
 };
 
 
@@ -72,16 +174,16 @@ void* relaxation_runner(void* arg) {
 			for (j = 1; j < dim - 1; j++) {
 				// lock and retrieve current value to replace
 				pthread_mutex_lock(&mutex_array[i][j]);
-				double old_value = square_array[i][j];
+				real old_value = square_array[i][j];
 
 				// retrieve the 4 surrounding values needed to average
-				double v_left = square_array[i][j-1];
-				double v_right = square_array[i][j+1];
-				double v_up = square_array[i-1][j];
-				double v_down = square_array[i+1][j];
+				real v_left = square_array[i][j-1];
+				real v_right = square_array[i][j+1];
+				real v_up = square_array[i-1][j];
+				real v_down = square_array[i+1][j];
 
 				// calculate new value, replace the old value and unlock
-				double new_value = (v_left + v_right + v_up + v_down) / 4;
+				real new_value = (v_left + v_right + v_up + v_down) / 4;
 				square_array[i][j] = new_value;
 				pthread_mutex_unlock(&mutex_array[i][j]);
 				updates_counter++;
@@ -119,7 +221,811 @@ void* relaxation_runner(void* arg) {
 	if (DEBUG) printf("Thread %d (id #%lu) exited.\n\n", thread_number, 
 		pthread_self());
 	
-	pthread_exit(0);
+	return NULL;
+}
+
+
+/*
+ * Relaxes the thread's band of rows of the single precision copy of the 
+ * square array (see common/mixed_precision.c) with Jacobi sweeps, or with 
+ * red-black sweeps over-relaxed by w, until a sweep changes every value by 
+ * less than the precision of the mixed precision mode or the sweeps stall, 
+ * then copies the band back into the square array. The first and last 
+ * threads also copy the boundary rows. Largest differences are reduced the 
+ * same way as in the Jacobi mode.
+ * Returns the number of sweeps.
+ */
+int single_precision_sweeps(int thread_number, int start_row, int end_row, 
+	bool red_black, double w) {
+	float **current_rows = single->rows;
+	float **next_rows = single->next_rows;
+	float **temp_rows;
+	int first_row = start_row == 1 ? 0 : start_row;
+	int last_row = end_row == dim - 1 ? dim : end_row;
+	int sweeps = 0;
+	double max_diff, black_diff;
+	struct stall stall;
+
+	// the boundary values never change, so every buffer starts with them
+	to_single_rows(square_array, current_rows, first_row, last_row, dim);
+	if (!red_black) {
+		to_single_rows(square_array, next_rows, first_row, last_row, dim);
+	}
+	sync_barrier_wait(&barrier);
+
+	initialise_stall(&stall);
+	do {
+		if (red_black) {
+			max_diff = single_colour_rows(current_rows, start_row, end_row, 
+				dim, 0, 0, w);
+			sync_barrier_wait(&barrier);
+			black_diff = single_colour_rows(current_rows, start_row, end_row, 
+				dim, 0, 1, w);
+			if (black_diff > max_diff) {
+				max_diff = black_diff;
+			}
+		} else {
+			max_diff = single_jacobi_rows(current_rows, next_rows, start_row, 
+				end_row, dim);
+		}
+		max_diff = sync_barrier_reduce(&barrier, thread_number - 1, max_diff, 
+			REDUCE_MAX);
+		if (!red_black) {
+			temp_rows = current_rows;
+			current_rows = next_rows;
+			next_rows = temp_rows;
+		}
+		sweeps++;
+	} while (max_diff >= mixed_precision && 
+		!has_float_stalled(&stall, max_diff));
+
+	// neighbouring bands must be copied back before the next sweep reads them
+	to_double_rows(current_rows, square_array, start_row, end_row, dim);
+	sync_barrier_wait(&barrier);
+	if (thread_number == 1) {
+		single_iteration_count = sweeps;
+	}
+	return sweeps;
+}
+
+
+/*
+ * Threaded function that relaxes a contiguous band of rows of the square array
+ * using the Jacobi method: values are read from the current array and written
+ * to the new array, so threads never update a value another thread is reading
+ * and no locking is needed.
+ * Sweeps are run block_sweeps at a time by a wavefront (see wavefront.c), 
+ * each thread also relaxing the block_sweeps rows around its band again so 
+ * that it doesn't need the values of other threads between these sweeps.
+ * At the end of every block of sweeps, threads meet at a barrier with the 
+ * largest difference of the last sweep, and all get back the largest 
+ * difference of all threads (see sync_barrier.c), so that they all agree on 
+ * whether the array is within precision without a second barrier.
+ * In the mixed precision mode, single precision sweeps come first.
+ */
+void* jacobi_runner(void* arg) {
+	// retrieve data from arg
+	struct relaxation_data *arg_struct = (struct relaxation_data*) arg;
+	int thread_number = arg_struct->thr_number;
+	int start_row = arg_struct->start_row;
+	int end_row = arg_struct->end_row;
+
+	// local variables
+	bool is_above_precision = true;
+	int iteration = 0;
+	double max_diff;
+	real **current_array = square_array;
+	real **next_array = new_square_array;
+	real **temp_array;
+	real *current_values = cube != NULL ? cube->values : NULL;
+	real *next_values = cube != NULL ? cube->next_values : NULL;
+	real *temp_values;
+	real *scratch = initialise_wavefront_scratch(dim, block_sweeps);
+	struct stall stall;
+
+	// rows read by the wavefront around the band, within the array
+	int lowest_row = start_row - block_sweeps > 0 ? 
+		start_row - block_sweeps : 0;
+	int highest_row = end_row - 1 + block_sweeps < dim - 1 ? 
+		end_row - 1 + block_sweeps : dim - 1;
+
+	if (DEBUG) {
+		printf("Thread %d (id #%lu) created for rows %d to %d.\n\n", 
+			thread_number, pthread_self(), start_row, end_row - 1);
+	}
+
+	if (single != NULL) {
+		single_precision_sweeps(thread_number, start_row, end_row, false, 1.0);
+	}
+
+	initialise_stall(&stall);
+	while (is_above_precision) {
+		if (cube != NULL) {
+			// the band of the thread is a slab of planes of the cube
+			max_diff = volume_jacobi_sweep(cube, current_values, next_values, 
+				start_row, end_row);
+		} else if (is_plain_laplacian(&op)) {
+			max_diff = wavefront_sweeps(current_array, next_array, start_row, 
+				end_row, lowest_row, highest_row, dim, block_sweeps, scratch);
+		} else {
+			max_diff = operator_rows(&op, current_array, next_array, 
+				coefficients, start_row, end_row, dim);
+		}
+
+		// wait for all threads to finish the block of sweeps, and check if the
+		// difference is smaller than precision for all threads
+		max_diff = sync_barrier_reduce(&barrier, thread_number - 1, max_diff, 
+			REDUCE_MAX);
+		is_above_precision = max_diff >= precision && 
+			!has_stalled(&stall, max_diff);
+
+		// new values become the current values for the next sweep
+		temp_array = current_array;
+		current_array = next_array;
+		next_array = temp_array;
+		temp_values = current_values;
+		current_values = next_values;
+		next_values = temp_values;
+		iteration++;
+	}
+	free(scratch);
+
+	// all threads stop on the same sweep, so only one records the count
+	if (thread_number == 1) {
+		iteration_count = iteration * block_sweeps;
+		warn_if_stalled(max_diff, precision);
+	}
+
+	if (DEBUG) printf("Thread %d (id #%lu) exited.\n\n", thread_number, 
+		pthread_self());
+
+	return NULL;
+}
+
+
+/*
+ * Estimates the optimal relaxation factor from the rate at which the largest 
+ * difference decreased from start_diff to end_diff over the given number of 
+ * sweeps run with relaxation factor w. For red-black ordering, the rate 
+ * lambda and the Jacobi spectral radius mu are related by
+ * (lambda + w - 1)^2 = lambda * w^2 * mu^2, and the optimal factor is 
+ * 2 / (1 + sqrt(1 - mu^2)).
+ * Falls back to the theoretical optimum if the rate can't be measured.
+ */
+double adapted_omega(double start_diff, double end_diff, int sweeps, 
+	double w) {
+	double lambda, mu_squared;
+	if (start_diff <= 0.0 || end_diff <= 0.0) {
+		return optimal_omega(dim);
+	}
+	lambda = pow(end_diff / start_diff, 1.0 / sweeps);
+	if (lambda >= 1.0) {
+		return optimal_omega(dim);
+	}
+	mu_squared = (lambda + w - 1) * (lambda + w - 1) / (lambda * w * w);
+	if (mu_squared >= 1.0) {
+		return optimal_omega(dim);
+	}
+	return 2.0 / (1.0 + sqrt(1.0 - mu_squared));
+}
+
+
+/*
+ * Threaded function that relaxes a contiguous band of rows of the square array
+ * in place using red-black ordered Gauss-Seidel: all red cells are updated,
+ * threads meet at a barrier, then all black cells are updated using the new 
+ * red values. This converges roughly twice as fast as the Jacobi mode while 
+ * staying free of races.
+ * The largest difference of each sweep is reduced the same way as in the 
+ * Jacobi mode.
+ * The SOR mode uses the same sweeps with omega above 1. When omega is adapted,
+ * sweeps start with omega = 1, and every OMEGA_ADAPT_SWEEPS sweeps the rate at
+ * which the largest difference decreased is used to estimate the optimal 
+ * omega. Omega only ever increases, and stops being adapted once estimates 
+ * settle. Every thread sees the same differences, so they all pick the same 
+ * omega.
+ * With an active set (see active_set.c), sweeps skip the tiles that stopped 
+ * changing, and the relaxation only stops after a sweep of every tile within
+ * precision. In the mixed precision mode, single precision sweeps come first.
+ */
+void* red_black_runner(void* arg) {
+	// retrieve data from arg
+	struct relaxation_data *arg_struct = (struct relaxation_data*) arg;
+	int thread_number = arg_struct->thr_number;
+	int start_row = arg_struct->start_row;
+	int end_row = arg_struct->end_row;
+
+	// local variables
+	bool is_above_precision = true;
+	int iteration = 0;
+	double max_diff, black_diff;
+	double adapt_start_diff = 0.0;	// largest difference when a window starts
+	double w = omega_choice == OMEGA_ADAPT ? 1.0 : omega;
+	double new_w;
+	bool adapting = omega_choice == OMEGA_ADAPT;
+	struct stall stall;
+
+	if (DEBUG) {
+		printf("Thread %d (id #%lu) created for rows %d to %d.\n\n", 
+			thread_number, pthread_self(), start_row, end_row - 1);
+	}
+
+	if (single != NULL) {
+		single_precision_sweeps(thread_number, start_row, end_row, true, w);
+	}
+
+	initialise_stall(&stall);
+	while (is_above_precision) {
+		// update red cells, then wait for all red cells to be updated
+		if (cube != NULL) {
+			max_diff = volume_colour_sweep(cube, cube->values, start_row, 
+				end_row, 0, 0, w);
+		} else if (as != NULL) {
+			max_diff = relax_active_colour(as, square_array, 
+				thread_number - 1, 0, w);
+		} else if (is_plain_laplacian(&op)) {
+			max_diff = relax_colour(square_array, NULL, dim, start_row, 
+				end_row, 0, w);
+		} else {
+			max_diff = operator_rows_colour(&op, square_array, coefficients, 
+				start_row, end_row, dim, 0, 0, w);
+		}
+		sync_barrier_wait(&barrier);
+
+		// update black cells using the new red values
+		if (cube != NULL) {
+			black_diff = volume_colour_sweep(cube, cube->values, start_row, 
+				end_row, 0, 1, w);
+		} else if (as != NULL) {
+			black_diff = relax_active_colour(as, square_array, 
+				thread_number - 1, 1, w);
+			finish_active_sweep(as, thread_number - 1);
+		} else if (is_plain_laplacian(&op)) {
+			black_diff = relax_colour(square_array, NULL, dim, start_row, 
+				end_row, 1, w);
+		} else {
+			black_diff = operator_rows_colour(&op, square_array, coefficients, 
+				start_row, end_row, dim, 0, 1, w);
+		}
+		if (black_diff > max_diff) {
+			max_diff = black_diff;
+		}
+
+		// wait for all threads to finish the sweep, and check if the 
+		// difference is smaller than precision for all threads
+		max_diff = sync_barrier_reduce(&barrier, thread_number - 1, max_diff, 
+			REDUCE_MAX);
+		is_above_precision = max_diff >= precision && 
+			!has_stalled(&stall, max_diff);
+		iteration++;
+
+		// skipped tiles may be above precision, so check them all once the 
+		// tiles relaxed are within it
+		if (as != NULL && (is_above_precision || 
+			(max_diff < precision && !was_full_sweep(as)))) {
+			is_above_precision = true;
+			update_active_set(as, thread_number - 1, max_diff < precision);
+		}
+
+		// estimate omega from the convergence rate of the last sweeps
+		if (adapting && iteration % OMEGA_ADAPT_SWEEPS == 0) {
+			if (adapt_start_diff > 0.0) {
+				new_w = adapted_omega(adapt_start_diff, max_diff, 
+					OMEGA_ADAPT_SWEEPS, w);
+				adapting = new_w > w + OMEGA_ADAPT_TOLERANCE;
+				if (new_w > w) {
+					w = new_w;
+				}
+			}
+			adapt_start_diff = max_diff;
+		}
+	}
+
+	// all threads stop on the same sweep, so only one records the count
+	if (thread_number == 1) {
+		iteration_count = iteration;
+		omega = w;
+		warn_if_stalled(max_diff, precision);
+	}
+
+	if (DEBUG) printf("Thread %d (id #%lu) exited.\n\n", thread_number, 
+		pthread_self());
+
+	return NULL;
+}
+
+
+/*
+ * Threaded function that relaxes the square array with multigrid cycles, all 
+ * threads running each cycle together (see multigrid.c). A cycle ends with a
+ * red-black sweep of the square array, and threads stop once its largest 
+ * difference is smaller than the precision, reduced the same way as in the 
+ * Jacobi mode.
+ */
+void* multigrid_runner(void* arg) {
+	// retrieve data from arg
+	struct relaxation_data *arg_struct = (struct relaxation_data*) arg;
+	int thread_number = arg_struct->thr_number;
+
+	// local variables
+	bool is_above_precision = true;
+	int iteration = 0;
+	double max_diff;
+	struct stall stall;
+
+	initialise_stall(&stall);
+	while (is_above_precision) {
+		max_diff = sync_barrier_reduce(&barrier, thread_number - 1, 
+			multigrid_cycle(mg, 0, thread_number - 1), REDUCE_MAX);
+		is_above_precision = max_diff >= precision && 
+			!has_stalled(&stall, max_diff);
+		iteration++;
+	}
+
+	// all threads stop on the same cycle, so only one records the count
+	if (thread_number == 1) {
+		iteration_count = iteration;
+		warn_if_stalled(max_diff, precision);
+	}
+
+	return NULL;
+}
+
+
+/*
+ * Threaded function that solves the square array with the conjugate gradient
+ * method, all threads running each iteration together on their own band of 
+ * rows (see conjugate_gradient.c). Threads stop once a Jacobi sweep would 
+ * change no value by more than the precision.
+ */
+void* conjugate_gradient_runner(void* arg) {
+	// retrieve data from arg
+	struct relaxation_data *arg_struct = (struct relaxation_data*) arg;
+	int thread_number = arg_struct->thr_number;
+	int start_row = arg_struct->start_row;
+	int end_row = arg_struct->end_row;
+
+	// local variables
+	int iteration = 0;
+	double residual_product;	// r.z, carried from one iteration to the next
+	double max_change = start_conjugate_gradient(cg, thread_number - 1, 
+		start_row, end_row, &residual_product);
+	struct stall stall;
+
+	// every thread gets the same reduced values, so they stop together
+	initialise_stall(&stall);
+	while (max_change >= precision && !has_stalled(&stall, max_change)) {
+		max_change = conjugate_gradient_iteration(cg, thread_number - 1, 
+			start_row, end_row, &residual_product);
+		iteration++;
+	}
+
+	if (thread_number == 1) {
+		iteration_count = iteration;
+		warn_if_stalled(max_change, precision);
+	}
+
+	return NULL;
+}
+
+
+/*
+ * Threaded function that relaxes a contiguous band of rows of the square array
+ * in place with red-black sweeps, without waiting for the other threads: the 
+ * rows of the neighbouring bands are read whenever they are needed (see 
+ * async_relaxation.c). Each thread stops once one of them detects that a whole
+ * sweep of every band changed no value by more than the precision. The threads
+ * run different numbers of sweeps, which are counted separately.
+ */
+void* async_runner(void* arg) {
+	// retrieve data from arg
+	struct relaxation_data *arg_struct = (struct relaxation_data*) arg;
+	int thread_number = arg_struct->thr_number;
+	int start_row = arg_struct->start_row;
+	int end_row = arg_struct->end_row;
+
+	// local variables
+	bool is_above_precision = true;
+	bool is_quiet;
+	double max_diff = 0.0;
+	struct async_snapshot *snapshot = initialise_async_snapshot(ar);
+	struct stall stall;
+
+	if (DEBUG) {
+		printf("Thread %d (id #%lu) created for rows %d to %d.\n\n", 
+			thread_number, pthread_self(), start_row, end_row - 1);
+	}
+
+	initialise_stall(&stall);
+	while (is_above_precision) {
+		max_diff = async_sweep(ar, start_row, end_row);
+
+		// a band is quiet once relaxed, or while it stays stalled (in single 
+		// precision): a change well above the one it stalled at means that 
+		// its neighbours changed the rows it reads, and it converges again
+		is_quiet = max_diff < precision;
+		if (!is_quiet && has_stalled(&stall, max_diff)) {
+			is_quiet = max_diff <= 2 * stall.smallest_diff;
+		}
+		if (!is_quiet && max_diff > 2 * stall.smallest_diff) {
+			initialise_stall(&stall);
+		}
+		is_above_precision = !finish_async_sweep(ar, thread_number - 1, 
+			is_quiet, snapshot);
+
+		// a relaxed band only changes once its neighbours do, so let threads 
+		// sharing the core run first
+		if (is_quiet) {
+			sched_yield();
+		}
+	}
+	free_async_snapshot(snapshot);
+	thread_max_diff[thread_number - 1] = max_diff;
+
+	if (DEBUG) printf("Thread %d (id #%lu) exited.\n\n", thread_number, 
+		pthread_self());
+
+	return NULL;
+}
+
+
+/*
+ * Threaded function that runs the tasks relaxing the tiles of the square array
+ * with Jacobi sweeps, each tile being relaxed as soon as its neighbours are 
+ * (see task_graph.c), until an iteration of every tile is within precision. 
+ * Threads never wait for each other at a barrier, and take the tasks of 
+ * other threads when they run out of their own.
+ */
+void* dataflow_runner(void* arg) {
+	// retrieve data from arg
+	struct relaxation_data *arg_struct = (struct relaxation_data*) arg;
+	int thread_number = arg_struct->thr_number;
+
+	if (DEBUG) {
+		printf("Thread %d (id #%lu) created for tiles.\n\n", thread_number, 
+			pthread_self());
+	}
+
+	run_task_graph(tg, thread_number - 1);
+
+	if (DEBUG) printf("Thread %d (id #%lu) exited.\n\n", thread_number, 
+		pthread_self());
+
+	return NULL;
+}
+
+
+/*
+ * Parses the command line arguments. The first argument that is not a flag is
+ * the number of threads, so that "./shared_relaxation <number_of_threads>" 
+ * keeps working.
+ */
+void parse_arguments(int argc, char *argv[]) {
+	int arg;
+	num_thr = 0;
+	for (arg = 1; arg < argc; arg++) {
+		// parse relaxation mode
+		if (strcmp(argv[arg], "-m") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (strcmp(argv[arg], "mutex") == 0) {
+					mode = MODE_MUTEX;
+				} else if (strcmp(argv[arg], "jacobi") == 0) {
+					mode = MODE_JACOBI;
+				} else if (strcmp(argv[arg], "redblack") == 0) {
+					mode = MODE_RED_BLACK;
+				} else if (strcmp(argv[arg], "sor") == 0) {
+					mode = MODE_SOR;
+				} else if (strcmp(argv[arg], "multigrid") == 0) {
+					mode = MODE_MULTIGRID;
+				} else if (strcmp(argv[arg], "cg") == 0) {
+					mode = MODE_CONJUGATE_GRADIENT;
+				} else if (strcmp(argv[arg], "async") == 0) {
+					mode = MODE_ASYNC;
+				} else if (strcmp(argv[arg], "dataflow") == 0) {
+					mode = MODE_DATAFLOW;
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -m. Must be "
+						"mutex, jacobi, redblack, sor, multigrid, cg, async or "
+						"dataflow. Using jacobi as default value.\n");
+					mode = MODE_JACOBI;
+				}
+			}
+		}
+		// parse SOR relaxation factor
+		else if (strcmp(argv[arg], "-w") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (strcmp(argv[arg], "auto") == 0) {
+					omega_choice = OMEGA_AUTO;
+				} else if (strcmp(argv[arg], "adapt") == 0) {
+					omega_choice = OMEGA_ADAPT;
+				} else if (atof(argv[arg]) > 0.0 && atof(argv[arg]) < 2.0) {
+					omega_choice = OMEGA_FIXED;
+					omega = atof(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -w. Must be "
+						"auto, adapt or a float between 0 and 2. Using auto as "
+						"default value.\n");
+					omega_choice = OMEGA_AUTO;
+				}
+			}
+		}
+		// parse multigrid cycle type
+		else if (strcmp(argv[arg], "-cycle") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (strcmp(argv[arg], "v") == 0) {
+					cycle_index = 1;
+				} else if (strcmp(argv[arg], "w") == 0) {
+					cycle_index = 2;
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -cycle. Must "
+						"be v or w. Using v as default value.\n");
+					cycle_index = 1;
+				}
+			}
+		}
+		// parse number of multigrid levels
+		else if (strcmp(argv[arg], "-levels") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atoi(argv[arg + 1]) >= 0) {
+					arg++;
+					max_levels = atoi(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -levels. Must "
+						"be a positive integer (0 for as many as possible). "
+						"Using levels = %d as default value.\n", max_levels);
+				}
+			}
+		}
+		// parse number of jacobi sweeps per wavefront
+		else if (strcmp(argv[arg], "-block") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atoi(argv[arg + 1]) > 0) {
+					arg++;
+					block_sweeps = atoi(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -block. Must "
+						"be a positive integer. Using block = %d as default "
+						"value.\n", block_sweeps);
+				}
+			}
+		}
+		// parse size of the dataflow tiles
+		else if (strcmp(argv[arg], "-tile") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atoi(argv[arg + 1]) > 0) {
+					arg++;
+					tile_size = atoi(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -tile. Must "
+						"be a positive integer. Using tile = %d as default "
+						"value.\n", tile_size);
+				}
+			}
+		}
+		// parse number of quiet sweeps before a tile is skipped
+		else if (strcmp(argv[arg], "-active") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atoi(argv[arg + 1]) > 0) {
+					arg++;
+					active_sweeps = atoi(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -active. "
+						"Must be a positive integer. Relaxing every tile as "
+						"default value.\n");
+				}
+			}
+		}
+		// parse thread pinning
+		else if (strcmp(argv[arg], "-affinity") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (strcmp(argv[arg], "none") == 0) {
+					affinity = AFFINITY_NONE;
+				} else if (strcmp(argv[arg], "compact") == 0) {
+					affinity = AFFINITY_COMPACT;
+				} else if (strcmp(argv[arg], "scatter") == 0) {
+					affinity = AFFINITY_SCATTER;
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -affinity. "
+						"Must be none, compact or scatter. Using none as "
+						"default value.\n");
+					affinity = AFFINITY_NONE;
+				}
+			}
+		}
+		// parse points of the Laplacian
+		else if (strcmp(argv[arg], "-stencil") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (atoi(argv[arg]) == 5 || atoi(argv[arg]) == 9) {
+					stencil_points = atoi(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -stencil. "
+						"Must be 5 or 9. Using 5 as default value.\n");
+				}
+			}
+		}
+		// parse coefficient of the inclusion
+		else if (strcmp(argv[arg], "-coef") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atof(argv[arg + 1]) > 0.0) {
+					arg++;
+					contrast = atof(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -coef. Must "
+						"be a positive float. Using uniform coefficients as "
+						"default value.\n");
+				}
+			}
+		}
+		// parse source term
+		else if (strcmp(argv[arg], "-source") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				source = atof(argv[arg]);
+			}
+		}
+		// parse precision of the single precision sweeps
+		else if (strcmp(argv[arg], "-mixed") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atof(argv[arg + 1]) > 0.0) {
+					arg++;
+					mixed_precision = atof(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -mixed. "
+						"Must be a positive float. Using double precision "
+						"sweeps only as default value.\n");
+				}
+			}
+		}
+		// parse grid file holding the initial values of the array
+		else if (strcmp(argv[arg], "-input") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				input_file = argv[arg];
+			}
+		}
+		// parse grid file the relaxed array is written to
+		else if (strcmp(argv[arg], "-output") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				output_file = argv[arg];
+			}
+		}
+		// parse shape of the array relaxed
+		else if (strcmp(argv[arg], "-shape") == 0) {
+			if (arg + 1 <= argc - 1) {
+				arg++;
+				if (strcmp(argv[arg], "square") == 0) {
+					is_cube = false;
+				} else if (strcmp(argv[arg], "cube") == 0) {
+					is_cube = true;
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -shape. Must "
+						"be square or cube. Using square as default value.\n");
+					is_cube = false;
+				}
+			}
+		}
+		// parse square array dimension
+		else if (strcmp(argv[arg], "-d") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atoi(argv[arg + 1]) > 2) {
+					arg++;
+					dim = atoi(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -d. Must be "
+						"an integer greater than 2. Using dimension = %d as "
+						"default value.\n", dim);
+				}
+			}
+		}
+		// parse precision
+		else if (strcmp(argv[arg], "-p") == 0) {
+			if (arg + 1 <= argc - 1) {
+				if (atof(argv[arg + 1]) > 0.0) {
+					arg++;
+					precision = atof(argv[arg]);
+				} else {
+					fprintf(stderr, "WARNING: Invalid argument for -p. Must be "
+						"a positive float. Using precision = %f as default "
+						"value.\n", precision);
+				}
+			}
+		}
+		// parse number of threads
+		else if (num_thr == 0 && atoi(argv[arg]) > 0) {
+			num_thr = atoi(argv[arg]);
+		} else {
+			printf("Invalid argument provided: %s\n", argv[arg]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (num_thr == 0) {
+		printf("One argument expected. Number of threads set to 10.\n\n");
+		num_thr = 10;
+	}
+
+	// the dimension of an array read from a grid file is the one of the file
+	if (is_cube && (input_file != NULL || output_file != NULL)) {
+		fprintf(stderr, "WARNING: -shape cube doesn't support -input and "
+			"-output. Using random values as default value.\n");
+		input_file = NULL;
+		output_file = NULL;
+	}
+	if (input_file != NULL) {
+		dim = read_grid_dimension(input_file);
+	}
+
+	// equations other than the Laplace equation are relaxed by the sweeps of 
+	// the jacobi, redblack and sor modes only, and the 9-point stencil by 
+	// jacobi sweeps only, as the corners of a cell are of its own colour
+	initialise_stencil_operator(&op, stencil_points, contrast, source, dim);
+	if (!is_plain_laplacian(&op) && mode != MODE_JACOBI && 
+		mode != MODE_RED_BLACK && mode != MODE_SOR) {
+		fprintf(stderr, "WARNING: -stencil 9, -coef and -source only support "
+			"the jacobi, redblack and sor modes. Using jacobi as default "
+			"value.\n");
+		mode = MODE_JACOBI;
+	} else if (op.points == 9 && mode != MODE_JACOBI) {
+		fprintf(stderr, "WARNING: -stencil 9 only supports the jacobi mode. "
+			"Using jacobi as default value.\n");
+		mode = MODE_JACOBI;
+	}
+	if (!is_plain_laplacian(&op) && (block_sweeps > 1 || active_sweeps > 0)) {
+		fprintf(stderr, "WARNING: -stencil 9, -coef and -source don't support "
+			"-block and -active. Using their default values.\n");
+		block_sweeps = 1;
+		active_sweeps = 0;
+	}
+
+	// cubes are relaxed by the 7-point sweeps of the jacobi, redblack and sor 
+	// modes (see common/volume_sweep.c), which tile the planes themselves
+	if (is_cube && mode != MODE_JACOBI && mode != MODE_RED_BLACK && 
+		mode != MODE_SOR) {
+		fprintf(stderr, "WARNING: -shape cube only supports the jacobi, "
+			"redblack and sor modes. Using jacobi as default value.\n");
+		mode = MODE_JACOBI;
+	}
+	if (is_cube && (!is_plain_laplacian(&op) || block_sweeps > 1 || 
+		active_sweeps > 0)) {
+		fprintf(stderr, "WARNING: -shape cube doesn't support -stencil 9, "
+			"-coef, -source, -block and -active. Using their default "
+			"values.\n");
+		initialise_stencil_operator(&op, 5, 1.0, 0.0, dim);
+		block_sweeps = 1;
+		active_sweeps = 0;
+	}
+
+	if (active_sweeps > 0 && mode != MODE_RED_BLACK && mode != MODE_SOR) {
+		fprintf(stderr, "WARNING: -active only supports the redblack and sor "
+			"modes. Relaxing every tile as default value.\n");
+		active_sweeps = 0;
+	}
+
+	// the mixed precision mode relaxes a single precision copy of the square 
+	// array with the plain sweeps of the jacobi, redblack and sor modes
+	if (mixed_precision > 0.0 && (sizeof(real) != sizeof(double) || is_cube ||
+		!is_plain_laplacian(&op) || (mode != MODE_JACOBI && 
+		mode != MODE_RED_BLACK && mode != MODE_SOR))) {
+		fprintf(stderr, "WARNING: -mixed only supports the jacobi, redblack "
+			"and sor modes relaxing the Laplace equation on a square array, in "
+			"double precision builds. Using %s precision sweeps only.\n", 
+			REAL_NAME);
+		mixed_precision = 0.0;
+	}
+
+	// only the SOR mode over-relaxes values
+	if (mode != MODE_SOR) {
+		omega_choice = OMEGA_FIXED;
+		omega = 1.0;
+	} else if (omega_choice == OMEGA_AUTO) {
+		omega = optimal_omega(dim);
+	}
 }
 
 
@@ -127,59 +1033,235 @@ void* relaxation_runner(void* arg) {
  * Program entry.
  */
 int main(int argc, char *argv[]) {
-	// initialise values
-	square_array = initialise_square_array(dim);
-	mutex_array = initialise_mutex_array(dim);
-
-	// retrieve number of threads from command line argument
-	if (argc == 2) {
-		num_thr = atoi(argv[1]);
-	} else if (argc > 2) {
-		printf("Too many arguments provided.\n");
-		exit(EXIT_FAILURE);
+	// retrieve number of threads and parameters from command line arguments
+	parse_arguments(argc, argv);
+	initialise_stencil_kernel();
+
+	// create the threads once, then initialise values, the rows being first 
+	// written by the threads relaxing them
+	thread_cpus = initialise_affinity_map(affinity, num_thr);
+	pool = initialise_worker_pool(num_thr, thread_cpus);
+	grid = NULL;
+	cube = NULL;
+	square_array = NULL;
+	new_square_array = NULL;
+	if (is_cube) {
+		cube = initialise_cube(dim, mode == MODE_JACOBI ? 2 : 1, pool);
 	} else {
-		printf("One argument expected. Number of threads set to 10.\n\n");
-		num_thr = 10;
+		grid = initialise_square_array(dim, 
+			mode == MODE_JACOBI || mode == MODE_DATAFLOW ? 2 : 1, pool);
+		square_array = grid->rows;
+		new_square_array = grid->next_rows;
+	}
+	if (input_file != NULL) {
+		read_grid_file(input_file, square_array, dim);
+		if (new_square_array != NULL) {
+			copy_grid_buffer(grid);
+		}
+	}
+	single = NULL;
+	if (mixed_precision > 0.0) {
+		// its rows are first written by the threads relaxing them
+		single = allocate_single_grid(dim, dim, mode == MODE_JACOBI ? 2 : 1);
+	}
+	coefficient_grid = NULL;
+	coefficients = NULL;
+	if (op.coefficients) {
+		coefficient_grid = allocate_grid(dim, dim, 0, 1);
+		initialise_coefficients(&op, coefficient_grid->values, 
+			coefficient_grid->pitch, 0, 0, dim, dim);
+		coefficients = coefficient_grid->rows;
+	}
+	if (mode == MODE_MUTEX) {
+		mutex_array = initialise_mutex_array(dim);
+	} else {
+		thread_max_diff = initialise_diff_array(num_thr);
+		initialise_sync_barrier(&barrier, num_thr);
+		if (mode == MODE_MULTIGRID) {
+			mg = initialise_multigrid(square_array, dim, max_levels, 
+				cycle_index, precision, num_thr, &barrier);
+		} else if (mode == MODE_CONJUGATE_GRADIENT) {
+			cg = initialise_conjugate_gradient(square_array, dim, num_thr, 
+				&barrier);
+		} else if (mode == MODE_ASYNC) {
+			ar = initialise_async_relaxation(square_array, dim, num_thr);
+		} else if (mode == MODE_DATAFLOW) {
+			tg = initialise_task_graph(square_array, new_square_array, dim, 
+				tile_size, precision, num_thr);
+		} else if (active_sweeps > 0) {
+			as = initialise_active_set(dim, tile_size, active_sweeps, 
+				precision, num_thr);
+		}
 	}
 
-	if (DEBUG) print_parameters(dim, num_thr, precision, square_array);
+	if (DEBUG && !is_cube) {
+		print_parameters(dim, num_thr, precision, square_array);
+	}
 	
 	// start recording time
 	gettimeofday(&time1, NULL);
 
-	// initialise and create threads to perform relaxation in parallel
-	pthread_t tids[num_thr];				// array of thread IDs
+	// hand the relaxation out to the threads of the pool, and wait until 
+	// they finish running
 	struct relaxation_data args[num_thr];	// array of structs for thread input
+	void* (*runner)(void*);					// function run by every thread
 	int i;
 	for (i = 0; i < num_thr; i++) {
 		args[i].thr_number = i + 1;	// 1-based thread numbers
-		pthread_attr_t attr;
-		pthread_attr_init(&attr);
-		pthread_create(&tids[i], &attr, relaxation_runner, &args[i]);
+		band_of_rows(dim, i, num_thr, &args[i].start_row, &args[i].end_row);
 	}
-
-	// wait until threads finish running
-	for (i = 0; i < num_thr; i++) {
-		pthread_join(tids[i], NULL);
+	if (mode == MODE_MUTEX) {
+		runner = relaxation_runner;
+	} else if (mode == MODE_JACOBI) {
+		runner = jacobi_runner;
+	} else if (mode == MODE_MULTIGRID) {
+		runner = multigrid_runner;
+	} else if (mode == MODE_CONJUGATE_GRADIENT) {
+		runner = conjugate_gradient_runner;
+	} else if (mode == MODE_ASYNC) {
+		runner = async_runner;
+	} else if (mode == MODE_DATAFLOW) {
+		runner = dataflow_runner;
+	} else {
+		// both the red-black and SOR modes use red-black sweeps
+		runner = red_black_runner;
 	}
+	run_worker_pool(pool, runner, args, sizeof(struct relaxation_data));
 
 	// stop recording time
 	gettimeofday(&time2, NULL);
 
+	// the dataflow mode stops at the first iteration within precision, whose 
+	// values are kept while later iterations are relaxed
+	if (mode == MODE_DATAFLOW) {
+		iteration_count = tg->converged;
+		warn_if_stalled(tg->max_diff, precision);
+	}
+
+	// after an odd number of blocks of sweeps, the final values are in the 
+	// second buffer
+	if ((mode == MODE_JACOBI && iteration_count / block_sweeps % 2 == 1) || 
+		(mode == MODE_DATAFLOW && iteration_count % 2 == 1)) {
+		real **temp_array = square_array;
+		square_array = new_square_array;
+		new_square_array = temp_array;
+		if (cube != NULL) {
+			swap_volume_buffers(cube);
+		}
+	}
+
+	// the sweeps of the mixed precision mode relaxed the first buffer
+	if (single != NULL) {
+		iteration_count += single_iteration_count;
+	}
+
+	// threads of the async mode ran different numbers of sweeps, the largest 
+	// one being reported
+	if (mode == MODE_ASYNC) {
+		iteration_count = (int) ar->sweeps[0];
+		for (i = 1; i < num_thr; i++) {
+			if (ar->sweeps[i] > iteration_count) {
+				iteration_count = (int) ar->sweeps[i];
+			}
+			if (thread_max_diff[i] > thread_max_diff[0]) {
+				thread_max_diff[0] = thread_max_diff[i];
+			}
+		}
+		warn_if_stalled(thread_max_diff[0], precision);
+	}
+
 	// print final results
-	print_final_results(dim, num_thr, precision);
+	print_final_results(dim, num_thr, precision, mode_names[mode], 
+		mode == MODE_MUTEX ? 0 : iteration_count);
+	if (mode != MODE_MUTEX && mode != MODE_CONJUGATE_GRADIENT && !is_cube) {
+		printf("Stencil kernel: %s\n", stencil_kernel_name());
+	}
+	if (!is_plain_laplacian(&op)) {
+		printf("Stencil: %s\n", op.name);
+	}
+	if (cube != NULL) {
+		printf("Shape: cube of %d x %d x %d values, 7-point sweeps by tiles "
+			"of %d rows\n", dim, dim, dim, volume_tile_rows(cube, 
+			mode == MODE_JACOBI ? 4 : 3));
+	}
+	if (thread_cpus != NULL) {
+		printf("Affinity: %s\n", affinity_names[affinity]);
+	}
+	if (single != NULL) {
+		printf("Mixed precision: %d single precision sweeps to %f\n", 
+			single_iteration_count, mixed_precision);
+	}
+	if (mode == MODE_JACOBI && block_sweeps > 1) {
+		printf("Wavefront: %d sweeps per block\n", block_sweeps);
+	} else if (mode == MODE_SOR) {
+		printf("Relaxation factor (omega): %f\n", omega);
+	} else if (mode == MODE_MULTIGRID) {
+		printf("Multigrid: %c-cycles over %d levels\n", 
+			cycle_index == 1 ? 'V' : 'W', mg->num_levels);
+	} else if (mode == MODE_ASYNC) {
+		printf("Asynchronous sweeps per thread:");
+		for (i = 0; i < num_thr; i++) {
+			printf(" %ld", ar->sweeps[i]);
+		}
+		printf("\n");
+	} else if (mode == MODE_DATAFLOW) {
+		printf("Dataflow: %d tiles of %d x %d values\n", tg->num_tiles, 
+			tile_size, tile_size);
+	}
+	if (as != NULL) {
+		long relaxed_tiles = 0;
+		for (i = 0; i < num_thr; i++) {
+			relaxed_tiles += as->relaxed_tiles[i];
+		}
+		printf("Active set: %d tiles of %d x %d values, %.1f%% of tile sweeps "
+			"skipped\n", as->num_tiles, tile_size, tile_size, 100.0 * 
+			(1.0 - (double) relaxed_tiles / ((double) as->num_tiles * 
+			iteration_count)));
+	}
 	printf ("Total time = %f seconds\n", 
 		(double) (time2.tv_usec - time1.tv_usec) / 1000000 +
 		(double) (time2.tv_sec - time1.tv_sec));
 	
+	if (output_file != NULL) {
+		write_grid_file(output_file, square_array, dim);
+	}
+
 	// print final array
-	if (DEBUG) {
+	if (DEBUG && !is_cube) {
 		printf("\nFinal square array\n");
 		print_array(dim, square_array);
 	}
 
 	// free allocated array space and successfully exit program
- 	free(square_array);	
-	free(mutex_array);
+	if (cube != NULL) {
+		free_volume(cube);
+	} else {
+		free_grid(grid);
+	}
+	if (coefficient_grid != NULL) {
+		free_grid(coefficient_grid);
+	}
+	if (single != NULL) {
+		free_single_grid(single);
+	}
+	free_worker_pool(pool);
+	free(thread_cpus);
+	if (mode == MODE_MUTEX) {
+		free(mutex_array);
+	} else {
+		if (mode == MODE_MULTIGRID) {
+			free_multigrid(mg);
+		} else if (mode == MODE_CONJUGATE_GRADIENT) {
+			free_conjugate_gradient(cg);
+		} else if (mode == MODE_ASYNC) {
+			free_async_relaxation(ar);
+		} else if (mode == MODE_DATAFLOW) {
+			free_task_graph(tg);
+		} else if (as != NULL) {
+			free_active_set(as);
+		}
+		free(thread_max_diff);
+		destroy_sync_barrier(&barrier);
+	}
    	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,264 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ * 
+ * Source file for the geometric multigrid solver, run by all threads at once.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <pthread.h>
+#include "real.h"
+#include "grid.h"
+#include "sync_barrier.h"
+#include "worker_pool.h"
+#include "array_helpers.h"
+#include "relaxation_helpers.h"
+#include "coarsening.h"
+#include "multigrid.h"
+
+#define PRE_SMOOTHING_SWEEPS 2		// sweeps before visiting the coarser level
+#define POST_SMOOTHING_SWEEPS 2		// sweeps after visiting the coarser level
+#define COARSEST_PRECISION 0.01		// fraction of precision coarsest level is
+									// relaxed to
+#define MAX_COARSEST_SWEEPS 10000	// sweeps after which the coarsest level 
+									// relaxation gives up
+
+
+/*
+ * Initialises the levels of the multigrid solver. The finest level relaxes the
+ * square array itself, coarser levels have their own arrays of corrections, 
+ * right hand sides and residuals. Levels are added until the coarsest level 
+ * has a single value to relax, or until there are max_levels levels (0 for no
+ * limit).
+ */
+struct multigrid* initialise_multigrid(real** square_array, int dim, 
+	int max_levels, int cycle_index, double precision, int num_thr, 
+	struct sync_barrier* barrier) {
+	struct multigrid *mg;
+	int num_levels = 1;
+	int level_dim = dim;
+	int l;
+
+	// count the levels
+	while (level_dim > 3 && (max_levels == 0 || num_levels < max_levels)) {
+		level_dim = coarse_dimension(level_dim);
+		num_levels++;
+	}
+
+	mg = malloc(sizeof(struct multigrid));
+	mg->levels = malloc((long unsigned int) num_levels * 
+		sizeof(struct multigrid_level));
+	if (mg == NULL || mg->levels == NULL) {
+		fprintf(stderr, "Failed to allocate space for the multigrid levels.\n");
+		exit(EXIT_FAILURE);
+	}
+	mg->num_levels = num_levels;
+	mg->cycle_index = cycle_index;
+	mg->precision = precision;
+	mg->num_thr = num_thr;
+	mg->barrier = barrier;
+
+	// allocate the arrays of every level
+	level_dim = dim;
+	for (l = 0; l < num_levels; l++) {
+		mg->levels[l].dim = level_dim;
+		if (l == 0) {
+			mg->levels[l].grid = NULL;
+			mg->levels[l].values = square_array;
+			mg->levels[l].rhs = NULL;
+		} else {
+			// the right hand side is the second buffer of the level's grid
+			mg->levels[l].grid = initialise_zero_grid(level_dim, 2);
+			mg->levels[l].values = mg->levels[l].grid->rows;
+			mg->levels[l].rhs = mg->levels[l].grid->next_rows;
+		}
+		mg->levels[l].residual_grid = l < num_levels - 1 ? 
+			initialise_zero_grid(level_dim, 1) : NULL;
+		mg->levels[l].residuals = mg->levels[l].residual_grid != NULL ? 
+			mg->levels[l].residual_grid->rows : NULL;
+		mg->levels[l].coarsening = l < num_levels - 1 ? 
+			initialise_coarsening(level_dim) : NULL;
+		level_dim = coarse_dimension(level_dim);
+	}
+
+	return mg;
+}
+
+
+/*
+ * Relaxes the thread's band of rows of a level with red-black sweeps, meeting
+ * the other threads at a barrier after every colour.
+ * Returns the largest difference between an old and a new value.
+ */
+double smooth(struct multigrid* mg, int level, int thread_index, int sweeps, 
+	double w) {
+	struct multigrid_level *lvl = &mg->levels[level];
+	double max_diff = 0.0;
+	double diff;
+	int start_row, end_row, s, colour;
+
+	band_of_rows(lvl->dim, thread_index, mg->num_thr, &start_row, &end_row);
+	for (s = 0; s < sweeps; s++) {
+		for (colour = 0; colour < 2; colour++) {
+			diff = relax_colour(lvl->values, lvl->rhs, lvl->dim, start_row, 
+				end_row, colour, w);
+			if (diff > max_diff) {
+				max_diff = diff;
+			}
+			sync_barrier_wait(mg->barrier);
+		}
+	}
+	return max_diff;
+}
+
+
+/*
+ * Relaxes the coarsest level until its values change by less than a fraction
+ * of the precision, using red-black SOR with the optimal relaxation factor. 
+ * Threads agree on when to stop the same way as the red-black mode, reducing 
+ * their largest differences at a barrier.
+ */
+void relax_coarsest(struct multigrid* mg, int level, int thread_index) {
+	double max_diff;
+	double w = optimal_omega(mg->levels[level].dim);
+	bool is_above_precision = true;
+	int iteration = 0;
+
+	while (is_above_precision && iteration < MAX_COARSEST_SWEEPS) {
+		max_diff = sync_barrier_reduce(mg->barrier, thread_index, 
+			smooth(mg, level, thread_index, 1, w), REDUCE_MAX);
+		is_above_precision = max_diff >= mg->precision * COARSEST_PRECISION;
+		iteration++;
+	}
+}
+
+
+/*
+ * Computes the residuals of the thread's band of rows of a level, then 
+ * restricts them to the coarser level's right hand side, and resets the 
+ * coarser level's corrections to 0.
+ * The right hand side is the weighted sum of the residuals rather than their 
+ * average, as the coarser level's cells are about twice as far apart.
+ */
+void restrict_residuals(struct multigrid* mg, int level, int thread_index) {
+	struct multigrid_level *fine = &mg->levels[level];
+	struct multigrid_level *coarse = &mg->levels[level + 1];
+	real **u = fine->values;
+	real **r = fine->residuals;
+	struct coarsening *m = fine->coarsening;
+	int start_row, end_row, i, j, fi, fj;
+	double sum;
+
+	// residuals of the fine level
+	band_of_rows(fine->dim, thread_index, mg->num_thr, &start_row, &end_row);
+	for (i = start_row; i < end_row; i++) {
+		for (j = 1; j < fine->dim - 1; j++) {
+			r[i][j] = 4 * u[i][j] - 
+				(u[i][j-1] + u[i][j+1] + u[i-1][j] + u[i+1][j]);
+			if (fine->rhs != NULL) {
+				r[i][j] = fine->rhs[i][j] - r[i][j];
+			} else {
+				r[i][j] = -r[i][j];
+			}
+		}
+	}
+	sync_barrier_wait(mg->barrier);
+
+	// restriction to the coarse level, full weighting when n - 1 is even
+	band_of_rows(coarse->dim, thread_index, mg->num_thr, &start_row, &end_row);
+	for (i = start_row; i < end_row; i++) {
+		for (j = 1; j < coarse->dim - 1; j++) {
+			sum = 0.0;
+			for (fi = m->first[i]; fi <= m->last[i]; fi++) {
+				for (fj = m->first[j]; fj <= m->last[j]; fj++) {
+					sum += restriction_weight(m, fi, i) * 
+						restriction_weight(m, fj, j) * r[fi][fj];
+				}
+			}
+			coarse->rhs[i][j] = (real)sum;
+			coarse->values[i][j] = 0.0;
+		}
+	}
+	sync_barrier_wait(mg->barrier);
+}
+
+
+/*
+ * Interpolates the coarser level's corrections bilinearly and adds them to the
+ * thread's band of rows of a level.
+ */
+void prolongate_corrections(struct multigrid* mg, int level, 
+	int thread_index) {
+	struct multigrid_level *fine = &mg->levels[level];
+	real **c = mg->levels[level + 1].values;
+	struct coarsening *m = fine->coarsening;
+	int start_row, end_row, i, j, ci, cj;
+	double wi, wj;
+
+	band_of_rows(fine->dim, thread_index, mg->num_thr, &start_row, &end_row);
+	for (i = start_row; i < end_row; i++) {
+		ci = m->cell[i];
+		wi = m->weight[i];
+		for (j = 1; j < fine->dim - 1; j++) {
+			cj = m->cell[j];
+			wj = m->weight[j];
+			fine->values[i][j] += (real)((1 - wi) * 
+				((1 - wj) * c[ci][cj] + wj * c[ci][cj+1]) + 
+				wi * ((1 - wj) * c[ci+1][cj] + wj * c[ci+1][cj+1]));
+		}
+	}
+	sync_barrier_wait(mg->barrier);
+}
+
+
+/*
+ * Runs one multigrid cycle from the given level: smooths, restricts the 
+ * residuals, runs cycle_index cycles on the coarser level (1: V-cycle, 
+ * 2: W-cycle), adds the interpolated corrections and smooths again. The 
+ * coarsest level is relaxed until it has converged instead.
+ * Must be called by all threads at once.
+ * Returns the largest difference between an old and a new value of the 
+ * thread's rows during the last sweep.
+ */
+double multigrid_cycle(struct multigrid* mg, int level, int thread_index) {
+	int c;
+
+	if (level == mg->num_levels - 1) {
+		relax_coarsest(mg, level, thread_index);
+		return 0.0;
+	}
+
+	smooth(mg, level, thread_index, PRE_SMOOTHING_SWEEPS, 1.0);
+	restrict_residuals(mg, level, thread_index);
+	for (c = 0; c < mg->cycle_index; c++) {
+		multigrid_cycle(mg, level + 1, thread_index);
+	}
+	prolongate_corrections(mg, level, thread_index);
+	smooth(mg, level, thread_index, POST_SMOOTHING_SWEEPS - 1, 1.0);
+	return smooth(mg, level, thread_index, 1, 1.0);
+}
+
+
+/*
+ * Frees the arrays of the coarse levels (the finest level's values are the 
+ * square array, which is freed separately).
+ */
+void free_multigrid(struct multigrid* mg) {
+	int l;
+	for (l = 0; l < mg->num_levels; l++) {
+		if (mg->levels[l].grid != NULL) {
+			free_grid(mg->levels[l].grid);
+		}
+		if (mg->levels[l].residual_grid != NULL) {
+			free_grid(mg->levels[l].residual_grid);
+		}
+		if (mg->levels[l].coarsening != NULL) {
+			free_coarsening(mg->levels[l].coarsening);
+		}
+	}
+	free(mg->levels);
+	free(mg);
+}
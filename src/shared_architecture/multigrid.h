@@ -0,0 +1,44 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ * 
+ * Header file for the geometric multigrid solver, run by all threads at once.
+ */
+
+struct multigrid_level {		// struct representing one level of the grid
+	int dim;					// square array dimensions on this level
+	real **values;				// values (finest level) or corrections
+	real **rhs;					// right hand side (NULL on the finest level)
+	real **residuals;			// residuals restricted to the coarser level
+	struct grid *grid;			// grid of the values and right hand side 
+								// (NULL on the finest level)
+	struct grid *residual_grid;	// grid of the residuals (NULL if none)
+	struct coarsening *coarsening;	// mapping to the coarser level (NULL if 
+								// none)
+};
+
+struct multigrid {				// struct shared by the threads running cycles
+	int num_levels;				// number of levels, finest level is level 0
+	int cycle_index;			// coarser level visits per cycle (1: V, 2: W)
+	double precision;			// precision the finest level is relaxed to
+	int num_thr;				// number of threads running the cycles
+	struct sync_barrier *barrier;	// barrier threads meet at between steps
+	struct multigrid_level *levels;
+};
+
+
+struct multigrid* initialise_multigrid(real** square_array, 
+									   int dim, 
+									   int max_levels, 
+									   int cycle_index, 
+									   double precision, 
+									   int num_thr, 
+									   struct sync_barrier* barrier);
+
+
+double multigrid_cycle(struct multigrid* mg, 
+					   int level, 
+					   int thread_index);
+
+
+void free_multigrid(struct multigrid* mg);
@@ -9,6 +9,7 @@
  */
  
 #include <stdio.h>
+#include "real.h"
 #include "print_helpers.h"
 
 
@@ -16,7 +17,7 @@
  * Prints the initial data values used to initiate the program.
  */
 void print_parameters(int dimension, int num_thr, double precision, 
-	double** square_array) {
+	real** square_array) {
 	printf("\nArray dimension: %d\n", dimension);
 	printf("Number of threads: %d\n", num_thr);
 	printf("Precision: %f\n", precision);
@@ -29,7 +30,7 @@ void print_parameters(int dimension, int num_thr, double precision,
 /*
  * Prints an array to the command line.
  */
-void print_array(int dimension, double** square_array) {
+void print_array(int dimension, real** square_array) {
 	int i, j;
 	for (i = 0; i < dimension; i++) {
  		for (j = 0; j < dimension; j++) {
@@ -64,9 +65,16 @@ void print_relaxation_values_data(double old, double l, double r, double u,
 
 /*
  * Prints the parameters used at the end of the script for logging purposes.
+ * The number of iterations is only printed by modes that sweep the array in 
+ * lockstep (0 otherwise).
  */
-void print_final_results(int dimension, int num_thr, double precision) {
+void print_final_results(int dimension, int num_thr, double precision, 
+	const char* mode_name, int iterations) {
 	printf("Threads used: %d\n", num_thr);
 	printf("Array dimension: %d\n", dimension);
-	printf("Precision used: %f\n", precision);
+	printf("Precision used: %f (%s precision values)\n", precision, REAL_NAME);
+	printf("Relaxation mode: %s\n", mode_name);
+	if (iterations > 0) {
+		printf("Iterations: %d\n", iterations);
+	}
 }
\ No newline at end of file
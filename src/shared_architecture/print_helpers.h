@@ -12,11 +12,11 @@
 void print_parameters(int dimension, 
 					  int num_thr, 
 					  double precision, 
-					  double** square_array);
+					  real** square_array);
 
 
 void print_array(int dimension, 
-				 double** square_array);
+				 real** square_array);
 
 
 void print_relaxation_thread_data(int tid, 
@@ -36,4 +36,6 @@ void print_relaxation_values_data(double old,
 
 void print_final_results(int dimension, 
 						 int num_thr, 
-						 double precision);
+						 double precision,
+						 const char* mode_name,
+						 int iterations);
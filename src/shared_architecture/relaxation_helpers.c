@@ -0,0 +1,69 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ * 
+ * Source file for functions used by threads to relax parts of a square array.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "real.h"
+#include "relaxation_helpers.h"
+#include "stencil_kernel.h"
+
+
+/*
+ * Finds the band of rows a thread (0-based) relaxes in a square array of the 
+ * given dimension: the rows that are not boundaries are split into contiguous
+ * bands, and the first threads get one extra row each if the rows can't be 
+ * split evenly. The band goes from start_row to end_row (excluded).
+ */
+void band_of_rows(int dimension, int thread_index, int num_thr, 
+	int* start_row, int* end_row) {
+	int height = (dimension - 2) / num_thr;
+	int extra_rows = (dimension - 2) % num_thr;
+	*start_row = 1 + thread_index * height + 
+		(thread_index < extra_rows ? thread_index : extra_rows);
+	*end_row = *start_row + height + (thread_index < extra_rows ? 1 : 0);
+}
+
+
+/*
+ * Relaxes the values of the rows start_row to end_row (excluded) that have the
+ * given colour in place. Cells are coloured like a chess board: red cells 
+ * (colour 0) have an even row + column index and black cells (colour 1) an odd
+ * one. All 4 neighbours of a cell are of the other colour, so threads can 
+ * update all cells of one colour concurrently.
+ * Values move from their old value towards the average of their neighbours by
+ * the relaxation factor w (1 replaces them with the average). If rhs_array is
+ * not NULL, its values are added to the neighbours before averaging, which 
+ * relaxes the Poisson equation solved by the coarse levels of multigrid.
+ * Each row is relaxed by the stencil kernel (see stencil_kernel.c).
+ * Returns the largest difference between an old and a new value.
+ */
+double relax_colour(real** sq_array, real** rhs_array, int dimension, 
+	int start_row, int end_row, int colour, double w) {
+	double max_diff = 0.0;
+	double difference;
+	int i;
+	for (i = start_row; i < end_row; i++) {
+		// first column with the right colour in this row
+		difference = stencil_row_colour(sq_array[i-1], sq_array[i], 
+			sq_array[i+1], rhs_array != NULL ? rhs_array[i] : NULL, dimension, 
+			1 + (i + 1 + colour) % 2, w);
+		if (difference > max_diff) {
+			max_diff = difference;
+		}
+	}
+	return max_diff;
+}
+
+
+/*
+ * Returns the theoretically optimal relaxation factor for relaxing a square
+ * array of the given dimension with fixed boundaries: 2 / (1 + sin(pi / n)),
+ * where n is the number of intervals between the boundaries.
+ */
+double optimal_omega(int dimension) {
+	return 2.0 / (1.0 + sin(M_PI / (double)(dimension - 1)));
+}
@@ -0,0 +1,25 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ * 
+ * Header file for functions used by threads to relax parts of a square array.
+ */
+
+
+void band_of_rows(int dimension, 
+				  int thread_index, 
+				  int num_thr, 
+				  int* start_row, 
+				  int* end_row);
+
+
+double relax_colour(real** sq_array, 
+					real** rhs_array, 
+					int dimension, 
+					int start_row, 
+					int end_row, 
+					int colour, 
+					double w);
+
+
+double optimal_omega(int dimension);
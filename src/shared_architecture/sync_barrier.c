@@ -0,0 +1,140 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ *
+ * Source file for the barrier threads meet at between steps, which can reduce
+ * a value of every thread on the way.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "sync_barrier.h"
+
+#define SPIN_ITERATIONS 4000		// reads of the sense before blocking
+#define VALUE_STRIDE 8				// doubles per cache line
+
+
+/*
+ * Tells the cpu that the thread is spinning, which frees resources for the
+ * other hardware thread of the core.
+ */
+static inline void spin_pause(void) {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#endif
+}
+
+
+/*
+ * Initialises a barrier for num_thr threads.
+ */
+void initialise_sync_barrier(struct sync_barrier* b, int num_thr) {
+	void *values;
+
+	if (posix_memalign(&values, 64,
+		(size_t)num_thr * VALUE_STRIDE * sizeof(double)) != 0) {
+		fprintf(stderr, "Failed to allocate space for the barrier.\n");
+		exit(EXIT_FAILURE);
+	}
+	b->values = values;
+	b->num_thr = num_thr;
+	b->spins = num_thr <= sysconf(_SC_NPROCESSORS_ONLN) ? SPIN_ITERATIONS : 0;
+	b->remaining = num_thr;
+	b->sense = 0;
+	b->sleeping = 0;
+	b->result[0] = 0.0;
+	b->result[1] = 0.0;
+}
+
+
+/*
+ * Reduces the values of all threads in thread order.
+ */
+static double reduce_values(struct sync_barrier* b, enum reduction op) {
+	double result = 0.0;
+	int t;
+
+	for (t = 0; t < b->num_thr; t++) {
+		if (op == REDUCE_SUM) {
+			result += b->values[t * VALUE_STRIDE];
+		} else if (b->values[t * VALUE_STRIDE] > result) {
+			result = b->values[t * VALUE_STRIDE];
+		}
+	}
+	return result;
+}
+
+
+/*
+ * Arrives at the barrier, the value of the thread being already stored, and
+ * returns once all threads arrived, with the reduced value.
+ */
+static double arrive(struct sync_barrier* b, enum reduction op) {
+	int sense = 1 - __atomic_load_n(&b->sense, __ATOMIC_ACQUIRE);
+	int spins;
+
+	if (__atomic_sub_fetch(&b->remaining, 1, __ATOMIC_ACQ_REL) == 0) {
+		// last thread to arrive: reduce, reset the barrier and let all go
+		if (op != REDUCE_NONE) {
+			b->result[sense] = reduce_values(b, op);
+		}
+		__atomic_store_n(&b->remaining, b->num_thr, __ATOMIC_RELAXED);
+		__atomic_store_n(&b->sense, sense, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&b->sleeping, __ATOMIC_SEQ_CST) > 0) {
+			syscall(SYS_futex, &b->sense, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, 
+				NULL, 0);
+		}
+		return b->result[sense];
+	}
+
+	for (spins = 0; spins < b->spins; spins++) {
+		if (__atomic_load_n(&b->sense, __ATOMIC_ACQUIRE) == sense) {
+			return b->result[sense];
+		}
+		spin_pause();
+	}
+
+	// the last thread either sees this thread sleeping or is seen flipping, 
+	// and the kernel only puts the thread to sleep if the sense didn't flip
+	__atomic_add_fetch(&b->sleeping, 1, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&b->sense, __ATOMIC_SEQ_CST) != sense) {
+		syscall(SYS_futex, &b->sense, FUTEX_WAIT_PRIVATE, 1 - sense, NULL, 
+			NULL, 0);
+	}
+	__atomic_sub_fetch(&b->sleeping, 1, __ATOMIC_SEQ_CST);
+	return b->result[sense];
+}
+
+
+/*
+ * Waits for all threads to arrive at the barrier.
+ */
+void sync_barrier_wait(struct sync_barrier* b) {
+	arrive(b, REDUCE_NONE);
+}
+
+
+/*
+ * Waits for all threads to arrive at the barrier with their value (thread
+ * index being 0-based), and returns the reduction of all values to every
+ * thread.
+ */
+double sync_barrier_reduce(struct sync_barrier* b, int thread_index,
+	double value, enum reduction op) {
+	b->values[thread_index * VALUE_STRIDE] = value;
+	return arrive(b, op);
+}
+
+
+/*
+ * Frees the values of the barrier, once no thread waits at it.
+ */
+void destroy_sync_barrier(struct sync_barrier* b) {
+	free(b->values);
+}
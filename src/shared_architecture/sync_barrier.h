@@ -0,0 +1,39 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ *
+ * Header file for the barrier threads meet at between steps, which can reduce
+ * a value of every thread on the way.
+ */
+
+/* Reductions of the values of all threads done at a barrier */
+enum reduction {
+	REDUCE_NONE,				// nothing to reduce
+	REDUCE_MAX,					// largest value of all threads (at least 0)
+	REDUCE_SUM					// sum of the values in thread order
+};
+
+struct sync_barrier {			// struct shared by the threads meeting
+	int num_thr;				// number of threads meeting at the barrier
+	int spins;					// reads of the sense before blocking
+	int remaining;				// threads yet to arrive at the barrier
+	int sense;					// flipped by the last thread to arrive
+	int sleeping;				// threads blocked waiting for the flip
+	double result[2];			// reduced value, by the sense it flipped to
+	double *values;				// value of each thread, a cache line apart
+};
+
+
+void initialise_sync_barrier(struct sync_barrier* b, int num_thr);
+
+
+void sync_barrier_wait(struct sync_barrier* b);
+
+
+double sync_barrier_reduce(struct sync_barrier* b,
+						   int thread_index,
+						   double value,
+						   enum reduction op);
+
+
+void destroy_sync_barrier(struct sync_barrier* b);
@@ -0,0 +1,272 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ *
+ * Source file for the dataflow relaxation, in which tiles of the square array
+ * are relaxed by tasks that run as soon as their neighbours are ready.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+#include "real.h"
+#include "stall.h"
+#include "stencil_kernel.h"
+#include "task_graph.h"
+
+
+/*
+ * Initialises the tiles of the square array and the deques of the threads.
+ * Iteration 1 of every tile is ready, and handed to the thread relaxing the
+ * band of tiles it belongs to.
+ */
+struct task_graph* initialise_task_graph(real** square_array,
+	real** new_square_array, int dim, int tile_size, double precision,
+	int num_thr) {
+	struct task_graph *tg = malloc(sizeof(struct task_graph));
+	int tiles_across = (dim - 2 + tile_size - 1) / tile_size;
+	int t, k, owner;
+
+	if (tg == NULL) {
+		fprintf(stderr, "Failed to allocate space for the task graph.\n");
+		exit(EXIT_FAILURE);
+	}
+	tg->dim = dim;
+	tg->num_thr = num_thr;
+	tg->tile_size = tile_size;
+	tg->num_tiles = tiles_across * tiles_across;
+	tg->buffers[0] = square_array;
+	tg->buffers[1] = new_square_array;
+	tg->precision = precision;
+	tg->completed = 0;
+	tg->converged = 0;
+	tg->max_diff = 0.0;
+	initialise_stall(&tg->stall);
+	for (k = 0; k < GRAPH_SLOTS; k++) {
+		tg->remaining[k] = tg->num_tiles;
+	}
+
+	tg->tiles = calloc((size_t)tg->num_tiles, sizeof(struct tile));
+	tg->deques = malloc((size_t)num_thr * sizeof(struct task_deque));
+	if (tg->tiles == NULL || tg->deques == NULL) {
+		fprintf(stderr, "Failed to allocate space for the task graph.\n");
+		exit(EXIT_FAILURE);
+	}
+	for (k = 0; k < num_thr; k++) {
+		pthread_mutex_init(&tg->deques[k].mutex, NULL);
+		tg->deques[k].tasks = malloc((size_t)tg->num_tiles * sizeof(int));
+		if (tg->deques[k].tasks == NULL) {
+			fprintf(stderr, "Failed to allocate space for the task graph.\n");
+			exit(EXIT_FAILURE);
+		}
+		tg->deques[k].head = 0;
+		tg->deques[k].count = 0;
+	}
+
+	for (t = 0; t < tg->num_tiles; t++) {
+		struct tile *tile = &tg->tiles[t];
+		tile->start_row = 1 + t / tiles_across * tile_size;
+		tile->end_row = tile->start_row + tile_size < dim - 1 ?
+			tile->start_row + tile_size : dim - 1;
+		tile->start_col = 1 + t % tiles_across * tile_size;
+		tile->end_col = tile->start_col + tile_size < dim - 1 ?
+			tile->start_col + tile_size : dim - 1;
+		tile->num_neighbours = 0;
+		if (t >= tiles_across) {
+			tile->neighbours[tile->num_neighbours++] = t - tiles_across;
+		}
+		if (t < tg->num_tiles - tiles_across) {
+			tile->neighbours[tile->num_neighbours++] = t + tiles_across;
+		}
+		if (t % tiles_across > 0) {
+			tile->neighbours[tile->num_neighbours++] = t - 1;
+		}
+		if (t % tiles_across < tiles_across - 1) {
+			tile->neighbours[tile->num_neighbours++] = t + 1;
+		}
+
+		// iteration 1 of the tile is ready
+		tile->claimed = 1;
+		owner = (int)((long)t * num_thr / tg->num_tiles);
+		tg->deques[owner].tasks[tg->deques[owner].count++] = t;
+	}
+	return tg;
+}
+
+
+/*
+ * Adds a task to the newest end of the deque of a thread.
+ */
+static void push_task(struct task_deque* deque, int num_tiles, int tile) {
+	pthread_mutex_lock(&deque->mutex);
+	deque->tasks[(deque->head + deque->count) % num_tiles] = tile;
+	deque->count++;
+	pthread_mutex_unlock(&deque->mutex);
+}
+
+
+/*
+ * Takes the newest task of the deque (the owner of the deque) or the oldest
+ * one (a thread stealing it). Returns the tile of the task, -1 if there is
+ * none.
+ */
+static int take_task(struct task_deque* deque, int num_tiles, int newest) {
+	int tile = -1;
+
+	pthread_mutex_lock(&deque->mutex);
+	if (deque->count > 0) {
+		deque->count--;
+		if (newest) {
+			tile = deque->tasks[(deque->head + deque->count) % num_tiles];
+		} else {
+			tile = deque->tasks[deque->head];
+			deque->head = (deque->head + 1) % num_tiles;
+		}
+	}
+	pthread_mutex_unlock(&deque->mutex);
+	return tile;
+}
+
+
+/*
+ * Hands the next iteration of a tile to the deque of the thread if it is
+ * ready: the tile's last iteration is completed, its neighbours completed it
+ * too, the iteration 2 before it was checked and no iteration was within
+ * precision yet. Only one thread claims it.
+ */
+static void schedule_tile(struct task_graph* tg, int thread_index, int t) {
+	struct tile *tile = &tg->tiles[t];
+	int done = __atomic_load_n(&tile->done, __ATOMIC_SEQ_CST);
+	int k;
+
+	// completed is read before converged, which is stored before it
+	if (__atomic_load_n(&tile->claimed, __ATOMIC_SEQ_CST) != done ||
+		__atomic_load_n(&tg->completed, __ATOMIC_SEQ_CST) < done - 1 ||
+		__atomic_load_n(&tg->converged, __ATOMIC_SEQ_CST) != 0) {
+		return;
+	}
+	for (k = 0; k < tile->num_neighbours; k++) {
+		if (__atomic_load_n(&tg->tiles[tile->neighbours[k]].done,
+			__ATOMIC_SEQ_CST) < done) {
+			return;
+		}
+	}
+	if (__atomic_compare_exchange_n(&tile->claimed, &done, done + 1, 0,
+		__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+		push_task(&tg->deques[thread_index], tg->num_tiles, t);
+	}
+}
+
+
+/*
+ * Checks iteration n for convergence once every tile completed it, the
+ * iterations being checked in order.
+ */
+static void check_iteration(struct task_graph* tg, int thread_index, int n) {
+	double max_diff = 0.0;
+	int t;
+
+	while (__atomic_load_n(&tg->completed, __ATOMIC_SEQ_CST) != n - 1) {
+		sched_yield();
+	}
+
+	// the next iteration may complete while threads stop, and is discarded
+	if (__atomic_load_n(&tg->converged, __ATOMIC_SEQ_CST) != 0) {
+		return;
+	}
+	for (t = 0; t < tg->num_tiles; t++) {
+		if (tg->tiles[t].diff[n % GRAPH_SLOTS] > max_diff) {
+			max_diff = tg->tiles[t].diff[n % GRAPH_SLOTS];
+		}
+	}
+	__atomic_store_n(&tg->remaining[n % GRAPH_SLOTS], tg->num_tiles,
+		__ATOMIC_SEQ_CST);
+	tg->max_diff = max_diff;
+	if (max_diff < tg->precision || has_stalled(&tg->stall, max_diff)) {
+		__atomic_store_n(&tg->converged, n, __ATOMIC_SEQ_CST);
+	}
+	__atomic_store_n(&tg->completed, n, __ATOMIC_SEQ_CST);
+
+	// tiles 2 iterations ahead may have been waiting for the check
+	for (t = 0; t < tg->num_tiles; t++) {
+		schedule_tile(tg, thread_index, t);
+	}
+}
+
+
+/*
+ * Relaxes the next iteration of a tile, from the buffer of the previous
+ * iteration into the other buffer, then hands out the tasks it made ready.
+ */
+static void relax_tile(struct task_graph* tg, int thread_index, int t) {
+	struct tile *tile = &tg->tiles[t];
+	int n = tile->claimed;
+	real **values = tg->buffers[(n - 1) % 2];
+	real **new_values = tg->buffers[n % 2];
+	int offset = tile->start_col - 1;
+	int length = tile->end_col - tile->start_col + 2;
+	double max_diff = 0.0;
+	double diff;
+	int i, k;
+
+	for (i = tile->start_row; i < tile->end_row; i++) {
+		diff = stencil_row(&values[i-1][offset], &values[i][offset],
+			&values[i+1][offset], &new_values[i][offset], length);
+		if (diff > max_diff) {
+			max_diff = diff;
+		}
+	}
+	tile->diff[n % GRAPH_SLOTS] = max_diff;
+	__atomic_store_n(&tile->done, n, __ATOMIC_SEQ_CST);
+
+	if (__atomic_sub_fetch(&tg->remaining[n % GRAPH_SLOTS], 1,
+		__ATOMIC_SEQ_CST) == 0) {
+		check_iteration(tg, thread_index, n);
+	}
+
+	// the neighbours' next iteration may have been waiting for this one
+	schedule_tile(tg, thread_index, t);
+	for (k = 0; k < tile->num_neighbours; k++) {
+		schedule_tile(tg, thread_index, tile->neighbours[k]);
+	}
+}
+
+
+/*
+ * Runs the tasks of the thread thread_index (0-based), stealing the tasks of
+ * other threads when it has none, until an iteration is within precision.
+ */
+void run_task_graph(struct task_graph* tg, int thread_index) {
+	int tile, k;
+
+	while (__atomic_load_n(&tg->converged, __ATOMIC_SEQ_CST) == 0) {
+		tile = take_task(&tg->deques[thread_index], tg->num_tiles, 1);
+		for (k = 1; tile < 0 && k < tg->num_thr; k++) {
+			tile = take_task(&tg->deques[(thread_index + k) % tg->num_thr],
+				tg->num_tiles, 0);
+		}
+		if (tile >= 0) {
+			relax_tile(tg, thread_index, tile);
+		} else {
+			// the tasks left are being run by other threads
+			sched_yield();
+		}
+	}
+}
+
+
+/*
+ * Frees the tiles and deques of the graph (the buffers are the square array,
+ * which is freed separately).
+ */
+void free_task_graph(struct task_graph* tg) {
+	int k;
+	for (k = 0; k < tg->num_thr; k++) {
+		pthread_mutex_destroy(&tg->deques[k].mutex);
+		free(tg->deques[k].tasks);
+	}
+	free(tg->deques);
+	free(tg->tiles);
+	free(tg);
+}
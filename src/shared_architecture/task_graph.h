@@ -0,0 +1,58 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ *
+ * Header file for the dataflow relaxation, in which tiles of the square array
+ * are relaxed by tasks that run as soon as their neighbours are ready.
+ */
+
+#define GRAPH_SLOTS 4			// iterations whose tiles can be in progress
+
+struct tile {					// struct representing one tile of the array
+	int start_row;				// first row of the tile
+	int end_row;				// row after the last row of the tile
+	int start_col;				// first column of the tile
+	int end_col;				// column after the last column of the tile
+	int neighbours[4];			// tiles north, south, west and east of it
+	int num_neighbours;			// number of them inside the array
+	int done;					// last iteration of the tile completed
+	int claimed;				// last iteration of the tile handed to a task
+	double diff[GRAPH_SLOTS];	// largest difference of recent iterations
+};
+
+struct task_deque {				// struct holding the tasks of one thread
+	pthread_mutex_t mutex;		// protects the tasks
+	int *tasks;					// tiles to relax, in a circular buffer
+	int head;					// oldest task, stolen by other threads
+	int count;					// number of tasks
+};
+
+struct task_graph {				// struct shared by the threads running tasks
+	int dim;					// square array dimensions
+	int num_thr;				// number of threads running tasks
+	int tile_size;				// rows and columns of a tile
+	int num_tiles;				// number of tiles of the array
+	struct tile *tiles;			// tiles, row by row
+	struct task_deque *deques;	// tasks of each thread
+	real **buffers[2];			// values of even and odd iterations
+	double precision;			// precision the array is relaxed to
+	int remaining[GRAPH_SLOTS];	// tiles yet to complete recent iterations
+	int completed;				// last iteration completed by every tile
+	int converged;				// iteration within precision (0 until then)
+	double max_diff;			// largest difference of the last iteration
+	struct stall stall;			// convergence of the largest differences
+};
+
+
+struct task_graph* initialise_task_graph(real** square_array,
+										 real** new_square_array,
+										 int dim,
+										 int tile_size,
+										 double precision,
+										 int num_thr);
+
+
+void run_task_graph(struct task_graph* tg, int thread_index);
+
+
+void free_task_graph(struct task_graph* tg);
@@ -0,0 +1,125 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ * 
+ * Source file for the pinning of threads to cores.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+#include "thread_affinity.h"
+
+
+/*
+ * Returns the socket of the given CPU, or 0 if it is not known.
+ */
+static int socket_of_cpu(int cpu) {
+	char path[96];
+	FILE *file;
+	int socket = 0;
+
+	snprintf(path, sizeof(path), 
+		"/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+	file = fopen(path, "r");
+	if (file != NULL) {
+		if (fscanf(file, "%d", &socket) != 1) {
+			socket = 0;
+		}
+		fclose(file);
+	}
+	return socket;
+}
+
+
+/*
+ * Returns the CPU each of num_thr threads is pinned to under the given policy
+ * (wrapping around the cores the program may run on if there are more threads
+ * than cores), or NULL if threads are not pinned.
+ */
+int* initialise_affinity_map(enum affinity_policy policy, int num_thr) {
+	cpu_set_t allowed;
+	int *cpus, *sockets, *order, *map;
+	int num_cpus = 0;
+	int num_sockets = 0;
+	int cpu, i, j, rank, t;
+
+	if (policy == AFFINITY_NONE) {
+		return NULL;
+	}
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+		fprintf(stderr, "WARNING: Could not read the cores the program may "
+			"run on. Threads are not pinned.\n");
+		return NULL;
+	}
+
+	// cores the program may run on and their socket
+	cpus = malloc(CPU_SETSIZE * sizeof(int));
+	sockets = malloc(CPU_SETSIZE * sizeof(int));
+	order = malloc(CPU_SETSIZE * sizeof(int));
+	map = malloc((size_t) num_thr * sizeof(int));
+	if (cpus == NULL || sockets == NULL || order == NULL || map == NULL) {
+		fprintf(stderr, "Failed to allocate space for the affinity map.\n");
+		exit(EXIT_FAILURE);
+	}
+	for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+		if (CPU_ISSET((size_t) cpu, &allowed)) {
+			cpus[num_cpus] = cpu;
+			sockets[num_cpus] = socket_of_cpu(cpu);
+			if (sockets[num_cpus] + 1 > num_sockets) {
+				num_sockets = sockets[num_cpus] + 1;
+			}
+			num_cpus++;
+		}
+	}
+
+	// compact: cores socket by socket, scatter: the first core of every 
+	// socket, then the second core of every socket, ...
+	i = 0;
+	if (policy == AFFINITY_COMPACT) {
+		for (t = 0; t < num_sockets; t++) {
+			for (j = 0; j < num_cpus; j++) {
+				if (sockets[j] == t) {
+					order[i++] = cpus[j];
+				}
+			}
+		}
+	} else {
+		for (rank = 0; i < num_cpus; rank++) {
+			for (t = 0; t < num_sockets; t++) {
+				// the core of the given rank in socket t, if there is one
+				for (j = 0, cpu = 0; j < num_cpus; j++) {
+					if (sockets[j] == t && cpu++ == rank) {
+						order[i++] = cpus[j];
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	for (t = 0; t < num_thr; t++) {
+		map[t] = order[t % num_cpus];
+	}
+	free(cpus);
+	free(sockets);
+	free(order);
+	return map;
+}
+
+
+/*
+ * Sets the attributes of a thread to be created so that it only runs on the
+ * given CPU.
+ */
+void pin_thread(pthread_attr_t* attr, int cpu) {
+	cpu_set_t cpu_set;
+
+	CPU_ZERO(&cpu_set);
+	CPU_SET((size_t) cpu, &cpu_set);
+	if (pthread_attr_setaffinity_np(attr, sizeof(cpu_set), &cpu_set) != 0) {
+		fprintf(stderr, "WARNING: Could not pin a thread to CPU %d.\n", cpu);
+	}
+}
@@ -0,0 +1,19 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ * 
+ * Header file for the pinning of threads to cores.
+ */
+
+/* Ways of pinning threads to cores that can be selected from the command line */
+enum affinity_policy {
+	AFFINITY_NONE,				// threads are left to the scheduler
+	AFFINITY_COMPACT,			// consecutive threads on the cores of a socket
+	AFFINITY_SCATTER			// consecutive threads on different sockets
+};
+
+
+int* initialise_affinity_map(enum affinity_policy policy, int num_thr);
+
+
+void pin_thread(pthread_attr_t* attr, int cpu);
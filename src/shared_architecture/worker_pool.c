@@ -0,0 +1,106 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ *
+ * Source file for the pool of threads created once and given every parallel
+ * job of the program.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "sync_barrier.h"
+#include "thread_affinity.h"
+#include "worker_pool.h"
+
+
+/*
+ * Threaded function run by every thread of the pool: runs the jobs handed
+ * out, each with the thread's own argument, until the pool is freed.
+ */
+static void* pool_runner(void* arg) {
+	struct pool_member *member = (struct pool_member*) arg;
+	struct worker_pool *pool = member->pool;
+
+	while (1) {
+		// wait for the next job
+		sync_barrier_wait(&pool->barrier);
+		if (pool->exiting) {
+			break;
+		}
+		pool->job(pool->job_args + (size_t)member->thread_index *
+			pool->job_arg_size);
+		sync_barrier_wait(&pool->barrier);
+	}
+	return NULL;
+}
+
+
+/*
+ * Creates the num_thr threads of the pool, pinned to the given cpus if not
+ * NULL.
+ */
+struct worker_pool* initialise_worker_pool(int num_thr, const int* cpus) {
+	struct worker_pool *pool = malloc(sizeof(struct worker_pool));
+	pthread_attr_t attr;
+	int t;
+
+	if (pool == NULL) {
+		fprintf(stderr, "Failed to allocate space for the thread pool.\n");
+		exit(EXIT_FAILURE);
+	}
+	pool->threads = malloc((size_t)num_thr * sizeof(pthread_t));
+	pool->members = malloc((size_t)num_thr * sizeof(struct pool_member));
+	if (pool->threads == NULL || pool->members == NULL) {
+		fprintf(stderr, "Failed to allocate space for the thread pool.\n");
+		exit(EXIT_FAILURE);
+	}
+	pool->num_thr = num_thr;
+	pool->exiting = 0;
+	initialise_sync_barrier(&pool->barrier, num_thr + 1);
+
+	for (t = 0; t < num_thr; t++) {
+		pool->members[t].pool = pool;
+		pool->members[t].thread_index = t;
+		pthread_attr_init(&attr);
+		if (cpus != NULL) {
+			pin_thread(&attr, cpus[t]);
+		}
+		pthread_create(&pool->threads[t], &attr, pool_runner,
+			&pool->members[t]);
+		pthread_attr_destroy(&attr);
+	}
+	return pool;
+}
+
+
+/*
+ * Runs job on every thread of the pool, thread t getting the argument at
+ * t * arg_size bytes from args, and returns once all threads finished it.
+ */
+void run_worker_pool(struct worker_pool* pool, void* (*job)(void*),
+	void* args, size_t arg_size) {
+	pool->job = job;
+	pool->job_args = args;
+	pool->job_arg_size = arg_size;
+	sync_barrier_wait(&pool->barrier);
+	sync_barrier_wait(&pool->barrier);
+}
+
+
+/*
+ * Lets the threads of the pool leave, waits for them and frees the pool.
+ */
+void free_worker_pool(struct worker_pool* pool) {
+	int t;
+
+	pool->exiting = 1;
+	sync_barrier_wait(&pool->barrier);
+	for (t = 0; t < pool->num_thr; t++) {
+		pthread_join(pool->threads[t], NULL);
+	}
+	destroy_sync_barrier(&pool->barrier);
+	free(pool->threads);
+	free(pool->members);
+	free(pool);
+}
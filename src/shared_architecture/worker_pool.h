@@ -0,0 +1,35 @@
+/**
+ * CM30225 Parallel Computing
+ * Assessment Coursework 1
+ *
+ * Header file for the pool of threads created once and given every parallel
+ * job of the program.
+ */
+
+struct pool_member {			// struct passed to every thread of the pool
+	struct worker_pool *pool;	// pool the thread belongs to
+	int thread_index;			// 0-based index of the thread
+};
+
+struct worker_pool {			// struct shared by the threads of the pool
+	int num_thr;				// number of threads of the pool
+	pthread_t *threads;			// threads of the pool
+	struct pool_member *members;	// arguments of the threads
+	struct sync_barrier barrier;	// threads and caller meet at between jobs
+	void* (*job)(void*);		// function run by every thread
+	char *job_args;				// argument of the first thread
+	size_t job_arg_size;		// bytes between the arguments of two threads
+	int exiting;				// threads leave the pool instead of a job
+};
+
+
+struct worker_pool* initialise_worker_pool(int num_thr, const int* cpus);
+
+
+void run_worker_pool(struct worker_pool* pool,
+					 void* (*job)(void*),
+					 void* args,
+					 size_t arg_size);
+
+
+void free_worker_pool(struct worker_pool* pool);